@@ -0,0 +1,79 @@
+#ifndef SIBASIC_CACHE_H
+#define SIBASIC_CACHE_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Resultados de execuções completas (--cache <diretório>). Um programa determinístico (sem RND,
+// com os valores do INPUT vindos de --input-file e sem comandos que leem ou gravam outros
+// arquivos) sempre produz a mesma saída do PRINT e os mesmos SVG. Cada resultado fica em um
+// arquivo cujo nome é formado pelos hashes do fonte e da entrada e pela versão do SiBasic
+// (com o id da compilação: ver main.cpp).
+
+struct ResultadoGuardado {
+    std::string saida;
+    // Conteúdo de cada SVG, na ordem dos DRAW FINISH
+    std::vector<std::string> desenhos;
+    uint64_t comandosExecutados = 0;
+};
+
+class CacheDeExecucao {
+public:
+    // "entrada" é o texto do --input-file, ou nulo sem ele. Cria o diretório se não existir.
+    CacheDeExecucao(const std::string& diretorio, const std::string& versao, const std::string& fonte,
+                    const std::string* entrada);
+    // Retorna false se não houver resultado guardado. Um arquivo corrompido, de outra
+    // versão ou de outro fonte com o mesmo hash conta como ausente.
+    bool buscar(ResultadoGuardado& resultado) const;
+    // Grava com outro nome e renomeia: execuções simultâneas nunca leem um resultado pela metade.
+    // Lança runtime_error.
+    void guardar(const ResultadoGuardado& resultado) const;
+    const std::string& caminho() const { return caminhoDoResultado; }
+
+    // Sem RND, sem LOAD, SAVE, CHECKPOINT ou DIM ... FILE e, se houver INPUT, com a entrada dada
+    static bool deterministico(const NoDePrograma& programa, bool temEntrada);
+
+private:
+    std::string versao;
+    uint64_t hashDoFonte;
+    uint64_t tamanhoDoFonte;
+    uint64_t hashDaEntrada;
+    uint64_t tamanhoDaEntrada;
+    std::string caminhoDoResultado;
+};
+
+// Passa adiante tudo o que recebe e guarda uma cópia (captura a saída do PRINT sem escondê-la)
+class SaidaCapturada : public std::streambuf {
+public:
+    explicit SaidaCapturada(std::streambuf* destino) : destino(destino) {}
+    const std::string& texto() const { return capturado; }
+
+protected:
+    int overflow(int c) override;
+    std::streamsize xsputn(const char* dados, std::streamsize quantidade) override;
+    int sync() override;
+
+private:
+    std::streambuf* destino;
+    std::string capturado;
+};
+
+#endif //SIBASIC_CACHE_H
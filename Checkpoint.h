@@ -0,0 +1,73 @@
+#ifndef SIBASIC_CHECKPOINT_H
+#define SIBASIC_CHECKPOINT_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Arquivo binário de checkpoint (CHECKPOINT, SIGUSR2, --resume). Os números são gravados na
+// ordem de bytes da máquina; o cabeçalho tem uma marca que detecta arquivos de outra arquitetura.
+// O conteúdo (variáveis, vetores, desenho) é definido pelo Interpreter.
+
+// Grava em "<caminho>.tmp" e só troca o arquivo final em concluir(): um checkpoint
+// interrompido no meio não destrói o anterior
+class GravadorDeCheckpoint {
+public:
+    explicit GravadorDeCheckpoint(const std::string& caminho);
+    ~GravadorDeCheckpoint();
+    GravadorDeCheckpoint(const GravadorDeCheckpoint&) = delete;
+    GravadorDeCheckpoint& operator=(const GravadorDeCheckpoint&) = delete;
+
+    void gravar(uint64_t valor);
+    void gravar(double valor);
+    void gravar(const std::string& texto);
+    // Elementos de um vetor, direto da memória, sem conversão (as palavras dos tipos compactos)
+    void gravarBloco(const double* dados, uint64_t quantidade);
+    void gravarBloco(const uint64_t* dados, uint64_t quantidade);
+    // Descarrega no disco e renomeia para o nome final
+    void concluir();
+
+private:
+    std::string caminho;
+    std::string temporario;
+    std::FILE* arquivo;
+    void escrever(const void* dados, size_t bytes);
+    // "quantidade" elementos de 8 bytes
+    void gravarElementos(const void* dados, uint64_t quantidade);
+};
+
+class LeitorDeCheckpoint {
+public:
+    explicit LeitorDeCheckpoint(const std::string& caminho);
+    ~LeitorDeCheckpoint();
+    LeitorDeCheckpoint(const LeitorDeCheckpoint&) = delete;
+    LeitorDeCheckpoint& operator=(const LeitorDeCheckpoint&) = delete;
+
+    uint64_t lerInteiro();
+    double lerReal();
+    std::string lerTexto();
+    void lerBloco(double* dados, uint64_t quantidade);
+    void lerBloco(uint64_t* dados, uint64_t quantidade);
+
+private:
+    std::string caminho;
+    std::FILE* arquivo;
+    void ler(void* dados, size_t bytes);
+    void lerElementos(void* dados, uint64_t quantidade);
+};
+
+#endif //SIBASIC_CHECKPOINT_H
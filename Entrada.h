@@ -0,0 +1,87 @@
+#ifndef SIBASIC_ENTRADA_H
+#define SIBASIC_ENTRADA_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// De onde o comando INPUT obtém seus valores
+class FonteDeEntrada {
+public:
+    virtual ~FonteDeEntrada() = default;
+    virtual double lerValor() = 0;
+    // Execução por passos: false se lerValor agora ficaria esperando um valor que ainda não chegou
+    virtual bool pronta() { return true; }
+    // Bloqueia até que pronta() seja verdadeira
+    virtual void esperar() {}
+};
+
+// Comportamento original: mostra o prompt "# " e lê da console
+class EntradaConsole : public FonteDeEntrada {
+public:
+    double lerValor() override;
+};
+
+// Lê todo o arquivo (ou a entrada padrão, se o nome for "-") de uma vez, sem prompts.
+// Os números podem estar separados por espaços, quebras de linha, vírgulas ou ponto e vírgula.
+class EntradaArquivo : public FonteDeEntrada {
+public:
+    explicit EntradaArquivo(const std::string& nomeArquivo);
+    double lerValor() override;
+    // Texto completo do arquivo (identifica a entrada no --cache)
+    const std::string& conteudo() const { return dados; }
+
+private:
+    std::string nomeArquivo;
+    std::string dados;
+    size_t pos;
+    size_t linha;
+};
+
+// Valores fixos, consumidos na ordem dos comandos INPUT executados (usado pelo --sweep)
+class EntradaLista : public FonteDeEntrada {
+public:
+    explicit EntradaLista(std::vector<double> valores);
+    double lerValor() override;
+    size_t restantes() const;
+
+private:
+    std::vector<double> valores;
+    size_t proximo;
+};
+
+// Valores entregues aos poucos, de outra thread, por quem hospeda o programa (ex: Escalonador).
+// Enquanto não houver valor, Interpreter::passo para no INPUT com AGUARDANDO_ENTRADA.
+class EntradaFila : public FonteDeEntrada {
+public:
+    void fornecer(double valor);
+    // Não haverá mais valores: o próximo INPUT sem valor é erro, como no fim de um arquivo
+    void encerrar();
+    double lerValor() override;
+    bool pronta() override;
+    void esperar() override;
+
+private:
+    std::mutex mutex;
+    std::condition_variable chegou;
+    std::deque<double> valores;
+    bool encerrada = false;
+};
+
+#endif //SIBASIC_ENTRADA_H
@@ -0,0 +1,92 @@
+#ifndef SIBASIC_ESCALONADOR_H
+#define SIBASIC_ESCALONADOR_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Entrada.h"
+#include "Interpreter.h"
+#include "Parser.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Executa muitos programas em poucas threads, em rodízio: cada programa roda uma fatia
+// (até "orcamento" comandos ou "fatia" de tempo, o que vier antes) e volta para o fim da fila.
+// Com N programas prontos e T threads, um programa espera no máximo cerca de N / T fatias
+// para rodar de novo, por mais longos que sejam os outros.
+// Um programa parado em INPUT sem valor sai da fila até que fornecerEntrada seja chamado.
+class Escalonador {
+public:
+    struct Resultado {
+        bool terminou = false;
+        // Saída dos PRINT até o fim da última fatia
+        std::string saida;
+        // Mensagem do erro de execução, se o programa terminou com erro
+        std::string erro;
+        uint64_t comandos = 0;
+    };
+
+    // Com numeroThreads igual a zero usa o número de núcleos
+    explicit Escalonador(unsigned numeroThreads, uint64_t orcamento = 10000,
+                         std::chrono::microseconds fatia = std::chrono::milliseconds(2));
+    // Para as threads; programas ainda não terminados são abandonados
+    ~Escalonador();
+    Escalonador(const Escalonador&) = delete;
+    Escalonador& operator=(const Escalonador&) = delete;
+
+    // O programa (já analisado) pode ser o mesmo em várias chamadas: a execução só altera a
+    // AST ao especializar os nós (forma, formaReal, formaInteira), com escritas atômicas
+    size_t adicionar(const std::string& basicScriptName, const std::shared_ptr<NoDePrograma>& programa);
+    void fornecerEntrada(size_t id, double valor);
+    // Sem mais valores para o INPUT: o próximo INPUT sem valor termina o programa com erro
+    void encerrarEntrada(size_t id);
+    // Bloqueia até que todos os programas adicionados terminem. Programas esperando INPUT
+    // só terminam quando recebem valores ou quando a entrada é encerrada.
+    void aguardar();
+    Resultado resultado(size_t id) const;
+
+private:
+    struct Tarefa {
+        // A saída precisa existir enquanto o Interpreter existir
+        std::ostringstream saida;
+        std::shared_ptr<EntradaFila> entrada;
+        std::unique_ptr<Interpreter> interpreter;
+        bool aguardandoEntrada = false;
+        Resultado resultado;
+    };
+
+    uint64_t orcamento;
+    std::chrono::microseconds fatia;
+    mutable std::mutex mutex;
+    std::condition_variable temTrabalho;
+    std::condition_variable terminaram;
+    std::deque<size_t> fila;
+    std::vector<std::unique_ptr<Tarefa>> tarefas;
+    size_t ativas = 0;
+    bool parar = false;
+    std::vector<std::thread> threads;
+
+    void trabalhar();
+    void acordar(size_t id);
+};
+
+#endif //SIBASIC_ESCALONADOR_H
@@ -0,0 +1,85 @@
+#ifndef SIBASIC_ESTATISTICAS_H
+#define SIBASIC_ESTATISTICAS_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Telemetria por fase do processamento (--stats): tempo de relógio e de CPU, alocações
+// (contadas por um operator new substituído, ver estatisticas.cpp) e pico de RSS.
+// As fases se aninham: a fase ativa recebe tudo o que foi gasto desde a última troca, e
+// MedicaoDeFase troca de fase e volta à anterior ao sair do escopo. Só deve existir uma
+// instância por vez, porque os contadores de alocação são do processo.
+class Estatisticas {
+public:
+    enum Fase { LEITURA, LEXER, PARSER, RESOLVEDOR, OTIMIZADOR, EXECUCAO, SVG, NENHUMA };
+
+    Estatisticas();
+    ~Estatisticas();
+    Estatisticas(const Estatisticas&) = delete;
+    Estatisticas& operator=(const Estatisticas&) = delete;
+
+    // Encerra a medição da fase ativa e começa a de "nova"; retorna a fase que estava ativa
+    Fase trocar(Fase nova);
+
+    uint64_t tokens = 0;
+    uint64_t nosDaAST = 0;
+    uint64_t comandosExecutados = 0;
+
+    // Tabela legível ou um objeto JSON em uma linha
+    void mostrar(std::ostream& saida) const;
+    void mostrarJson(std::ostream& saida) const;
+
+private:
+    struct Medida {
+        double relogio = 0.0; // segundos
+        double cpu = 0.0;
+        uint64_t alocacoes = 0;
+        uint64_t bytes = 0;
+        uint64_t picoRss = 0; // KiB, ao final da fase
+        bool usada = false;
+    };
+    Medida medidas[NENHUMA];
+    Fase ativa = NENHUMA;
+    std::chrono::steady_clock::time_point inicioRelogio;
+    double inicioCpu = 0.0;
+    uint64_t inicioAlocacoes = 0;
+    uint64_t inicioBytes = 0;
+
+    Medida total() const;
+};
+
+// Mede um trecho como uma fase; sem Estatisticas (nullptr) não faz nada
+class MedicaoDeFase {
+public:
+    MedicaoDeFase(Estatisticas* estatisticas, Estatisticas::Fase fase)
+        : estatisticas(estatisticas),
+          anterior(estatisticas != nullptr ? estatisticas->trocar(fase) : Estatisticas::NENHUMA) {}
+    ~MedicaoDeFase() {
+        if (estatisticas != nullptr) {
+            estatisticas->trocar(anterior);
+        }
+    }
+    MedicaoDeFase(const MedicaoDeFase&) = delete;
+    MedicaoDeFase& operator=(const MedicaoDeFase&) = delete;
+
+private:
+    Estatisticas* estatisticas;
+    Estatisticas::Fase anterior;
+};
+
+#endif //SIBASIC_ESTATISTICAS_H
@@ -0,0 +1,70 @@
+#ifndef SIBASIC_EXPORTACAO_H
+#define SIBASIC_EXPORTACAO_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Vetor.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Gravação de vetores em arquivos de dados (SAVE A, B TO "<arquivo>" [ASYNC]).
+// Arquivos ".f64" recebem um vetor, com o cabeçalho descrito em Vetor::marcaF64 seguido dos
+// doubles; os demais são CSV. O arquivo é gravado em "<arquivo>.tmp" e renomeado no fim.
+
+// Lança runtime_error se os vetores não podem ir para esse arquivo (.f64 com mais de um
+// vetor, CSV com vetores de tamanhos diferentes)
+void verificarGravacao(const std::string& caminho, const std::vector<std::shared_ptr<const Vetor>>& vetores);
+
+// Um vetor vai para o CSV uma linha por elemento ou, com várias dimensões, uma linha por
+// valor do penúltimo índice. Vários vetores viram colunas, um elemento de cada por linha.
+// Os números são gravados com a menor representação que volta ao mesmo double.
+void gravarVetores(const std::string& caminho, const std::vector<std::shared_ptr<const Vetor>>& vetores);
+
+// Cópia em memória (esparsa se o original for esparso), para gravar em segundo plano
+std::shared_ptr<const Vetor> copiarVetor(const Vetor& vetor);
+
+// Uma thread que executa as gravações em ordem, criada na primeira. Há no máximo
+// "maximoPendentes" gravações na fila: quem enfileira além disso espera.
+class GravadorEmSegundoPlano {
+public:
+    GravadorEmSegundoPlano() = default;
+    // Espera as gravações pendentes (os erros delas são descartados)
+    ~GravadorEmSegundoPlano();
+    GravadorEmSegundoPlano(const GravadorEmSegundoPlano&) = delete;
+    GravadorEmSegundoPlano& operator=(const GravadorEmSegundoPlano&) = delete;
+
+    void enfileirar(std::function<void()> gravacao);
+    // Espera as gravações pendentes; lança runtime_error com o primeiro erro entre elas
+    void concluir();
+
+private:
+    static constexpr size_t maximoPendentes = 2;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable mudou;
+    std::deque<std::function<void()>> fila;
+    bool gravando = false;
+    bool parar = false;
+    std::string erro;
+    void executar();
+};
+
+#endif //SIBASIC_EXPORTACAO_H
@@ -0,0 +1,37 @@
+#ifndef SIBASIC_IMPORTACAO_H
+#define SIBASIC_IMPORTACAO_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Vetor.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Carga de vetores a partir de arquivos de dados (LOAD A FROM "<arquivo>" [COLUMN n]).
+// Arquivos ".f64" são doubles little-endian, mapeados sem cópia; os demais são CSV.
+
+// Números de um CSV, lidos em paralelo por blocos de linhas. Com coluna 0, todos os campos de
+// cada linha, em ordem; senão só o campo da coluna (a partir de 1). Uma primeira linha que
+// não é numérica é tratada como cabeçalho. Lança runtime_error com a linha do erro.
+std::vector<double> lerCsv(const std::string& caminho, unsigned coluna);
+
+// Carrega o arquivo no vetor "destino" (o tamanho dele deve ser igual ao número de valores)
+// ou, se destino for nulo, em um vetor novo com o tamanho dos dados. Retorna o vetor que
+// passa a valer para a variável: pode ser outro objeto, com as mesmas dimensões do destino.
+// Num destino de tipo compacto (DIM ... AS INT8), os valores são convertidos para o tipo dele.
+std::shared_ptr<Vetor> carregarVetor(const std::string& caminho, unsigned coluna, const std::shared_ptr<Vetor>& destino);
+
+#endif //SIBASIC_IMPORTACAO_H
@@ -16,33 +16,143 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "Parser.h"
+#include "Entrada.h"
+#include "Estatisticas.h"
+#include "Exportacao.h"
+#include "RegistroDeVoo.h"
+#include "Vetor.h"
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <stdexcept>
 #include <memory>
 #include <unordered_map>
+#include <iostream>
 
 class Interpreter {
 public:
     Interpreter(std::string basicScriptName);
-    void executar(const std::shared_ptr<NoDePrograma>& programa);
+    // Saída do PRINT e fonte do INPUT podem ser redirecionadas (ex: execução em --sweep)
+    Interpreter(std::string basicScriptName, std::ostream& saida, std::shared_ptr<FonteDeEntrada> entrada);
+    void executar(const std::shared_ptr<NoDePrograma>& programa, int indiceInicial = 0);
+    // Execução por passos: o Interpreter guarda o próximo comando, as variáveis, o desenho SVG e
+    // os temporários entre as chamadas, e quem o hospeda decide quando continuar (ver Escalonador)
+    enum class Situacao { CEDEU, TERMINOU, AGUARDANDO_ENTRADA };
+    // Prepara a execução sem executar nenhum comando
+    void iniciar(const std::shared_ptr<NoDePrograma>& programa, int indiceInicial = 0);
+    // Executa até "orcamento" comandos, parando antes se passar do "prazo". Retorna
+    // AGUARDANDO_ENTRADA, sem executar o INPUT, se a fonte de entrada ainda não tem o valor.
+    // Um erro de execução é lançado como antes e encerra o programa.
+    Situacao passo(uint64_t orcamento,
+                   std::chrono::steady_clock::time_point prazo = std::chrono::steady_clock::time_point::max());
+    bool terminou() const;
+    // Total de comandos executados desde iniciar
+    uint64_t comandosExecutados() const;
+    // Grava variáveis, vetores, desenho SVG e o próximo comando em um arquivo binário. Vetores
+    // de DIM ... FILE ficam no próprio arquivo: o checkpoint guarda só o caminho.
+    void gravarCheckpoint(const std::string& caminho, int proximoComando);
+    // Prepara a execução por passos a partir de um checkpoint gravado pelo mesmo fonte
+    void restaurarCheckpoint(const std::shared_ptr<NoDePrograma>& programa, const std::string& caminho);
+    // Antes do próximo comando, depois de um SIGUSR2 é gravado o checkpoint "<script>.ckpt" e,
+    // depois de um SIGUSR1, o registro de voo "<script>.trace"
+    static void instalarPedidosPorSinal();
+    // Passa a manter o registro de voo (últimos comandos, desvios e valores gravados)
+    void ativarRegistroDeVoo(size_t capacidade = 4096);
+    // Retorna false se o registro de voo não estiver ativo. Lança runtime_error.
+    bool gravarRegistroDeVoo(const std::string& caminho, const std::string& motivo) const;
+    // Com --stats, a gravação do SVG é medida como uma fase separada da execução
+    void medir(Estatisticas* estatisticas);
+    // Threads usadas por um PARALLEL FOR; com zero (padrão), o número de núcleos
+    void definirThreadsParalelas(unsigned numeroThreads);
+    // Além de gravar, guarda em "destino" o conteúdo de cada SVG gerado (usado pelo --cache)
+    void guardarDesenhos(std::vector<std::string>* destino);
+    // Grava um SVG com o nome que o DRAW FINISH daria a ele agora; retorna o caminho
+    static std::string gravarDesenho(const std::string& basicScriptName, const std::string& conteudo);
+    // Retorna o destino do desvio, -1 para seguir adiante, -2 no END e -3 se o INPUT não tem valor
     int executarComando(const std::shared_ptr<NoDaAST>& comando, const std::shared_ptr<NoDePrograma>& programa);
     double avaliarExpressao(const std::shared_ptr<NoDaAST>& expressao);
+    // Função para processar chamadas de função
+    static double processarFuncao(const std::string& nomeDaFuncao, double argumento, bool temArgumento = true);
+    // Permitem continuar a execução a partir de um estado montado externamente (ex: LaneInterpreter)
+    void definirVariavel(const std::string& nome, double valor);
+    void definirVetor(const std::string& nome, std::vector<double> valores);
 
 private:
     std::string basicScriptName;
+    std::ostream* saida;
+    std::shared_ptr<FonteDeEntrada> entrada;
     std::string svgViewPort;
     std::string currentSvgFilePath;
     std::vector<std::string> elementosSvg;
-    // Função para converter graus em radianos
-    double grausParaRadianos(double degrees);
-    std::unordered_map<std::string, std::vector<double>> variables;
-    std::unordered_map<std::string, int> vetores;
-    // Função para processar chamadas de função
-    double processarFuncao(const std::string& nomeDaFuncao, double argumento, bool temArgumento = true);
-    int getPosicao(const std::string& varivavel, const std::string& indexador);
+    // Variável simples (definida) ou vetor declarado com DIM; os dois são exclusivos
+    struct Variavel {
+        bool definida = false;
+        // Variáveis I% guardam o valor em "inteiro"; as demais em "valor"
+        bool inteira = false;
+        double valor = 0.0;
+        int64_t inteiro = 0;
+        std::shared_ptr<Vetor> vetor;
+    };
+    // Os elementos de um unordered_map não mudam de endereço: "enderecos" guarda, por slot
+    // do programa em execução, o ponteiro para a variável, preenchido no primeiro acesso
+    std::unordered_map<std::string, Variavel> variaveis;
+    std::vector<Variavel*> enderecos;
+    // Por laço de NoDePrograma::lacos: 0 fora do laço, 1 guarda aprovada, 2 guarda reprovada
+    std::vector<char> estadoLacos;
+    // Valores dos temporários do Otimizador (NoDeTemporario), calculados no primeiro uso
+    struct ValorTemporario {
+        bool valido = false;
+        double real = 0.0;
+        int64_t inteiro = 0;
+    };
+    std::vector<ValorTemporario> temporarios;
+    // Posição da execução por passos
+    std::shared_ptr<NoDePrograma> programaAtual;
+    int proximoComando = 0;
+    int comandoAnterior = -1;
+    bool encerrado = true;
+    uint64_t executados = 0;
+    // Marcados pelos tratadores de SIGUSR2 e SIGUSR1: um só teste por comando para os dois
+    enum PedidoPorSinal : unsigned { PEDIDO_CHECKPOINT = 1, PEDIDO_REGISTRO = 2 };
+    static std::atomic<unsigned> pedidosPorSinal;
+    std::unique_ptr<RegistroDeVoo> registro;
+    // Gravações de SAVE ... ASYNC, criado no primeiro
+    std::unique_ptr<GravadorEmSegundoPlano> gravacoes;
+    unsigned threadsParalelas = 0;
+    std::vector<std::string>* desenhosGuardados = nullptr;
+    void atenderPedidos(int index);
+    Estatisticas* estatisticas = nullptr;
+    Variavel& buscarVariavel(int slot, const std::string& nome);
+    // Avalia uma expressão marcada como inteira pelo Resolvedor, com verificação de estouro
+    int64_t avaliarInteiro(const std::shared_ptr<NoDaAST>& expressao);
+    // Na primeira avaliação, cada nó guarda uma forma especializada (tipo do nó e operação) e as
+    // seguintes despacham por ela. As formas que supõem uma variável simples já definida têm
+    // guarda: se a suposição falha, o nó volta à forma geral. Os caminhos gerais abaixo tratam
+    // o que não foi especializado e os erros.
+    double avaliarExpressaoGeral(const std::shared_ptr<NoDaAST>& expressao);
+    int64_t avaliarInteiroGeral(const std::shared_ptr<NoDaAST>& expressao);
+    // Conversão de real para inteiro (LET I% = 2.5, INPUT I%): descarta a parte fracionária
+    static int64_t paraInteiro(double valor);
+    // Avalia, na entrada do laço, se todos os acessos indexados pelo contador ficam dentro dos vetores
+    bool verificarLaco(const NoDePrograma& programa, const LacoContado& laco);
+    // Posição linear (base zero) do elemento, validando cada índice contra sua dimensão
+    uint64_t getPosicao(const std::string& variavel, const Vetor& vetor, const std::vector<IndiceDeVetor>& indices);
+    // Executa todas as voltas de um PARALLEL FOR e atualiza o contador e as variáveis do REDUCE
+    void executarParalelo(const NoDoComandoPARALLEL& paralelo, const std::shared_ptr<NoDePrograma>& programa);
     void executarComandoDraw(const std::shared_ptr<NoDaAST>& comando);
     void executarComandoPlot(const std::shared_ptr<NoDaAST>& comando);
     void executarComandoLine(const std::shared_ptr<NoDaAST>& comando);
     void executarComandoRectangle(const std::shared_ptr<NoDaAST>& comando);
+    // Atributo de PLOT/LINE/RECTANGLE ALL: um vetor (um elemento por desenho) ou um valor só
+    struct AtributoDeDesenho {
+        const Vetor* vetor = nullptr;
+        double valor = 0.0;
+        double em(uint64_t posicao) const { return vetor != nullptr ? vetor->ler(posicao) : valor; }
+    };
+    // Prepara os atributos e retorna o número de desenhos (o tamanho comum dos vetores)
+    uint64_t prepararDesenhos(const std::string& comando,
+                              const std::vector<const std::shared_ptr<NoDaAST>*>& expressoes,
+                              std::vector<AtributoDeDesenho>& atributos);
 };
 #endif //SIBASIC_INTERPRETER_H
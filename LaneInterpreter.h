@@ -0,0 +1,64 @@
+#ifndef SIBASIC_LANEINTERPRETER_H
+#define SIBASIC_LANEINTERPRETER_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include "Entrada.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Executa o mesmo programa para N conjuntos de entrada ao mesmo tempo ("lanes").
+// Cada variável guarda N doubles contíguos e as expressões são avaliadas lane a lane,
+// em laços que o compilador vetoriza. Enquanto todas as lanes seguem o mesmo caminho,
+// cada comando é interpretado uma única vez para as N entradas.
+//
+// Quando um IF diverge entre as lanes, ou aparece algo que este modo não trata
+// (comandos de desenho, erros de execução), o estado de cada lane é copiado para um
+// Interpreter escalar que continua a partir do mesmo comando. Assim a saída é sempre
+// idêntica à de N execuções independentes.
+template<int N>
+class LaneInterpreter {
+public:
+    using Lanes = std::array<double, N>;
+
+    struct Lane {
+        std::string basicScriptName;
+        std::ostream* saida;
+        std::shared_ptr<EntradaLista> entrada;
+        std::string erro; // Preenchido se a execução desta lane terminou com erro
+    };
+
+    explicit LaneInterpreter(std::array<Lane, N>& lanes);
+    void executar(const std::shared_ptr<NoDePrograma>& programa);
+
+private:
+    std::array<Lane, N>& lanes;
+    std::unordered_map<std::string, Lanes> variables;
+    std::unordered_map<std::string, std::vector<Lanes>> vetores;
+
+    int executarComando(const std::shared_ptr<NoDaAST>& comando, const std::shared_ptr<NoDePrograma>& programa);
+    Lanes avaliarExpressao(const std::shared_ptr<NoDaAST>& expressao);
+    std::array<uint64_t, N> getPosicao(const std::vector<Lanes>& vetor, const NoDaASTPtr& indice);
+    // Continua cada lane em um Interpreter escalar, a partir do comando "index"
+    void dividir(const std::shared_ptr<NoDePrograma>& programa, int index);
+};
+
+#endif //SIBASIC_LANEINTERPRETER_H
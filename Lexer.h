@@ -20,8 +20,6 @@ limitations under the License.
 #include "Token.h"
 #include <string>
 #include <vector>
-#include <unordered_map>
-#include <functional>
 #include <exception>
 
 class LexerException : public std::exception {
@@ -46,11 +44,6 @@ private:
     size_t length;
     std::string numeroDeLinhaBasic;
 
-    std::unordered_map<std::string, bool> comandos;
-    std::unordered_map<std::string, bool> funcoes;
-    std::unordered_map<char, bool> operadores;
-
-    std::string lerEnquanto(std::function<bool(int)> condicao);
     void validarComando(const std::vector<Token>& tokens);
 };
 
@@ -0,0 +1,51 @@
+#ifndef LEXER_DE_REFERENCIA_H
+#define LEXER_DE_REFERENCIA_H
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Token.h"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// O Lexer como era antes das tabelas de compilação, do SSE2 e do from_chars: unordered_maps
+// montados no construtor, isalpha/isdigit/isspace, lerEnquanto com std::function e os NUMEROs
+// só com o texto (o interpretador chamava stod a cada execução). Não faz parte do sibasic:
+// serve de referência para o teste de equivalência (testelexer.cpp) e para a medição de
+// desempenho (medicaolexer.cpp). Também não valida o comando (validarComando), cujas regras
+// mudaram com os comandos novos.
+class LexerDeReferencia {
+public:
+    LexerDeReferencia();
+
+    std::vector<Token> tokenize(const std::string& input);
+
+private:
+    std::string input;
+    size_t pos;
+    size_t length;
+    std::string numeroDeLinhaBasic;
+
+    std::unordered_map<std::string, bool> comandos;
+    std::unordered_map<std::string, bool> funcoes;
+    std::unordered_map<char, bool> operadores;
+
+    std::string lerEnquanto(std::function<bool(int)> condicao);
+};
+
+#endif // LEXER_DE_REFERENCIA_H
@@ -0,0 +1,84 @@
+#ifndef SIBASIC_OTIMIZADOR_H
+#define SIBASIC_OTIMIZADOR_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Otimizações feitas na carga, depois do Resolvedor. Monta os blocos básicos e o grafo de
+// fluxo a partir dos GOTO e IF, encontra os laços naturais (arestas de volta para um
+// bloco que domina a origem) e troca subexpressões puras por temporários (NoDeTemporario):
+// - invariantes de um laço (nenhuma variável lida é alterada no corpo) passam a ser
+//   calculadas uma vez por entrada no laço;
+// - repetidas dentro de um bloco, sem alteração das variáveis entre as ocorrências,
+//   passam a ser calculadas uma vez por execução do bloco.
+// O temporário só é calculado no primeiro uso, na mesma posição do programa original:
+// erros de execução continuam aparecendo no mesmo comando.
+class Otimizador {
+public:
+    explicit Otimizador(NoDePrograma& programa);
+    void otimizar();
+    // Blocos, laços e transformações aplicadas (usado com -v)
+    void mostrar(std::ostream& saida) const;
+    // Desfaz os temporários para que o programa possa ser resolvido de novo (modo interativo)
+    static void restaurar(NoDePrograma& programa);
+    // Visita cada expressão usada diretamente pelo comando (sem descer nas subexpressões)
+    static void paraCadaExpressao(const NoDaASTPtr& comando, const std::function<void(NoDaASTPtr&)>& visitar);
+    static void paraCadaFilho(const NoDaASTPtr& expressao, const std::function<void(NoDaASTPtr&)>& visitar);
+
+private:
+    struct Bloco {
+        int inicio;
+        int fim;
+        std::vector<int> sucessores;
+        std::vector<int> predecessores;
+    };
+    struct Laco {
+        int cabecalho; // Bloco
+        std::vector<bool> blocos;
+        size_t tamanho = 0;
+        // Variáveis e vetores alterados no corpo
+        std::unordered_set<std::string> escritas;
+        // Há comandos que o Otimizador não conhece: o laço não é otimizado
+        bool desconhecido = false;
+        // Texto da invariante -> temporário: a mesma invariante usa um só temporário no laço
+        std::unordered_map<std::string, int> temporarios;
+    };
+
+    NoDePrograma& programa;
+    std::vector<Bloco> blocos;
+    std::vector<int> blocoDoComando;
+    std::vector<Laco> lacos;
+    std::vector<std::string> transformacoes;
+
+    void montarBlocos();
+    void encontrarLacos();
+    void moverInvariantes();
+    void eliminarRepetidas();
+    void moverInvariantes(NoDaASTPtr& expressao, const std::vector<int>& lacosDoComando, const std::string& linha);
+    // Troca a expressão por um temporário; com indice < 0 cria um novo
+    int envolver(NoDaASTPtr& expressao, int indice);
+
+    // Variáveis e vetores alterados pelo comando
+    static std::vector<std::string> escreve(const NoDaASTPtr& comando);
+};
+
+#endif //SIBASIC_OTIMIZADOR_H
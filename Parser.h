@@ -18,34 +18,138 @@ limitations under the License.
 */
 
 #include "Token.h"
+#include "Vetor.h"
+#include <atomic>
+#include <charconv>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
 #include <exception>
 #include <optional>
+#include <unordered_map>
+#include <utility>
 
 class NoDaAST {
 public:
+    NoDaAST() {
+        criados.fetch_add(1, std::memory_order_relaxed);
+    }
     virtual ~NoDaAST() = default;
+    // Nós criados desde o início do processo (--stats)
+    static inline std::atomic<uint64_t> criados{0};
 };
 
 using NoDaASTPtr = std::shared_ptr<NoDaAST>;
 
+// Nomes de variáveis e vetores do programa. Cada nome recebe um número ("slot") na carga;
+// os nós guardam esse número e o Interpreter acessa a variável sem procurar pelo nome.
+class TabelaDeSimbolos {
+public:
+    // Retorna o slot do nome, criando um novo se ainda não existir
+    int slot(const std::string& nome);
+    // Retorna -1 se o nome não existir
+    int procurar(const std::string& nome) const;
+    size_t tamanho() const { return nomes.size(); }
+    // Variáveis com sufixo % (I%) são inteiras de 64 bits
+    static bool inteira(const std::string& nome) { return !nome.empty() && nome.back() == '%'; }
+    const std::string& nome(int slot) const { return nomes[slot]; }
+
+private:
+    std::vector<std::string> nomes;
+    std::unordered_map<std::string, int> slots;
+};
+
+// Laço de contador reconhecido na carga:
+//   <inicio> ... LET V = V + passo ... <fim> IF V < limite THEN <inicio>
+// sem outros desvios nem entradas no meio. A guarda avalia uma vez, na entrada do laço,
+// a faixa de valores que V vai assumir; se todos os acessos V + deslocamento couberem
+// nos vetores, as verificações de limite por acesso são dispensadas até a saída do laço.
+struct LacoContado {
+    struct Acesso {
+        int slotVetor;
+        size_t dimensao;
+        double deslocamento;
+        bool depoisDoIncremento;
+    };
+    int inicio;
+    int fim;
+    int slotContador;
+    double passo; // Negativo para IF V > limite
+    NoDaASTPtr limite;
+    std::vector<Acesso> acessos;
+};
+
+// Laço natural do grafo de fluxo (Otimizador): cabeçalho e comandos do corpo.
+// Os temporários do laço valem enquanto a execução não sai dele.
+struct LacoNatural {
+    int cabecalho;
+    // Faixas [inicio, fim] de índices de comandos que formam o corpo
+    std::vector<std::pair<int, int>> corpo;
+    std::vector<int> temporarios;
+
+    bool contem(int index) const {
+        for (const auto& [inicio, fim] : corpo) {
+            if (index >= inicio && index <= fim) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
 class NoDePrograma : public NoDaAST {
 public:
     std::vector<NoDaASTPtr> comandos;
+    // Número de linha BASIC -> índice do primeiro comando da linha em "comandos"
+    std::unordered_map<std::string, int> indiceLinhas;
+    std::shared_ptr<TabelaDeSimbolos> simbolos = std::make_shared<TabelaDeSimbolos>();
+    // Preenchidos pelo Resolvedor
+    std::vector<LacoContado> lacos;
+    bool usaInteiros = false;
+    // Hash do fonte: um checkpoint só pode ser retomado pelo mesmo programa (0 se desconhecido)
+    uint64_t hashDoFonte = 0;
+    // Preenchidos pelo Otimizador
+    std::vector<LacoNatural> lacosNaturais;
+    int numeroTemporarios = 0;
+
+    // Reconstrói o índice de linhas; deve ser chamado depois de montar "comandos"
+    void indexarLinhas();
+    // Retorna -1 se a linha não existir
+    int indiceDaLinha(const std::string& numeroLinha) const;
 };
 
 class NoDeComando : public NoDaAST {
 public:
     std::string numeroLinha;
+    // Índice em NoDePrograma::lacos do laço que começa neste comando, ou -1
+    int inicioDeLaco = -1;
+    // Índice em NoDePrograma::lacosNaturais do laço cujo cabeçalho é este comando, ou -1
+    int lacoNatural = -1;
+    // Primeiro comando de um bloco: temporários descartados sempre que ele executa
+    std::vector<int> temporariosDoBloco;
+    // Tipo do comando, anotado pelo Interpreter na primeira execução (0: ainda não executado).
+    // Atômico porque a AST é compartilhada entre threads (--sweep, --serve)
+    std::atomic<uint8_t> forma{0};
     virtual ~NoDeComando() = default;
 };
 
+// Indexador de um elemento de vetor: uma expressão qualquer por dimensão
+struct IndiceDeVetor {
+    NoDaASTPtr expressao;
+    // Literal validado na carga contra o DIM: não precisa de verificação em execução
+    bool verificado = false;
+    // Laço cuja guarda, quando aprovada, dispensa a verificação deste índice
+    int laco = -1;
+};
+
 class NoDoComandoLET : public NoDeComando {
 public:
     std::string identificador;
-    std::string posicao;
+    int slot = -1;
+    bool inteira = false;
+    // Vazio se não for um vetor
+    std::vector<IndiceDeVetor> indices;
     NoDaASTPtr expressao;
 };
 
@@ -64,24 +168,89 @@ public:
 class NoDoComandoDIM : public NoDeComando {
 public:
     std::string nomeVariavel;
-    int numeroOcorrencias = 0;
+    int slot = -1;
+    // DIM M 1000, 1000: tamanho de cada dimensão e o total de elementos
+    std::vector<uint64_t> dimensoes;
+    uint64_t numeroOcorrencias = 0;
+    // DIM A 1000 AS BIT: tipo compacto dos elementos
+    TipoDeElemento tipo = TipoDeElemento::DOUBLE;
+    // DIM A 5000000000 FILE "a.bin" [RANDOM]: vetor mapeado de um arquivo
+    std::string arquivo;
+    bool acessoAleatorio = false;
 };
 
 class NoDoComandoEND : public NoDeComando {
 
 };
 
+// LOAD A FROM "<arquivo>" [COLUMN n]: carrega um vetor de um CSV ou de um arquivo .f64
+class NoDoComandoLOAD : public NoDeComando {
+public:
+    std::string nomeVariavel;
+    int slot = -1;
+    std::string arquivo;
+    // Coluna do CSV, a partir de 1; 0 lê todas
+    unsigned coluna = 0;
+    // O vetor tem DIM no programa: o LOAD só valida o tamanho (preenchido pelo Resolvedor)
+    bool declarado = false;
+};
+
+// SAVE A, B TO "<arquivo>" [ASYNC]: grava vetores em um CSV ou em um arquivo .f64
+class NoDoComandoSAVE : public NoDeComando {
+public:
+    std::vector<std::string> nomes;
+    std::vector<int> slots;
+    std::string arquivo;
+    // ASYNC: os vetores são copiados e gravados por outra thread
+    bool assincrono = false;
+};
+
+// PARALLEL FOR I = <início> TO <fim> [REDUCE S, ...] ... NEXT I: as voltas (I = início,
+// início + 1, ..., até passar do fim) são divididas entre threads. O corpo só tem LET; cada
+// thread tem a sua cópia das variáveis simples e os vetores são compartilhados. As variáveis
+// do REDUCE só recebem somas (LET S = S + ...), combinadas sempre na mesma ordem.
+class NoDoComandoPARALLEL : public NoDeComando {
+public:
+    std::string contador;
+    int slotContador = -1;
+    NoDaASTPtr inicio;
+    NoDaASTPtr fim;
+    std::vector<std::string> reducoes;
+    std::vector<int> slotsReducoes;
+    // Preenchidos pelo Resolvedor: posições do primeiro comando do corpo e do NEXT e vetores
+    // alterados no corpo
+    int corpo = -1;
+    int next = -1;
+    std::vector<std::string> vetoresEscritos;
+    std::vector<int> slotsVetoresEscritos;
+};
+
+class NoDoComandoNEXT : public NoDeComando {
+public:
+    std::string contador;
+};
+
+// CHECKPOINT ["<arquivo>"]: grava o estado da execução; sem arquivo, usa "<script>.ckpt"
+class NoDoComandoCHECKPOINT : public NoDeComando {
+public:
+    std::string arquivo;
+};
+
 class NoDoComandoIF : public NoDeComando {
 public:
     NoDaASTPtr operando1;
     std::string operadorLogico;
     NoDaASTPtr operando2;
     std::string numeroLinha;
+    // Índice do laço fechado por este IF, ou -1
+    int fimDeLaco = -1;
 };
 
 class NoDoComandoINPUT : public NoDeComando {
 public:
     std::string identificador;
+    int slot = -1;
+    bool inteira = false;
 };
 
 class NoDoComandoDRAW : public NoDeComando {
@@ -91,9 +260,12 @@ public:
     NoDaASTPtr altura;
 };
 
+// Com ALL (PLOT ALL X, Y, R, BLUE), cada atributo numérico que é só o nome de um vetor vale um
+// elemento dele por desenho, e os demais valem o mesmo para todos: um desenho por elemento
 class NoDoComandoPLOT : public NoDeComando {
 public:
     // Os atributos exceto o "preencher" podem ser variáveis ou números
+    bool todos = false;
     NoDaASTPtr posicaoX;
     NoDaASTPtr posicaoY;
     NoDaASTPtr espessura;
@@ -104,6 +276,7 @@ public:
 class NoDoComandoLINE : public NoDeComando {
 public:
     // Os atributos podem ser variáveis ou números
+    bool todos = false;
     NoDaASTPtr xInicial;
     NoDaASTPtr yInicial;
     NoDaASTPtr xFinal;
@@ -114,6 +287,7 @@ public:
 class NoDoComandoRECTANGLE : public NoDeComando {
 public:
     // Os atributos exceto o "preencher" podem ser variáveis ou números
+    bool todos = false;
     NoDaASTPtr xCantoSuperiorEsquerdo;
     NoDaASTPtr yCantoSuperiorEsquerdo;
     NoDaASTPtr xCantoInferiorDireito;
@@ -124,6 +298,13 @@ public:
 
 class NoDeExpressao : public NoDaAST {
 public:
+    // Tipo estático definido na carga: expressão só com inteiros (ao menos uma variável I%),
+    // avaliada em aritmética de 64 bits
+    bool inteira = false;
+    // Especializações escolhidas pelo Interpreter na primeira avaliação como real e como
+    // inteira (0: ainda não avaliada). Ver Interpreter::especializarReal
+    std::atomic<uint8_t> formaReal{0};
+    std::atomic<uint8_t> formaInteira{0};
     virtual ~NoDeExpressao() = default;
 };
 
@@ -149,16 +330,32 @@ public:
 class NoDeNumero : public NoDeExpressao {
 public:
     std::string value;
-    explicit NoDeNumero(const std::string& value) : value(value) {}
+    double valor;
+    // Parte inteira do texto, usada quando o literal aparece em uma expressão inteira
+    int64_t inteiro = 0;
+    NoDeNumero(const std::string& value, double valor) : value(value), valor(valor) {
+        std::from_chars(value.data(), value.data() + value.size(), inteiro);
+    }
 };
 
 class NoDeIdentificador : public NoDeExpressao {
 public:
     std::string name;
-    std::string posicao;
+    int slot = -1;
+    std::vector<IndiceDeVetor> indices;
     explicit NoDeIdentificador(const std::string& name) : name(name) {}
 };
 
+// Subexpressão pura calculada uma vez e reaproveitada (Otimizador): invariante de um laço
+// ou repetida dentro de um bloco. O valor é guardado no primeiro uso e descartado na
+// entrada do laço ou do bloco; "expressao" é a subexpressão original.
+class NoDeTemporario : public NoDeExpressao {
+public:
+    int indice;
+    NoDaASTPtr expressao;
+    NoDeTemporario(int indice, NoDaASTPtr expressao) : indice(indice), expressao(std::move(expressao)) {}
+};
+
 class ParserException : public std::exception {
 public:
     explicit ParserException(const std::string& message);
@@ -185,6 +382,11 @@ private:
     std::shared_ptr<NoDoComandoGOTO> parseComandoGOTO();
     std::shared_ptr<NoDoComandoDIM> parseComandoDIM();
     std::shared_ptr<NoDoComandoEND> parseComandoEND();
+    std::shared_ptr<NoDoComandoCHECKPOINT> parseComandoCHECKPOINT();
+    std::shared_ptr<NoDoComandoLOAD> parseComandoLOAD();
+    std::shared_ptr<NoDoComandoSAVE> parseComandoSAVE();
+    std::shared_ptr<NoDoComandoPARALLEL> parseComandoPARALLEL();
+    std::shared_ptr<NoDoComandoNEXT> parseComandoNEXT();
     std::shared_ptr<NoDoComandoIF> parseComandoIF();
     std::shared_ptr<NoDoComandoINPUT> parseComandoINPUT();
     std::shared_ptr<NoDoComandoDRAW> parseComandoDRAW();
@@ -196,9 +398,12 @@ private:
     std::shared_ptr<NoDeExpressao> parseMultDiv();
     std::shared_ptr<NoDeExpressao> parseExponenciacao();
     std::shared_ptr<NoDeExpressao> parsePrimaria();
+    std::vector<IndiceDeVetor> parseIndices();
 
     bool encontrar(TokenType type, const std::string& value = "");
     std::optional<Token> consumir(TokenType type, const std::string& value = "", bool deveExistir = true);
+    // Consome o ALL de PLOT/LINE/RECTANGLE ALL. Seguido de vírgula, ALL é uma variável.
+    bool consumirTodos();
 
 
 };
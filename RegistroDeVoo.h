@@ -0,0 +1,76 @@
+#ifndef SIBASIC_REGISTRODEVOO_H
+#define SIBASIC_REGISTRODEVOO_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Registro de voo: buffer circular de tamanho fixo com os últimos comandos executados, os
+// desvios tomados e os valores gravados em variáveis. Registrar um evento é uma cópia de 24
+// bytes, sem alocação. Gravado em binário quando há erro de execução ou no SIGUSR1, e
+// decodificado com "sibasic --decode-trace <arquivo>".
+class RegistroDeVoo {
+public:
+    enum Tipo : uint32_t { COMANDO = 1, DESVIO, ESCRITA, ESCRITA_INTEIRA, ESCRITA_VETOR };
+    struct Evento {
+        uint32_t tipo;
+        // Índice do comando em NoDePrograma::comandos ou slot da variável
+        uint32_t indice;
+        // Destino do desvio, valor inteiro ou posição linear no vetor
+        uint64_t extra;
+        double valor;
+    };
+
+    // A capacidade é arredondada para uma potência de 2
+    explicit RegistroDeVoo(size_t capacidade = 4096);
+
+    void comando(int indice) {
+        registrar({COMANDO, static_cast<uint32_t>(indice), 0, 0.0});
+    }
+    void desvio(int origem, int destino) {
+        registrar({DESVIO, static_cast<uint32_t>(origem), static_cast<uint64_t>(destino), 0.0});
+    }
+    void escrita(int slot, double valor) {
+        registrar({ESCRITA, static_cast<uint32_t>(slot), 0, valor});
+    }
+    void escritaInteira(int slot, int64_t valor) {
+        registrar({ESCRITA_INTEIRA, static_cast<uint32_t>(slot), static_cast<uint64_t>(valor), 0.0});
+    }
+    void escritaVetor(int slot, uint64_t posicao, double valor) {
+        registrar({ESCRITA_VETOR, static_cast<uint32_t>(slot), posicao, valor});
+    }
+
+    // Grava os eventos (do mais antigo ao mais recente) com os números de linha e os nomes de
+    // variáveis do programa, para que o arquivo possa ser lido sem o fonte. Lança runtime_error.
+    void gravar(const std::string& caminho, const std::string& motivo, const NoDePrograma& programa) const;
+    // Mostra um arquivo gravado por "gravar" como texto
+    static void decodificar(const std::string& caminho, std::ostream& saida);
+
+private:
+    std::vector<Evento> eventos;
+    uint64_t mascara;
+    uint64_t total = 0;
+
+    void registrar(const Evento& evento) {
+        eventos[total & mascara] = evento;
+        ++total;
+    }
+};
+
+#endif //SIBASIC_REGISTRODEVOO_H
@@ -0,0 +1,64 @@
+#ifndef SIBASIC_REPL_H
+#define SIBASIC_REPL_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Modo interativo. Cada linha numerada digitada substitui apenas aquela linha do programa:
+// só ela passa pelo Lexer e pelo Parser. O programa analisado é mantido entre os RUN e só
+// é remontado (sem nova análise das linhas) quando linhas são inseridas ou removidas.
+// O Resolvedor e o Otimizador não são incrementais: depois de qualquer alteração, o RUN
+// refaz os dois no programa inteiro; sem alterações, reaproveita o resultado.
+class Repl {
+public:
+    explicit Repl(std::string basicScriptName);
+
+    // Carrega um fonte inteiro, linha a linha, como se tivesse sido digitado
+    void carregar(const std::string& fonte);
+    // Trata uma linha digitada (linha numerada ou comando RUN, LIST, DELETE, NEW, EXIT).
+    // Retorna false quando o usuário pede para sair.
+    bool processarLinha(const std::string& linha);
+    void executar(std::istream& entrada);
+
+private:
+    struct LinhaDoPrograma {
+        std::string fonte;
+        std::vector<NoDaASTPtr> comandos;
+    };
+
+    std::string basicScriptName;
+    std::map<long, LinhaDoPrograma> linhas;
+    // Forma compilada reaproveitada entre os RUN
+    std::shared_ptr<NoDePrograma> programa;
+    // Linhas foram inseridas ou removidas: "programa" precisa ser remontado
+    bool remontar;
+    // "programa" já foi resolvido e otimizado e não mudou desde então
+    bool analisado;
+
+    void editarLinha(long numero, const std::string& linha);
+    void apagarLinhas(long primeira, long ultima);
+    void listar(long primeira, long ultima);
+    void run();
+    void montarPrograma();
+    void validarDesenhos();
+};
+
+#endif //SIBASIC_REPL_H
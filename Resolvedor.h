@@ -0,0 +1,70 @@
+#ifndef SIBASIC_RESOLVEDOR_H
+#define SIBASIC_RESOLVEDOR_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Análise do programa inteiro, feita uma vez na carga, depois do Parser:
+// - cada variável e vetor recebe um slot na tabela de símbolos do programa;
+// - índices literais de vetores com um único DIM são validados contra as dimensões
+//   (índice fora do DIM é erro de carga, e o acesso não é mais verificado em execução);
+// - laços de contador são reconhecidos para que a verificação de limites dos acessos
+//   indexados pelo contador rode uma vez por laço (ver LacoContado);
+// - as expressões recebem tipo estático: só com variáveis I% e literais inteiros (+, -, *)
+//   são inteiras; qualquer mistura com reais é real, com os inteiros promovidos a double;
+// - cada PARALLEL FOR é ligado ao seu NEXT e o corpo é verificado: as voltas não podem
+//   depender umas das outras (ver verificarParalelo).
+// Pode ser executado de novo sobre o mesmo programa (modo interativo): tudo é recalculado.
+class Resolvedor {
+public:
+    explicit Resolvedor(NoDePrograma& programa);
+    // Lança ParserException para índice literal fora do DIM, variável inteira usada como vetor
+    // ou PARALLEL FOR cujas voltas dependem umas das outras
+    void resolver();
+
+private:
+    NoDePrograma& programa;
+    // LITERAL_INTEIRO: só literais inteiros; vira inteira quando combinada com uma variável I%
+    enum class Tipo { REAL, LITERAL_INTEIRO, INTEIRO };
+
+    // Vetores declarados por um único DIM: as dimensões valem para todos os acessos
+    std::unordered_map<std::string, std::vector<uint64_t>> dimensoesConhecidas;
+    bool usaInteiros = false;
+    // Variável simples -> comandos que a leem (usado na verificação dos PARALLEL FOR)
+    std::unordered_map<std::string, std::unordered_set<int>> leitores;
+    int comandoAtual = -1;
+
+    void resolverComando(const NoDaASTPtr& comando);
+    Tipo resolverExpressao(const NoDaASTPtr& expressao, const std::string& numeroLinha);
+    int resolverNome(const std::string& nome, bool indexado, const std::string& numeroLinha);
+    void resolverIndices(const std::string& vetor, std::vector<IndiceDeVetor>& indices,
+                         const std::string& numeroLinha);
+    void ligarParalelos();
+    void verificarParalelo(NoDoComandoPARALLEL& paralelo, int inicio);
+    void reconhecerLacos();
+    bool reconhecerLaco(int fim, const std::vector<bool>& destinos, LacoContado& laco);
+    void coletarAcessos(const NoDaASTPtr& expressao, const std::string& contador, int idLaco,
+                        bool depoisDoIncremento, LacoContado& laco);
+    void coletarAcessos(const std::string& vetor, std::vector<IndiceDeVetor>& indices, const std::string& contador,
+                        int idLaco, bool depoisDoIncremento, LacoContado& laco);
+};
+
+#endif //SIBASIC_RESOLVEDOR_H
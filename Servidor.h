@@ -0,0 +1,32 @@
+#ifndef SIBASIC_SERVIDOR_H
+#define SIBASIC_SERVIDOR_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include <memory>
+#include <string>
+
+// Modo servidor (só Linux): escuta em um socket Unix e executa o programa (já analisado) uma
+// vez por conexão. Cada linha recebida fornece valores para os INPUT; a saída dos PRINT é
+// enviada pela conexão, que é fechada quando o programa termina.
+// Há um laço de eventos (epoll) por thread, e cada laço alterna entre as suas sessões com
+// Interpreter::passo: uma sessão parada em INPUT não ocupa a thread.
+// Retorna quando o processo recebe SIGINT ou SIGTERM. Lança runtime_error se não conseguir
+// abrir o socket.
+void executarServidor(const std::string& caminhoSocket, const std::string& basicScriptName,
+                      const std::shared_ptr<NoDePrograma>& programa, unsigned numeroThreads);
+
+#endif //SIBASIC_SERVIDOR_H
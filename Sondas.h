@@ -0,0 +1,40 @@
+#ifndef SIBASIC_SONDAS_H
+#define SIBASIC_SONDAS_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Sondas USDT do provedor "sibasic", vistas pelo bpftrace e pelo perf no processo em execução,
+// sem reiniciá-lo. Só existem no executável compilado com -DSIBASIC_USDT=ON; sem ninguém
+// ligado a elas, cada sonda é uma instrução nop. Os textos são ponteiros para char (str() no bpftrace).
+// - comando(linha, indice): antes de executar cada comando; linha é o número da linha BASIC
+// - desvio(linhaOrigem, linhaDestino): GOTO, IF ou PARALLEL FOR que desviou; o destino é ""
+//   quando o desvio vai para depois do último comando
+// - dim(nome, elementos, arquivo): vetor criado pelo DIM; arquivo é "" para vetores em memória
+// - svg(caminho, bytes): SVG gravado pelo DRAW FINISH (ou repetido pelo --cache)
+#if defined(SIBASIC_USDT)
+#include <sys/sdt.h>
+#define SONDA_COMANDO(linha, indice) DTRACE_PROBE2(sibasic, comando, linha, indice)
+#define SONDA_DESVIO(linhaOrigem, linhaDestino) DTRACE_PROBE2(sibasic, desvio, linhaOrigem, linhaDestino)
+#define SONDA_DIM(nome, elementos, arquivo) DTRACE_PROBE3(sibasic, dim, nome, elementos, arquivo)
+#define SONDA_SVG(caminho, bytes) DTRACE_PROBE2(sibasic, svg, caminho, bytes)
+#else
+#define SONDA_COMANDO(linha, indice) ((void)0)
+#define SONDA_DESVIO(linhaOrigem, linhaDestino) ((void)0)
+#define SONDA_DIM(nome, elementos, arquivo) ((void)0)
+#define SONDA_SVG(caminho, bytes) ((void)0)
+#endif
+
+#endif //SIBASIC_SONDAS_H
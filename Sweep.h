@@ -0,0 +1,39 @@
+#ifndef SIBASIC_SWEEP_H
+#define SIBASIC_SWEEP_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "Parser.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Uma linha do CSV: valores para os comandos INPUT, na ordem em que forem executados
+struct LinhaDeVarredura {
+    int numeroLinha;
+    std::string texto;
+    std::vector<double> valores;
+};
+
+std::vector<LinhaDeVarredura> lerArquivoDeVarredura(const std::string& arquivoCsv);
+
+// Executa o programa (já analisado) uma vez por linha do CSV, em paralelo, cada linha com seu
+// próprio Interpreter. A saída dos PRINT de cada linha é gravada em "saida" na ordem do CSV.
+// Com "lanes" igual a 4 ou 8, cada thread executa grupos de linhas juntas no LaneInterpreter.
+void executarVarredura(const std::string& basicScriptName, const std::shared_ptr<NoDePrograma>& programa,
+                       const std::string& arquivoCsv, unsigned numeroThreads, std::ostream& saida,
+                       int lanes = 1);
+
+#endif //SIBASIC_SWEEP_H
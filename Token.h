@@ -27,6 +27,8 @@ enum TokenType {
 struct Token {
     TokenType type;
     std::string value;
+    // Valor já convertido de um NUMERO
+    double numero = 0.0;
 };
 
 #endif // TOKEN_H
\ No newline at end of file
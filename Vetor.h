@@ -0,0 +1,218 @@
+#ifndef SIBASIC_VETOR_H
+#define SIBASIC_VETOR_H
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Tipo dos elementos de um vetor (DIM A 1000 AS BIT). Os tipos compactos convertem o valor ao
+// gravar: BIT guarda 1 para qualquer valor diferente de 0, INT8 e INT32 descartam a parte
+// fracionária e FLOAT arredonda para precisão simples. Valor fora da faixa do tipo é erro.
+enum class TipoDeElemento : uint8_t { DOUBLE, FLOAT, INT32, INT8, BIT };
+
+// Armazenamento de um vetor declarado com DIM. Os elementos ficam em memória ou,
+// com DIM ... FILE, em um arquivo mapeado em memória que persiste entre execuções.
+// Vetores com várias dimensões (DIM M 1000, 1000) usam um único bloco contíguo em ordem
+// por linha: o último índice varia mais rápido.
+// Vetores grandes em memória começam esparsos: só os elementos gravados ocupam memória, em
+// uma tabela de hash com endereçamento aberto, e os demais valem 0. Quando a tabela passa a
+// ocupar tanto quanto o bloco contíguo (1/4 dos elementos gravados), o vetor vira denso.
+// Vetores de tipos compactos ficam sempre em um bloco contíguo de palavras de 64 bits: 1 bit,
+// 1 byte ou 4 bytes por elemento, em vez dos 8 de um double.
+class Vetor {
+public:
+    // A partir deste número de elementos, o vetor em memória começa esparso (8 MiB)
+    static constexpr uint64_t limiteEsparso = 1u << 20;
+
+    // Vetor em memória, com todos os elementos zerados
+    explicit Vetor(uint64_t tamanho);
+    explicit Vetor(const std::vector<uint64_t>& dimensoes, TipoDeElemento tipo = TipoDeElemento::DOUBLE);
+    // Sem dimensões, o vetor tem uma dimensão do tamanho dos valores
+    explicit Vetor(std::vector<double> valores, std::vector<uint64_t> dimensoes = {});
+    // Mapeia o arquivo (criando ou aumentando se necessário) como um vetor de doubles.
+    // Se o arquivo já existir, os valores gravados nele são mantidos.
+    static std::shared_ptr<Vetor> mapearArquivo(const std::string& caminho, const std::vector<uint64_t>& dimensoes,
+                                                bool acessoAleatorio = false);
+    // Mapeia um arquivo de doubles existente sem copiar (LOAD ... FROM "x.f64"). As páginas
+    // só são copiadas quando alteradas, e as alterações nunca voltam para o arquivo. Sem
+    // dimensões, o vetor tem as dimensões do cabeçalho ou uma dimensão do tamanho do arquivo;
+    // com dimensões, o arquivo deve ter exatamente esse número de elementos.
+    static std::shared_ptr<Vetor> mapearDados(const std::string& caminho, const std::vector<uint64_t>& dimensoes);
+    // Cabeçalho opcional do .f64 (gravado pelo SAVE): a marca, ordemDosBytesF64, o número de
+    // dimensões e as dimensões, todos com 8 bytes. Sem ele, o arquivo é só de doubles little-endian.
+    static const char marcaF64[8];
+    static constexpr uint64_t ordemDosBytesF64 = 0x0102030405060708ULL;
+    // Produto das dimensões; lança runtime_error se não couber em 64 bits (dimensões lidas de
+    // arquivos não passam pela validação do DIM)
+    static uint64_t contarElementos(const std::vector<uint64_t>& dimensoes);
+    ~Vetor();
+
+    Vetor(const Vetor&) = delete;
+    Vetor& operator=(const Vetor&) = delete;
+
+    uint64_t tamanho() const { return numeroElementos; }
+    const std::vector<uint64_t>& dimensoes() const { return tamanhoDimensoes; }
+    TipoDeElemento tipo() const { return tipoDosElementos; }
+    // Nome usado no DIM ("BIT"), e o tipo com esse nome; false se não houver
+    static const char* nomeDoTipo(TipoDeElemento tipo);
+    static bool tipoPeloNome(const std::string& nome, TipoDeElemento& tipo);
+    double ler(uint64_t posicao) const {
+        if (elementos != nullptr) {
+            return elementos[posicao];
+        }
+        return compacto != nullptr ? lerCompacto(posicao) : lerEsparso(posicao);
+    }
+    void escrever(uint64_t posicao, double valor) {
+        if (elementos != nullptr) {
+            elementos[posicao] = valor;
+        } else if (compacto != nullptr) {
+            escreverCompacto(posicao, valor);
+        } else {
+            escreverEsparso(posicao, valor);
+        }
+    }
+    // Leitura e gravação de "quantos" elementos a partir de "posicao", convertidos de e para
+    // double em laços sobre as palavras de 64 bits (64 elementos BIT por palavra)
+    void lerBloco(uint64_t posicao, uint64_t quantos, double* destino) const;
+    void escreverBloco(uint64_t posicao, uint64_t quantos, const double* origem);
+    // Elementos contíguos de doubles; nullptr enquanto o vetor for esparso e nos tipos compactos
+    const double* dados() const { return elementos; }
+    double* dados() { return elementos; }
+    bool esparso() const { return elementos == nullptr && compacto == nullptr && numeroElementos > 0; }
+    // Bloco dos tipos compactos, como é guardado na memória; nullptr nos vetores de doubles
+    const uint64_t* palavras() const { return compacto; }
+    uint64_t* palavras() { return compacto; }
+    size_t numeroPalavras() const { return memoriaCompacta.size(); }
+    // PARALLEL FOR: threads diferentes gravam bits vizinhos da mesma palavra, então enquanto
+    // compartilhado os elementos BIT são lidos e gravados com operações atômicas
+    void compartilhar(bool valor) { compartilhado = valor; }
+    // Elementos gravados de um vetor esparso, em ordem qualquer
+    void paraCadaGravado(const std::function<void(uint64_t, double)>& visitar) const;
+    // Passa para o bloco contíguo. Retorna false, e continua esparso, se faltar memória.
+    bool densificar();
+    // Vetor persistente do DIM ... FILE (não inclui a cópia privada de mapearDados)
+    bool mapeado() const { return mapa != nullptr && !copiaPrivada; }
+    // Vetores mapeados: arquivo e forma de acesso usados no DIM ... FILE
+    const std::string& arquivo() const { return caminhoArquivo; }
+    bool acessoAleatorio() const { return aleatorio; }
+    // Grava no arquivo as páginas alteradas do vetor mapeado (usado no checkpoint)
+    void sincronizar();
+
+private:
+    Vetor();
+
+    std::vector<double> memoria;
+    std::vector<uint64_t> tamanhoDimensoes;
+    double* elementos;
+    TipoDeElemento tipoDosElementos = TipoDeElemento::DOUBLE;
+    std::vector<uint64_t> memoriaCompacta;
+    uint64_t* compacto = nullptr;
+    bool compartilhado = false;
+    uint64_t numeroElementos;
+    void* mapa;
+    size_t tamanhoMapa;
+    std::string caminhoArquivo;
+    bool aleatorio = false;
+    bool copiaPrivada = false;
+
+    struct Entrada {
+        uint64_t posicao;
+        double valor;
+    };
+    static constexpr uint64_t posicaoVazia = UINT64_MAX;
+    // Tabela do vetor esparso: tamanho potência de 2, no máximo metade ocupada
+    std::vector<Entrada> tabela;
+    uint64_t ocupadas = 0;
+
+    double lerCompacto(uint64_t posicao) const {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(compacto);
+        switch (tipoDosElementos) {
+        case TipoDeElemento::BIT: {
+            const uint64_t* palavra = compacto + (posicao >> 6);
+            uint64_t bits = compartilhado ? __atomic_load_n(palavra, __ATOMIC_RELAXED) : *palavra;
+            return static_cast<double>((bits >> (posicao & 63)) & 1);
+        }
+        case TipoDeElemento::INT8:
+            return static_cast<signed char>(bytes[posicao]);
+        case TipoDeElemento::INT32: {
+            int32_t valor;
+            std::memcpy(&valor, bytes + posicao * sizeof(valor), sizeof(valor));
+            return valor;
+        }
+        default: {
+            float valor;
+            std::memcpy(&valor, bytes + posicao * sizeof(valor), sizeof(valor));
+            return valor;
+        }
+        }
+    }
+    void escreverCompacto(uint64_t posicao, double valor) {
+        auto* bytes = reinterpret_cast<unsigned char*>(compacto);
+        switch (tipoDosElementos) {
+        case TipoDeElemento::BIT: {
+            uint64_t* palavra = compacto + (posicao >> 6);
+            uint64_t mascara = uint64_t{1} << (posicao & 63);
+            if (compartilhado) {
+                valor != 0 ? __atomic_fetch_or(palavra, mascara, __ATOMIC_RELAXED)
+                           : __atomic_fetch_and(palavra, ~mascara, __ATOMIC_RELAXED);
+            } else {
+                *palavra = valor != 0 ? *palavra | mascara : *palavra & ~mascara;
+            }
+            break;
+        }
+        case TipoDeElemento::INT8:
+            bytes[posicao] = static_cast<unsigned char>(static_cast<signed char>(converterInteiro(valor)));
+            break;
+        case TipoDeElemento::INT32: {
+            auto inteiro = static_cast<int32_t>(converterInteiro(valor));
+            std::memcpy(bytes + posicao * sizeof(inteiro), &inteiro, sizeof(inteiro));
+            break;
+        }
+        default: {
+            float real = converterFloat(valor);
+            std::memcpy(bytes + posicao * sizeof(real), &real, sizeof(real));
+            break;
+        }
+        }
+    }
+    // INT8 e INT32: parte inteira, validada contra a faixa do tipo (rejeita também NaN)
+    int64_t converterInteiro(double valor) const {
+        bool int8 = tipoDosElementos == TipoDeElemento::INT8;
+        if (!(valor > (int8 ? -129.0 : -2147483649.0) && valor < (int8 ? 128.0 : 2147483648.0))) {
+            foraDaFaixa(valor);
+        }
+        return static_cast<int64_t>(valor);
+    }
+    float converterFloat(double valor) const {
+        if (std::fabs(valor) > std::numeric_limits<float>::max() && std::isfinite(valor)) {
+            foraDaFaixa(valor);
+        }
+        return static_cast<float>(valor);
+    }
+    [[noreturn]] void foraDaFaixa(double valor) const;
+    double lerEsparso(uint64_t posicao) const;
+    void escreverEsparso(uint64_t posicao, double valor);
+    size_t procurar(uint64_t posicao) const;
+    void redimensionarTabela(size_t capacidade);
+};
+
+#endif //SIBASIC_VETOR_H
@@ -0,0 +1,26 @@
+10 DIM A 100 AS BIT
+20 LET I = 2
+30 IF I > 100 THEN 60
+40 LET A[I] = 1
+50 LET I = I + 1
+55 GOTO 30
+60 LET I = 2
+70 IF I > 100 THEN 120
+80 IF A[I] = 0 THEN 110
+90 LET J = I * 2
+100 IF J > 100 THEN 110
+105 LET A[J] = 0
+107 LET J = J + I
+108 GOTO 100
+110 LET I = I + 1
+115 GOTO 70
+* Na próxima linha você digita o número que quer verificar:
+120 PRINT "DIGITE UM NÚMERO DE 1 A 100"
+121 INPUT N
+122 PRINT "VERIFICANDO SE O NUMERO É PRIMO"
+123 PRINT N
+130 IF A[N] = 0 THEN 160
+140 PRINT "PRIMO"
+150 GOTO 170
+160 PRINT "NÃO É PRIMO"
+170 END
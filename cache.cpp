@@ -0,0 +1,216 @@
+#include "Cache.h"
+#include "Otimizador.h"
+#include "util.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    const char marca[8] = {'S', 'I', 'B', 'C', 'A', 'C', 'H', '1'};
+    // Lida com outro valor, indica um arquivo gravado em máquina com outra ordem de bytes
+    constexpr uint64_t ordemDosBytes = 0x0102030405060708ULL;
+
+    std::string hexadecimal(uint64_t valor) {
+        char texto[17];
+        std::snprintf(texto, sizeof(texto), "%016llx", static_cast<unsigned long long>(valor));
+        return texto;
+    }
+
+    void acrescentar(std::string& destino, uint64_t valor) {
+        destino.append(reinterpret_cast<const char*>(&valor), sizeof(valor));
+    }
+
+    void acrescentar(std::string& destino, const std::string& texto) {
+        acrescentar(destino, static_cast<uint64_t>(texto.size()));
+        destino += texto;
+    }
+
+    // Lê os campos em ordem; qualquer falta de bytes torna "ok" falso
+    class Leitura {
+    public:
+        explicit Leitura(const std::string& dados) : dados(dados) {}
+        bool ok = true;
+
+        uint64_t inteiro() {
+            uint64_t valor = 0;
+            if (dados.size() - posicao < sizeof(valor)) {
+                ok = false;
+                return 0;
+            }
+            std::memcpy(&valor, dados.data() + posicao, sizeof(valor));
+            posicao += sizeof(valor);
+            return valor;
+        }
+
+        std::string texto() {
+            uint64_t tamanho = inteiro();
+            if (!ok || dados.size() - posicao < tamanho) {
+                ok = false;
+                return {};
+            }
+            std::string resultado = dados.substr(posicao, tamanho);
+            posicao += tamanho;
+            return resultado;
+        }
+
+        bool fim() const { return posicao == dados.size(); }
+
+    private:
+        const std::string& dados;
+        size_t posicao = 0;
+    };
+}
+
+CacheDeExecucao::CacheDeExecucao(const std::string& diretorio, const std::string& versao, const std::string& fonte,
+                                 const std::string* entrada)
+    : versao(versao), hashDoFonte(hashDoTexto(fonte)), tamanhoDoFonte(fonte.size()),
+      hashDaEntrada(entrada != nullptr ? hashDoTexto(*entrada) : hashDoTexto("")),
+      tamanhoDaEntrada(entrada != nullptr ? entrada->size() : 0) {
+    std::error_code erro;
+    std::filesystem::create_directories(diretorio, erro);
+    if (erro) {
+        throw std::runtime_error("Falha ao criar o diretório do cache: " + diretorio + ": " + erro.message());
+    }
+    caminhoDoResultado = (std::filesystem::path(diretorio)
+                          / (hexadecimal(hashDoFonte) + "-" + hexadecimal(hashDaEntrada) + "-" + versao + ".cache"))
+                             .string();
+}
+
+bool CacheDeExecucao::buscar(ResultadoGuardado& resultado) const {
+    std::FILE* arquivo = std::fopen(caminhoDoResultado.c_str(), "rb");
+    if (arquivo == nullptr) {
+        return false;
+    }
+    std::string dados;
+    char bloco[1 << 16];
+    for (size_t lidos; (lidos = std::fread(bloco, 1, sizeof(bloco), arquivo)) > 0;) {
+        dados.append(bloco, lidos);
+    }
+    std::fclose(arquivo);
+    if (dados.size() < sizeof(marca) || std::memcmp(dados.data(), marca, sizeof(marca)) != 0) {
+        return false;
+    }
+    dados.erase(0, sizeof(marca));
+
+    Leitura leitura(dados);
+    if (leitura.inteiro() != ordemDosBytes || leitura.texto() != versao || leitura.inteiro() != hashDoFonte
+        || leitura.inteiro() != tamanhoDoFonte || leitura.inteiro() != hashDaEntrada
+        || leitura.inteiro() != tamanhoDaEntrada) {
+        return false;
+    }
+    ResultadoGuardado lido;
+    lido.comandosExecutados = leitura.inteiro();
+    lido.saida = leitura.texto();
+    uint64_t numeroDesenhos = leitura.inteiro();
+    for (uint64_t k = 0; leitura.ok && k < numeroDesenhos; ++k) {
+        lido.desenhos.push_back(leitura.texto());
+    }
+    if (!leitura.ok || !leitura.fim()) {
+        return false;
+    }
+    resultado = std::move(lido);
+    return true;
+}
+
+void CacheDeExecucao::guardar(const ResultadoGuardado& resultado) const {
+    std::string dados(marca, sizeof(marca));
+    acrescentar(dados, ordemDosBytes);
+    acrescentar(dados, versao);
+    acrescentar(dados, hashDoFonte);
+    acrescentar(dados, tamanhoDoFonte);
+    acrescentar(dados, hashDaEntrada);
+    acrescentar(dados, tamanhoDaEntrada);
+    acrescentar(dados, resultado.comandosExecutados);
+    acrescentar(dados, resultado.saida);
+    acrescentar(dados, static_cast<uint64_t>(resultado.desenhos.size()));
+    for (const std::string& desenho : resultado.desenhos) {
+        acrescentar(dados, desenho);
+    }
+
+    // Um temporário por processo: duas execuções do mesmo programa podem guardar ao mesmo tempo
+#if defined(_WIN32)
+    std::string temporario = caminhoDoResultado + ".tmp";
+#else
+    std::string temporario = caminhoDoResultado + "." + std::to_string(getpid()) + ".tmp";
+#endif
+    std::FILE* arquivo = std::fopen(temporario.c_str(), "wb");
+    if (arquivo == nullptr) {
+        throw std::runtime_error("Falha ao gravar no cache: " + temporario + ": " + std::strerror(errno));
+    }
+    bool ok = std::fwrite(dados.data(), 1, dados.size(), arquivo) == dados.size();
+    ok = std::fclose(arquivo) == 0 && ok;
+    if (!ok || std::rename(temporario.c_str(), caminhoDoResultado.c_str()) != 0) {
+        int erro = errno;
+        std::remove(temporario.c_str());
+        throw std::runtime_error("Falha ao gravar no cache: " + caminhoDoResultado + ": " + std::strerror(erro));
+    }
+}
+
+bool CacheDeExecucao::deterministico(const NoDePrograma& programa, bool temEntrada) {
+    bool usaRnd = false;
+    std::function<void(NoDaASTPtr&)> procurarRnd = [&](NoDaASTPtr& expressao) {
+        auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao);
+        if (functionCall && functionCall->nomeDaFuncao == "RND") {
+            usaRnd = true;
+        }
+        Otimizador::paraCadaFilho(expressao, procurarRnd);
+    };
+    for (const auto& comando : programa.comandos) {
+        if (std::dynamic_pointer_cast<NoDoComandoLOAD>(comando) || std::dynamic_pointer_cast<NoDoComandoSAVE>(comando)
+            || std::dynamic_pointer_cast<NoDoComandoCHECKPOINT>(comando)) {
+            return false;
+        }
+        auto dimStmt = std::dynamic_pointer_cast<NoDoComandoDIM>(comando);
+        if (dimStmt && !dimStmt->arquivo.empty()) {
+            return false;
+        }
+        if (std::dynamic_pointer_cast<NoDoComandoINPUT>(comando) && !temEntrada) {
+            return false;
+        }
+        Otimizador::paraCadaExpressao(comando, procurarRnd);
+        if (usaRnd) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int SaidaCapturada::overflow(int c) {
+    if (c == traits_type::eof()) {
+        return traits_type::not_eof(c);
+    }
+    capturado += static_cast<char>(c);
+    return destino->sputc(static_cast<char>(c));
+}
+
+std::streamsize SaidaCapturada::xsputn(const char* dados, std::streamsize quantidade) {
+    capturado.append(dados, static_cast<size_t>(quantidade));
+    return destino->sputn(dados, quantidade);
+}
+
+int SaidaCapturada::sync() {
+    return destino->pubsync();
+}
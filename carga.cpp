@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Teste de carga do modo servidor (sibasic --serve): abre N sessões ao mesmo tempo, envia a
+// mesma linha de entrada para todas, lê a saída até o servidor fechar a conexão e mostra a
+// latência de cada sessão (da conexão ao fim da saída). As saídas devem ser todas iguais.
+
+namespace {
+    using Relogio = std::chrono::steady_clock;
+
+    struct Conexao {
+        int fd = -1;
+        Relogio::time_point inicio;
+        std::string saida;
+    };
+
+    int conectar(const std::string& caminho) {
+        sockaddr_un endereco{};
+        endereco.sun_family = AF_UNIX;
+        std::strncpy(endereco.sun_path, caminho.c_str(), sizeof(endereco.sun_path) - 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        // connect bloqueante: com a fila do listen cheia, espera o servidor aceitar
+        if (connect(fd, reinterpret_cast<sockaddr*>(&endereco), sizeof(endereco)) != 0) {
+            close(fd);
+            return -1;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return fd;
+    }
+
+    double milissegundos(Relogio::duration duracao) {
+        return std::chrono::duration<double, std::milli>(duracao).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " <socket> <sessões> [valores para o INPUT]" << std::endl;
+        return 1;
+    }
+    std::string caminho = argv[1];
+    int numeroSessoes = std::atoi(argv[2]);
+    std::string entrada;
+    for (int i = 3; i < argc; ++i) {
+        entrada += std::string(i > 3 ? " " : "") + argv[i];
+    }
+    entrada += "\n";
+    if (numeroSessoes <= 0) {
+        std::cerr << "Número de sessões inválido: " << argv[2] << std::endl;
+        return 1;
+    }
+
+    rlimit limite{};
+    if (getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < limite.rlim_max) {
+        limite.rlim_cur = limite.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limite);
+    }
+
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Conexao> conexoes(numeroSessoes);
+    int falhas = 0;
+    int abertas = 0;
+    auto inicio = Relogio::now();
+    for (int k = 0; k < numeroSessoes; ++k) {
+        Conexao& conexao = conexoes[k];
+        conexao.inicio = Relogio::now();
+        conexao.fd = conectar(caminho);
+        if (conexao.fd < 0) {
+            ++falhas;
+            continue;
+        }
+        // A entrada é pequena e cabe no buffer do socket; depois dela, fim da escrita
+        if (send(conexao.fd, entrada.data(), entrada.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(entrada.size())) {
+            close(conexao.fd);
+            conexao.fd = -1;
+            ++falhas;
+            continue;
+        }
+        shutdown(conexao.fd, SHUT_WR);
+        epoll_event evento{};
+        evento.events = EPOLLIN;
+        evento.data.u32 = static_cast<uint32_t>(k);
+        epoll_ctl(epoll, EPOLL_CTL_ADD, conexao.fd, &evento);
+        ++abertas;
+    }
+    int maximoAbertas = abertas;
+
+    std::vector<double> latencias;
+    std::vector<epoll_event> eventos(1024);
+    char bloco[4096];
+    while (abertas > 0) {
+        int n = epoll_wait(epoll, eventos.data(), static_cast<int>(eventos.size()), -1);
+        for (int e = 0; e < n; ++e) {
+            Conexao& conexao = conexoes[eventos[e].data.u32];
+            while (true) {
+                ssize_t lidos = read(conexao.fd, bloco, sizeof(bloco));
+                if (lidos > 0) {
+                    conexao.saida.append(bloco, static_cast<size_t>(lidos));
+                    continue;
+                }
+                if (lidos < 0 && (errno == EAGAIN || errno == EINTR)) {
+                    break;
+                }
+                if (lidos < 0) {
+                    ++falhas;
+                } else {
+                    latencias.push_back(milissegundos(Relogio::now() - conexao.inicio));
+                }
+                close(conexao.fd);
+                conexao.fd = -1;
+                --abertas;
+                break;
+            }
+        }
+    }
+    double total = milissegundos(Relogio::now() - inicio);
+
+    int divergentes = 0;
+    const std::string* referencia = nullptr;
+    for (const Conexao& conexao : conexoes) {
+        if (conexao.saida.empty()) {
+            continue;
+        }
+        if (referencia == nullptr) {
+            referencia = &conexao.saida;
+        } else if (conexao.saida != *referencia) {
+            ++divergentes;
+        }
+    }
+
+    std::sort(latencias.begin(), latencias.end());
+    auto percentil = [&latencias](double p) {
+        return latencias.empty() ? 0.0 : latencias[static_cast<size_t>(p * (latencias.size() - 1))];
+    };
+    std::cout << "Sessões: " << numeroSessoes << ", concluídas: " << latencias.size() << ", falhas: " << falhas
+              << ", saídas divergentes: " << divergentes << ", abertas ao mesmo tempo: " << maximoAbertas << std::endl;
+    std::cout << "Tempo total: " << total << " ms" << std::endl;
+    std::cout << "Latência (ms): p50 " << percentil(0.5) << ", p90 " << percentil(0.9) << ", p99 " << percentil(0.99)
+              << ", máxima " << percentil(1.0) << std::endl;
+    if (referencia != nullptr) {
+        std::cout << "Saída de uma sessão:" << std::endl << *referencia;
+    }
+    close(epoll);
+    return falhas == 0 && divergentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    const char marca[8] = {'S', 'I', 'B', 'C', 'K', 'P', 'T', '1'};
+    // Lida com outro valor, indica um arquivo gravado em máquina com outra ordem de bytes
+    constexpr uint64_t ordemDosBytes = 0x0102030405060708ULL;
+    // Vetores são copiados entre a memória e o arquivo em blocos grandes, sem conversão por elemento
+    constexpr uint64_t elementosPorBloco = (64u << 20) / 8;
+}
+
+GravadorDeCheckpoint::GravadorDeCheckpoint(const std::string& caminho)
+    : caminho(caminho), temporario(caminho + ".tmp") {
+    arquivo = std::fopen(temporario.c_str(), "wb");
+    if (arquivo == nullptr) {
+        throw std::runtime_error("Falha ao criar checkpoint: " + temporario + ": " + std::strerror(errno));
+    }
+    escrever(marca, sizeof(marca));
+    gravar(ordemDosBytes);
+}
+
+GravadorDeCheckpoint::~GravadorDeCheckpoint() {
+    if (arquivo != nullptr) {
+        // Não concluído (erro no meio): o checkpoint anterior continua valendo
+        std::fclose(arquivo);
+        std::remove(temporario.c_str());
+    }
+}
+
+void GravadorDeCheckpoint::escrever(const void* dados, size_t bytes) {
+    if (std::fwrite(dados, 1, bytes, arquivo) != bytes) {
+        throw std::runtime_error("Falha ao gravar checkpoint: " + temporario + ": " + std::strerror(errno));
+    }
+}
+
+void GravadorDeCheckpoint::gravar(uint64_t valor) {
+    escrever(&valor, sizeof(valor));
+}
+
+void GravadorDeCheckpoint::gravar(double valor) {
+    escrever(&valor, sizeof(valor));
+}
+
+void GravadorDeCheckpoint::gravar(const std::string& texto) {
+    gravar(static_cast<uint64_t>(texto.size()));
+    escrever(texto.data(), texto.size());
+}
+
+void GravadorDeCheckpoint::gravarBloco(const double* dados, uint64_t quantidade) {
+    gravarElementos(dados, quantidade);
+}
+
+void GravadorDeCheckpoint::gravarBloco(const uint64_t* dados, uint64_t quantidade) {
+    gravarElementos(dados, quantidade);
+}
+
+void GravadorDeCheckpoint::gravarElementos(const void* dados, uint64_t quantidade) {
+    gravar(quantidade);
+    const auto* bytes = static_cast<const char*>(dados);
+    for (uint64_t feitos = 0; feitos < quantidade; feitos += elementosPorBloco) {
+        uint64_t bloco = std::min(elementosPorBloco, quantidade - feitos);
+        escrever(bytes + feitos * 8, static_cast<size_t>(bloco) * 8);
+    }
+}
+
+void GravadorDeCheckpoint::concluir() {
+    bool ok = std::fflush(arquivo) == 0;
+#if !defined(_WIN32)
+    ok = ok && fsync(fileno(arquivo)) == 0;
+#endif
+    ok = std::fclose(arquivo) == 0 && ok;
+    arquivo = nullptr;
+    if (!ok || std::rename(temporario.c_str(), caminho.c_str()) != 0) {
+        int erro = errno;
+        std::remove(temporario.c_str());
+        throw std::runtime_error("Falha ao gravar checkpoint: " + caminho + ": " + std::strerror(erro));
+    }
+}
+
+LeitorDeCheckpoint::LeitorDeCheckpoint(const std::string& caminho) : caminho(caminho) {
+    arquivo = std::fopen(caminho.c_str(), "rb");
+    if (arquivo == nullptr) {
+        throw std::runtime_error("Falha ao abrir checkpoint: " + caminho + ": " + std::strerror(errno));
+    }
+    // O destrutor não roda se o construtor lançar
+    try {
+        char lida[sizeof(marca)];
+        ler(lida, sizeof(lida));
+        if (std::memcmp(lida, marca, sizeof(marca)) != 0) {
+            throw std::runtime_error("Arquivo não é um checkpoint do SiBasic: " + caminho);
+        }
+        if (lerInteiro() != ordemDosBytes) {
+            throw std::runtime_error("Checkpoint gravado em uma máquina com outra ordem de bytes: " + caminho);
+        }
+    } catch (...) {
+        std::fclose(arquivo);
+        throw;
+    }
+}
+
+LeitorDeCheckpoint::~LeitorDeCheckpoint() {
+    std::fclose(arquivo);
+}
+
+void LeitorDeCheckpoint::ler(void* dados, size_t bytes) {
+    if (std::fread(dados, 1, bytes, arquivo) != bytes) {
+        throw std::runtime_error("Checkpoint incompleto ou corrompido: " + caminho);
+    }
+}
+
+uint64_t LeitorDeCheckpoint::lerInteiro() {
+    uint64_t valor;
+    ler(&valor, sizeof(valor));
+    return valor;
+}
+
+double LeitorDeCheckpoint::lerReal() {
+    double valor;
+    ler(&valor, sizeof(valor));
+    return valor;
+}
+
+std::string LeitorDeCheckpoint::lerTexto() {
+    uint64_t tamanho = lerInteiro();
+    // Um tamanho absurdo vem de arquivo corrompido: evita alocar antes de falhar na leitura
+    if (tamanho > (1u << 30)) {
+        throw std::runtime_error("Checkpoint incompleto ou corrompido: " + caminho);
+    }
+    std::string texto(tamanho, '\0');
+    ler(texto.data(), texto.size());
+    return texto;
+}
+
+void LeitorDeCheckpoint::lerBloco(double* dados, uint64_t quantidade) {
+    lerElementos(dados, quantidade);
+}
+
+void LeitorDeCheckpoint::lerBloco(uint64_t* dados, uint64_t quantidade) {
+    lerElementos(dados, quantidade);
+}
+
+void LeitorDeCheckpoint::lerElementos(void* dados, uint64_t quantidade) {
+    if (lerInteiro() != quantidade) {
+        throw std::runtime_error("Checkpoint incompleto ou corrompido: " + caminho);
+    }
+    auto* bytes = static_cast<char*>(dados);
+    for (uint64_t feitos = 0; feitos < quantidade; feitos += elementosPorBloco) {
+        uint64_t bloco = std::min(elementosPorBloco, quantidade - feitos);
+        ler(bytes + feitos * 8, static_cast<size_t>(bloco) * 8);
+    }
+}
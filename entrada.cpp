@@ -0,0 +1,154 @@
+#include "Entrada.h"
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    bool ehSeparador(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',' || c == ';';
+    }
+
+    // Converte o texto inteiro em um double. Retorna false se sobrar algum caractere.
+    bool converterNumero(const char* inicio, const char* fim, double& valor) {
+        if (inicio < fim && *inicio == '+') {
+            // from_chars não aceita o sinal positivo
+            inicio++;
+        }
+        auto [ptr, ec] = std::from_chars(inicio, fim, valor);
+        return ec == std::errc() && ptr == fim;
+    }
+}
+
+double EntradaConsole::lerValor() {
+    std::string digitado;
+    std::cout << "# ";
+    if (!(std::cin >> digitado)) {
+        throw std::runtime_error("INPUT: fim da entrada padrão");
+    }
+    double valor;
+    if (!converterNumero(digitado.data(), digitado.data() + digitado.size(), valor)) {
+        throw std::runtime_error("INPUT: valor inválido: \"" + digitado + "\"");
+    }
+    return valor;
+}
+
+EntradaArquivo::EntradaArquivo(const std::string& nomeArquivo) : nomeArquivo(nomeArquivo), pos(0), linha(1) {
+    bool entradaPadrao = nomeArquivo == "-";
+    std::FILE* arquivo = entradaPadrao ? stdin : std::fopen(nomeArquivo.c_str(), "rb");
+    if (arquivo == nullptr) {
+        throw std::runtime_error("Falha ao abrir arquivo de entrada: " + nomeArquivo);
+    }
+    // Lê tudo em blocos grandes; para arquivos regulares o tamanho é conhecido e basta uma leitura
+    if (!entradaPadrao && std::fseek(arquivo, 0, SEEK_END) == 0) {
+        long tamanho = std::ftell(arquivo);
+        std::fseek(arquivo, 0, SEEK_SET);
+        if (tamanho > 0) {
+            dados.resize(static_cast<size_t>(tamanho));
+            dados.resize(std::fread(dados.data(), 1, dados.size(), arquivo));
+        }
+    }
+    char bloco[1 << 16];
+    size_t lidos;
+    while ((lidos = std::fread(bloco, 1, sizeof(bloco), arquivo)) > 0) {
+        dados.append(bloco, lidos);
+    }
+    if (!entradaPadrao) {
+        std::fclose(arquivo);
+    }
+    if (entradaPadrao) {
+        this->nomeArquivo = "<stdin>";
+    }
+}
+
+double EntradaArquivo::lerValor() {
+    while (pos < dados.size() && ehSeparador(dados[pos])) {
+        if (dados[pos] == '\n') {
+            linha++;
+        }
+        pos++;
+    }
+    if (pos >= dados.size()) {
+        std::ostringstream oss;
+        oss << nomeArquivo << ":" << linha << ": INPUT sem valor, fim dos dados de entrada";
+        throw std::runtime_error(oss.str());
+    }
+    size_t inicio = pos;
+    while (pos < dados.size() && !ehSeparador(dados[pos])) {
+        pos++;
+    }
+    double valor;
+    if (!converterNumero(dados.data() + inicio, dados.data() + pos, valor)) {
+        std::ostringstream oss;
+        oss << nomeArquivo << ":" << linha << ": valor inválido: \"" << dados.substr(inicio, pos - inicio) << "\"";
+        throw std::runtime_error(oss.str());
+    }
+    return valor;
+}
+
+EntradaLista::EntradaLista(std::vector<double> valores) : valores(std::move(valores)), proximo(0) {}
+
+double EntradaLista::lerValor() {
+    if (proximo >= valores.size()) {
+        throw std::runtime_error("INPUT sem valor correspondente na linha de entrada");
+    }
+    return valores[proximo++];
+}
+
+size_t EntradaLista::restantes() const {
+    return valores.size() - proximo;
+}
+
+void EntradaFila::fornecer(double valor) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        valores.push_back(valor);
+    }
+    chegou.notify_all();
+}
+
+void EntradaFila::encerrar() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        encerrada = true;
+    }
+    chegou.notify_all();
+}
+
+double EntradaFila::lerValor() {
+    std::unique_lock<std::mutex> lock(mutex);
+    chegou.wait(lock, [this] { return !valores.empty() || encerrada; });
+    if (valores.empty()) {
+        throw std::runtime_error("INPUT sem valor, a entrada foi encerrada");
+    }
+    double valor = valores.front();
+    valores.pop_front();
+    return valor;
+}
+
+bool EntradaFila::pronta() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !valores.empty() || encerrada;
+}
+
+void EntradaFila::esperar() {
+    std::unique_lock<std::mutex> lock(mutex);
+    chegou.wait(lock, [this] { return !valores.empty() || encerrada; });
+}
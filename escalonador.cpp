@@ -0,0 +1,152 @@
+#include "Escalonador.h"
+#include <algorithm>
+#include <stdexcept>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+Escalonador::Escalonador(unsigned numeroThreads, uint64_t orcamento, std::chrono::microseconds fatia)
+    : orcamento(orcamento), fatia(fatia) {
+    if (numeroThreads == 0) {
+        numeroThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned t = 0; t < numeroThreads; ++t) {
+        threads.emplace_back(&Escalonador::trabalhar, this);
+    }
+}
+
+Escalonador::~Escalonador() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        parar = true;
+    }
+    temTrabalho.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t Escalonador::adicionar(const std::string& basicScriptName, const std::shared_ptr<NoDePrograma>& programa) {
+    auto tarefa = std::make_unique<Tarefa>();
+    tarefa->entrada = std::make_shared<EntradaFila>();
+    tarefa->interpreter = std::make_unique<Interpreter>(basicScriptName, tarefa->saida, tarefa->entrada);
+    // As tarefas já dividem as threads: um PARALLEL FOR roda na thread da tarefa
+    tarefa->interpreter->definirThreadsParalelas(1);
+    tarefa->interpreter->iniciar(programa);
+    size_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = tarefas.size();
+        tarefas.push_back(std::move(tarefa));
+        fila.push_back(id);
+        ++ativas;
+    }
+    temTrabalho.notify_one();
+    return id;
+}
+
+void Escalonador::fornecerEntrada(size_t id, double valor) {
+    EntradaFila* entrada;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entrada = tarefas.at(id)->entrada.get();
+    }
+    // O valor entra na fila antes de acordar: quem parou no INPUT confere a fila sob o mutex
+    entrada->fornecer(valor);
+    acordar(id);
+}
+
+void Escalonador::encerrarEntrada(size_t id) {
+    EntradaFila* entrada;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entrada = tarefas.at(id)->entrada.get();
+    }
+    entrada->encerrar();
+    acordar(id);
+}
+
+void Escalonador::acordar(size_t id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Tarefa& tarefa = *tarefas[id];
+        if (!tarefa.aguardandoEntrada) {
+            return;
+        }
+        tarefa.aguardandoEntrada = false;
+        fila.push_back(id);
+    }
+    temTrabalho.notify_one();
+}
+
+void Escalonador::aguardar() {
+    std::unique_lock<std::mutex> lock(mutex);
+    terminaram.wait(lock, [this] { return ativas == 0; });
+}
+
+Escalonador::Resultado Escalonador::resultado(size_t id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tarefas.at(id)->resultado;
+}
+
+void Escalonador::trabalhar() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        temTrabalho.wait(lock, [this] { return parar || !fila.empty(); });
+        if (parar) {
+            return;
+        }
+        size_t id = fila.front();
+        fila.pop_front();
+        Tarefa& tarefa = *tarefas[id];
+        lock.unlock();
+
+        // A fatia roda sem o mutex: só esta thread mexe no Interpreter da tarefa agora
+        Interpreter::Situacao situacao;
+        std::string erro;
+        try {
+            situacao = tarefa.interpreter->passo(orcamento, std::chrono::steady_clock::now() + fatia);
+        } catch (const std::exception& e) {
+            situacao = Interpreter::Situacao::TERMINOU;
+            erro = e.what();
+        }
+        std::string produzido = tarefa.saida.str();
+        tarefa.saida.str("");
+
+        lock.lock();
+        tarefa.resultado.saida += produzido;
+        tarefa.resultado.comandos = tarefa.interpreter->comandosExecutados();
+        if (situacao == Interpreter::Situacao::CEDEU) {
+            // Fim da fila: os outros programas prontos rodam antes deste de novo
+            fila.push_back(id);
+        } else if (situacao == Interpreter::Situacao::AGUARDANDO_ENTRADA) {
+            // O valor pode ter chegado durante a fatia, antes de aguardandoEntrada ser marcado
+            if (tarefa.entrada->pronta()) {
+                fila.push_back(id);
+            } else {
+                tarefa.aguardandoEntrada = true;
+            }
+        } else {
+            tarefa.resultado.terminou = true;
+            tarefa.resultado.erro = erro;
+            // O programa não roda mais: variáveis e vetores são liberados já
+            tarefa.interpreter.reset();
+            if (--ativas == 0) {
+                terminaram.notify_all();
+            }
+        }
+    }
+}
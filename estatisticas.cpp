@@ -0,0 +1,173 @@
+#include "Estatisticas.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    // Inicializados como constantes, antes de qualquer construtor estático que aloque
+    std::atomic<bool> contandoAlocacoes{false};
+    std::atomic<uint64_t> alocacoes{0};
+    std::atomic<uint64_t> bytesAlocados{0};
+
+    const char* const nomesDasFases[] = {"leitura", "lexer", "parser", "resolvedor", "otimizador", "execucao", "svg"};
+
+    double segundosDeCpu() {
+        return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+    }
+
+    // Maior RSS do processo até agora, em KiB (0 onde não há getrusage)
+    uint64_t picoDeRss() {
+#if !defined(_WIN32)
+        rusage uso{};
+        if (getrusage(RUSAGE_SELF, &uso) == 0) {
+#if defined(__APPLE__)
+            return static_cast<uint64_t>(uso.ru_maxrss) / 1024;
+#else
+            return static_cast<uint64_t>(uso.ru_maxrss);
+#endif
+        }
+#endif
+        return 0;
+    }
+}
+
+// Substitui o operator new do programa para contar as alocações. Fora do --stats o custo é
+// uma leitura relaxada por alocação. new[] e as versões nothrow usam este por padrão.
+void* operator new(std::size_t tamanho) {
+    if (contandoAlocacoes.load(std::memory_order_relaxed)) {
+        alocacoes.fetch_add(1, std::memory_order_relaxed);
+        bytesAlocados.fetch_add(tamanho, std::memory_order_relaxed);
+    }
+    if (tamanho == 0) {
+        tamanho = 1;
+    }
+    while (true) {
+        if (void* memoria = std::malloc(tamanho)) {
+            return memoria;
+        }
+        std::new_handler tratador = std::get_new_handler();
+        if (tratador == nullptr) {
+            throw std::bad_alloc();
+        }
+        tratador();
+    }
+}
+
+void operator delete(void* memoria) noexcept {
+    std::free(memoria);
+}
+
+void operator delete(void* memoria, std::size_t) noexcept {
+    std::free(memoria);
+}
+
+Estatisticas::Estatisticas() {
+    contandoAlocacoes.store(true, std::memory_order_relaxed);
+}
+
+Estatisticas::~Estatisticas() {
+    contandoAlocacoes.store(false, std::memory_order_relaxed);
+}
+
+Estatisticas::Fase Estatisticas::trocar(Fase nova) {
+    auto agora = std::chrono::steady_clock::now();
+    double cpu = segundosDeCpu();
+    uint64_t totalAlocacoes = alocacoes.load(std::memory_order_relaxed);
+    uint64_t totalBytes = bytesAlocados.load(std::memory_order_relaxed);
+    if (ativa != NENHUMA) {
+        Medida& medida = medidas[ativa];
+        medida.relogio += std::chrono::duration<double>(agora - inicioRelogio).count();
+        medida.cpu += cpu - inicioCpu;
+        medida.alocacoes += totalAlocacoes - inicioAlocacoes;
+        medida.bytes += totalBytes - inicioBytes;
+        uint64_t rss = picoDeRss();
+        if (rss > medida.picoRss) {
+            medida.picoRss = rss;
+        }
+        medida.usada = true;
+    }
+    Fase anterior = ativa;
+    ativa = nova;
+    inicioRelogio = agora;
+    inicioCpu = cpu;
+    inicioAlocacoes = totalAlocacoes;
+    inicioBytes = totalBytes;
+    return anterior;
+}
+
+Estatisticas::Medida Estatisticas::total() const {
+    Medida soma;
+    for (const Medida& medida : medidas) {
+        soma.relogio += medida.relogio;
+        soma.cpu += medida.cpu;
+        soma.alocacoes += medida.alocacoes;
+        soma.bytes += medida.bytes;
+    }
+    soma.picoRss = picoDeRss();
+    soma.usada = true;
+    return soma;
+}
+
+void Estatisticas::mostrar(std::ostream& saida) const {
+    char linha[160];
+    std::snprintf(linha, sizeof(linha), "%-12s %13s %12s %14s %14s %14s", "fase", "relógio (ms)", "CPU (ms)",
+                  "alocações", "bytes", "pico RSS (KiB)");
+    saida << linha << std::endl;
+    auto mostrarMedida = [&saida, &linha](const char* nome, const Medida& medida) {
+        std::snprintf(linha, sizeof(linha), "%-12s %12.3f %12.3f %12llu %14llu %14llu", nome, medida.relogio * 1000.0,
+                      medida.cpu * 1000.0, static_cast<unsigned long long>(medida.alocacoes),
+                      static_cast<unsigned long long>(medida.bytes), static_cast<unsigned long long>(medida.picoRss));
+        saida << linha << std::endl;
+    };
+    for (int fase = 0; fase < NENHUMA; ++fase) {
+        if (medidas[fase].usada) {
+            mostrarMedida(nomesDasFases[fase], medidas[fase]);
+        }
+    }
+    mostrarMedida("total", total());
+    saida << "tokens: " << tokens << ", nós da AST: " << nosDaAST << ", comandos executados: " << comandosExecutados
+          << std::endl;
+}
+
+void Estatisticas::mostrarJson(std::ostream& saida) const {
+    auto mostrarMedida = [&saida](const Medida& medida) {
+        char texto[200];
+        std::snprintf(texto, sizeof(texto),
+                      "{\"relogio_ms\":%.3f,\"cpu_ms\":%.3f,\"alocacoes\":%llu,\"bytes\":%llu,\"pico_rss_kib\":%llu}",
+                      medida.relogio * 1000.0, medida.cpu * 1000.0, static_cast<unsigned long long>(medida.alocacoes),
+                      static_cast<unsigned long long>(medida.bytes), static_cast<unsigned long long>(medida.picoRss));
+        saida << texto;
+    };
+    // Todas as fases aparecem, mesmo as não executadas, para que o formato seja sempre o mesmo
+    saida << "{\"fases\":{";
+    for (int fase = 0; fase < NENHUMA; ++fase) {
+        saida << (fase > 0 ? "," : "") << "\"" << nomesDasFases[fase] << "\":";
+        mostrarMedida(medidas[fase]);
+    }
+    saida << "},\"total\":";
+    mostrarMedida(total());
+    saida << ",\"tokens\":" << tokens << ",\"nos_ast\":" << nosDaAST << ",\"comandos_executados\":" << comandosExecutados
+          << "}" << std::endl;
+}
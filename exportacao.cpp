@@ -0,0 +1,288 @@
+#include "Exportacao.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    // Elementos entregues de cada vez pelo LeitorEmBlocos (512 KiB)
+    constexpr size_t elementosPorBloco = 64u << 10;
+    // Texto do CSV acumulado antes de cada fwrite
+    constexpr size_t tamanhoDoBuffer = 1u << 20;
+    // Maior texto de um double com to_chars, mais o separador
+    constexpr size_t maiorNumero = 32;
+
+    bool terminaCom(const std::string& texto, const std::string& final) {
+        return texto.size() >= final.size() && texto.compare(texto.size() - final.size(), final.size(), final) == 0;
+    }
+
+    // Percorre os elementos de um vetor em ordem, em blocos contíguos. Um vetor denso é
+    // entregue direto da memória; um esparso é montado bloco a bloco a partir dos elementos
+    // gravados, ordenados por posição; um de tipo compacto é convertido bloco a bloco.
+    class LeitorEmBlocos {
+    public:
+        explicit LeitorEmBlocos(const Vetor& vetor) : vetor(vetor) {
+            if (vetor.palavras() != nullptr) {
+                bloco.resize(elementosPorBloco);
+            } else if (vetor.esparso()) {
+                vetor.paraCadaGravado([this](uint64_t posicao, double valor) {
+                    gravados.emplace_back(posicao, valor);
+                });
+                std::sort(gravados.begin(), gravados.end());
+                bloco.resize(elementosPorBloco);
+            }
+        }
+
+        // Próximo bloco; retorna o número de elementos nele, 0 no fim
+        size_t proximo(const double*& dados) {
+            size_t quantos = static_cast<size_t>(std::min<uint64_t>(elementosPorBloco, vetor.tamanho() - posicao));
+            if (quantos == 0) {
+                return 0;
+            }
+            if (vetor.palavras() != nullptr) {
+                vetor.lerBloco(posicao, quantos, bloco.data());
+                dados = bloco.data();
+            } else if (!vetor.esparso()) {
+                dados = vetor.dados() + posicao;
+            } else {
+                std::fill(bloco.begin(), bloco.begin() + quantos, 0.0);
+                for (; proximoGravado < gravados.size() && gravados[proximoGravado].first < posicao + quantos;
+                     ++proximoGravado) {
+                    bloco[gravados[proximoGravado].first - posicao] = gravados[proximoGravado].second;
+                }
+                dados = bloco.data();
+            }
+            posicao += quantos;
+            return quantos;
+        }
+
+    private:
+        const Vetor& vetor;
+        uint64_t posicao = 0;
+        std::vector<std::pair<uint64_t, double>> gravados;
+        size_t proximoGravado = 0;
+        std::vector<double> bloco;
+    };
+
+    // Arquivo gravado em "<caminho>.tmp" e renomeado em concluir(), como no checkpoint
+    class ArquivoDeSaida {
+    public:
+        explicit ArquivoDeSaida(const std::string& caminho) : caminho(caminho), temporario(caminho + ".tmp") {
+            arquivo = std::fopen(temporario.c_str(), "wb");
+            if (arquivo == nullptr) {
+                throw std::runtime_error("Falha ao criar arquivo: " + temporario + ": " + std::strerror(errno));
+            }
+        }
+
+        ~ArquivoDeSaida() {
+            if (arquivo != nullptr) {
+                std::fclose(arquivo);
+                std::remove(temporario.c_str());
+            }
+        }
+
+        ArquivoDeSaida(const ArquivoDeSaida&) = delete;
+        ArquivoDeSaida& operator=(const ArquivoDeSaida&) = delete;
+
+        void escrever(const void* dados, size_t bytes) {
+            if (std::fwrite(dados, 1, bytes, arquivo) != bytes) {
+                throw std::runtime_error("Falha ao gravar arquivo: " + temporario + ": " + std::strerror(errno));
+            }
+        }
+
+        void concluir() {
+            bool ok = std::fclose(arquivo) == 0;
+            arquivo = nullptr;
+            if (!ok || std::rename(temporario.c_str(), caminho.c_str()) != 0) {
+                int erro = errno;
+                std::remove(temporario.c_str());
+                throw std::runtime_error("Falha ao gravar arquivo: " + caminho + ": " + std::strerror(erro));
+            }
+        }
+
+    private:
+        std::string caminho;
+        std::string temporario;
+        std::FILE* arquivo;
+    };
+
+    void gravarF64(ArquivoDeSaida& arquivo, const Vetor& vetor) {
+        arquivo.escrever(Vetor::marcaF64, sizeof(Vetor::marcaF64));
+        uint64_t cabecalho[2] = {Vetor::ordemDosBytesF64, static_cast<uint64_t>(vetor.dimensoes().size())};
+        arquivo.escrever(cabecalho, sizeof(cabecalho));
+        arquivo.escrever(vetor.dimensoes().data(), vetor.dimensoes().size() * sizeof(uint64_t));
+        LeitorEmBlocos leitor(vetor);
+        const double* dados;
+        for (size_t quantos; (quantos = leitor.proximo(dados)) > 0;) {
+            arquivo.escrever(dados, quantos * sizeof(double));
+        }
+    }
+
+    void gravarCsv(ArquivoDeSaida& arquivo, const std::vector<std::shared_ptr<const Vetor>>& vetores) {
+        std::vector<char> buffer(tamanhoDoBuffer);
+        char* fimDoBuffer = buffer.data() + buffer.size();
+        char* p = buffer.data();
+        auto escreverNumero = [&](double valor, char separador) {
+            if (fimDoBuffer - p < static_cast<std::ptrdiff_t>(maiorNumero)) {
+                arquivo.escrever(buffer.data(), static_cast<size_t>(p - buffer.data()));
+                p = buffer.data();
+            }
+            p = std::to_chars(p, fimDoBuffer, valor).ptr;
+            *p++ = separador;
+        };
+
+        // Com um só vetor de várias dimensões, o último índice varia ao longo da linha
+        const Vetor& primeiro = *vetores[0];
+        uint64_t colunas = vetores.size() == 1 && primeiro.dimensoes().size() > 1 ? primeiro.dimensoes().back() : 1;
+        std::vector<LeitorEmBlocos> leitores;
+        leitores.reserve(vetores.size());
+        for (const auto& vetor : vetores) {
+            leitores.emplace_back(*vetor);
+        }
+        std::vector<const double*> blocos(vetores.size());
+        uint64_t coluna = 0;
+        while (true) {
+            // Os vetores têm o mesmo tamanho: os blocos andam juntos
+            size_t quantos = 0;
+            for (size_t k = 0; k < leitores.size(); ++k) {
+                quantos = leitores[k].proximo(blocos[k]);
+            }
+            if (quantos == 0) {
+                break;
+            }
+            for (size_t i = 0; i < quantos; ++i) {
+                if (blocos.size() == 1) {
+                    bool fimDaLinha = ++coluna == colunas;
+                    escreverNumero(blocos[0][i], fimDaLinha ? '\n' : ',');
+                    if (fimDaLinha) {
+                        coluna = 0;
+                    }
+                    continue;
+                }
+                for (size_t k = 0; k < blocos.size(); ++k) {
+                    escreverNumero(blocos[k][i], k + 1 == blocos.size() ? '\n' : ',');
+                }
+            }
+        }
+        arquivo.escrever(buffer.data(), static_cast<size_t>(p - buffer.data()));
+    }
+}
+
+void verificarGravacao(const std::string& caminho, const std::vector<std::shared_ptr<const Vetor>>& vetores) {
+    if (terminaCom(caminho, ".f64")) {
+        if (vetores.size() != 1) {
+            throw std::runtime_error("Arquivo .f64 recebe um só vetor: " + caminho);
+        }
+        return;
+    }
+    for (const auto& vetor : vetores) {
+        if (vetor->tamanho() != vetores[0]->tamanho()) {
+            throw std::runtime_error("Vetores de tamanhos diferentes no mesmo CSV: " + caminho);
+        }
+    }
+}
+
+void gravarVetores(const std::string& caminho, const std::vector<std::shared_ptr<const Vetor>>& vetores) {
+    verificarGravacao(caminho, vetores);
+    ArquivoDeSaida arquivo(caminho);
+    if (terminaCom(caminho, ".f64")) {
+        gravarF64(arquivo, *vetores[0]);
+    } else {
+        gravarCsv(arquivo, vetores);
+    }
+    arquivo.concluir();
+}
+
+std::shared_ptr<const Vetor> copiarVetor(const Vetor& vetor) {
+    if (vetor.palavras() != nullptr) {
+        auto copia = std::make_shared<Vetor>(vetor.dimensoes(), vetor.tipo());
+        std::copy(vetor.palavras(), vetor.palavras() + vetor.numeroPalavras(), copia->palavras());
+        return copia;
+    }
+    if (vetor.esparso()) {
+        auto copia = std::make_shared<Vetor>(vetor.dimensoes());
+        vetor.paraCadaGravado([&copia](uint64_t posicao, double valor) {
+            copia->escrever(posicao, valor);
+        });
+        return copia;
+    }
+    return std::make_shared<Vetor>(std::vector<double>(vetor.dados(), vetor.dados() + vetor.tamanho()),
+                                   vetor.dimensoes());
+}
+
+GravadorEmSegundoPlano::~GravadorEmSegundoPlano() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            parar = true;
+        }
+        mudou.notify_all();
+        thread.join();
+    }
+}
+
+void GravadorEmSegundoPlano::enfileirar(std::function<void()> gravacao) {
+    std::unique_lock<std::mutex> trava(mutex);
+    if (!thread.joinable()) {
+        thread = std::thread(&GravadorEmSegundoPlano::executar, this);
+    }
+    mudou.wait(trava, [this] { return fila.size() < maximoPendentes; });
+    fila.push_back(std::move(gravacao));
+    mudou.notify_all();
+}
+
+void GravadorEmSegundoPlano::concluir() {
+    std::unique_lock<std::mutex> trava(mutex);
+    mudou.wait(trava, [this] { return fila.empty() && !gravando; });
+    if (!erro.empty()) {
+        std::string mensagem = std::move(erro);
+        erro.clear();
+        throw std::runtime_error(mensagem);
+    }
+}
+
+void GravadorEmSegundoPlano::executar() {
+    std::unique_lock<std::mutex> trava(mutex);
+    while (true) {
+        mudou.wait(trava, [this] { return parar || !fila.empty(); });
+        if (fila.empty()) {
+            return;
+        }
+        std::function<void()> gravacao = std::move(fila.front());
+        fila.pop_front();
+        gravando = true;
+        mudou.notify_all();
+        trava.unlock();
+        std::string falha;
+        try {
+            gravacao();
+        } catch (const std::exception& e) {
+            falha = e.what();
+        }
+        trava.lock();
+        gravando = false;
+        if (erro.empty()) {
+            erro = std::move(falha);
+        }
+        mudou.notify_all();
+    }
+}
@@ -0,0 +1,277 @@
+#include "Importacao.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    // Cada thread lê pelo menos 4 MiB: em arquivos menores, criar threads custa mais que ler
+    constexpr size_t bytesPorBloco = 4u << 20;
+
+    // Texto do arquivo inteiro, mapeado só para leitura (ou lido para a memória no Windows)
+    class Texto {
+    public:
+        explicit Texto(const std::string& caminho) {
+#if defined(_WIN32)
+            std::FILE* arquivo = std::fopen(caminho.c_str(), "rb");
+            if (arquivo == nullptr) {
+                throw std::runtime_error("Falha ao abrir arquivo de dados: " + caminho + ": " + std::strerror(errno));
+            }
+            char bloco[1 << 16];
+            for (size_t lidos; (lidos = std::fread(bloco, 1, sizeof(bloco), arquivo)) > 0;) {
+                copia.append(bloco, lidos);
+            }
+            std::fclose(arquivo);
+            inicio = copia.data();
+            tamanho = copia.size();
+#else
+            int fd = open(caminho.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Falha ao abrir arquivo de dados: " + caminho + ": " + std::strerror(errno));
+            }
+            struct stat info{};
+            if (fstat(fd, &info) != 0) {
+                int erro = errno;
+                close(fd);
+                throw std::runtime_error("Falha ao ler arquivo de dados: " + caminho + ": " + std::strerror(erro));
+            }
+            tamanho = static_cast<size_t>(info.st_size);
+            if (tamanho > 0) {
+                mapa = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+                int erro = errno;
+                if (mapa == MAP_FAILED) {
+                    close(fd);
+                    throw std::runtime_error("Falha ao mapear arquivo de dados: " + caminho + ": " + std::strerror(erro));
+                }
+                madvise(mapa, tamanho, MADV_SEQUENTIAL);
+                inicio = static_cast<const char*>(mapa);
+            }
+            close(fd);
+#endif
+        }
+
+        ~Texto() {
+#if !defined(_WIN32)
+            if (mapa != nullptr) {
+                munmap(mapa, tamanho);
+            }
+#endif
+        }
+
+        Texto(const Texto&) = delete;
+        Texto& operator=(const Texto&) = delete;
+
+        const char* inicio = "";
+        size_t tamanho = 0;
+
+    private:
+        void* mapa = nullptr;
+        std::string copia;
+    };
+
+    // Valores de um bloco de linhas e, se houve erro, a linha e o motivo
+    struct Bloco {
+        std::vector<double> valores;
+        const char* linhaComErro = nullptr;
+        std::string motivo;
+    };
+
+    const char* pularEspacos(const char* p, const char* fim) {
+        while (p < fim && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+        return p;
+    }
+
+    // Campo numérico terminado por ',' ou pelo fim da linha; p fica na vírgula ou no fim
+    bool lerCampo(const char*& p, const char* fim, double& valor) {
+        p = pularEspacos(p, fim);
+        // from_chars não aceita o sinal de +
+        if (p < fim && *p == '+') {
+            ++p;
+        }
+        auto [final, erro] = std::from_chars(p, fim, valor);
+        if (erro != std::errc()) {
+            return false;
+        }
+        p = pularEspacos(final, fim);
+        return p == fim || *p == ',';
+    }
+
+    // Lê uma linha sem o fim de linha. Retorna false com o motivo em caso de erro.
+    bool lerLinha(const char* p, const char* fim, unsigned coluna, std::vector<double>& valores, std::string& motivo) {
+        double valor;
+        if (coluna == 0) {
+            while (true) {
+                if (!lerCampo(p, fim, valor)) {
+                    motivo = "valor inválido";
+                    return false;
+                }
+                valores.push_back(valor);
+                if (p == fim) {
+                    return true;
+                }
+                ++p;
+            }
+        }
+        for (unsigned campo = 1; campo < coluna; ++campo) {
+            p = static_cast<const char*>(std::memchr(p, ',', static_cast<size_t>(fim - p)));
+            if (p == nullptr) {
+                motivo = "não tem a coluna " + std::to_string(coluna);
+                return false;
+            }
+            ++p;
+        }
+        if (!lerCampo(p, fim, valor)) {
+            motivo = "valor inválido na coluna " + std::to_string(coluna);
+            return false;
+        }
+        valores.push_back(valor);
+        return true;
+    }
+
+    void lerBloco(const char* p, const char* fim, const char* inicioDoArquivo, unsigned coluna, Bloco& bloco) {
+        // Estimativa de um valor a cada 8 bytes: evita a maior parte das realocações
+        bloco.valores.reserve(static_cast<size_t>(fim - p) / (coluna == 0 ? 8 : 16));
+        while (p < fim) {
+            auto* quebra = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(fim - p)));
+            const char* fimDaLinha = quebra != nullptr ? quebra : fim;
+            const char* proxima = quebra != nullptr ? quebra + 1 : fim;
+            const char* ultimo = fimDaLinha;
+            if (ultimo > p && ultimo[-1] == '\r') {
+                --ultimo;
+            }
+            if (pularEspacos(p, ultimo) == ultimo) {
+                p = proxima;
+                continue;
+            }
+            size_t antes = bloco.valores.size();
+            if (!lerLinha(p, ultimo, coluna, bloco.valores, bloco.motivo)) {
+                if (p == inicioDoArquivo) {
+                    // Cabeçalho: a primeira linha não é numérica
+                    bloco.valores.resize(antes);
+                    bloco.motivo.clear();
+                    p = proxima;
+                    continue;
+                }
+                bloco.linhaComErro = p;
+                return;
+            }
+            p = proxima;
+        }
+    }
+
+    bool terminaCom(const std::string& texto, const std::string& final) {
+        return texto.size() >= final.size() && texto.compare(texto.size() - final.size(), final.size(), final) == 0;
+    }
+}
+
+std::vector<double> lerCsv(const std::string& caminho, unsigned coluna) {
+    Texto texto(caminho);
+    const char* inicio = texto.inicio;
+    const char* fim = inicio + texto.tamanho;
+
+    size_t numeroBlocos = std::max<size_t>(1, texto.tamanho / bytesPorBloco);
+    numeroBlocos = std::min<size_t>(numeroBlocos, std::max(1u, std::thread::hardware_concurrency()));
+    // Cada bloco começa no início de uma linha
+    std::vector<const char*> limites(numeroBlocos + 1, fim);
+    limites[0] = inicio;
+    for (size_t k = 1; k < numeroBlocos; ++k) {
+        const char* p = std::max(limites[k - 1], inicio + texto.tamanho / numeroBlocos * k);
+        auto* quebra = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(fim - p)));
+        limites[k] = quebra != nullptr ? quebra + 1 : fim;
+    }
+
+    std::vector<Bloco> blocos(numeroBlocos);
+    std::vector<std::thread> threads;
+    for (size_t k = 1; k < numeroBlocos; ++k) {
+        threads.emplace_back(lerBloco, limites[k], limites[k + 1], inicio, coluna, std::ref(blocos[k]));
+    }
+    lerBloco(limites[0], limites[1], inicio, coluna, blocos[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t total = 0;
+    for (const Bloco& bloco : blocos) {
+        if (bloco.linhaComErro != nullptr) {
+            size_t linha = 1 + static_cast<size_t>(std::count(inicio, bloco.linhaComErro, '\n'));
+            throw std::runtime_error("Arquivo " + caminho + ", linha " + std::to_string(linha) + ": " + bloco.motivo);
+        }
+        total += bloco.valores.size();
+    }
+    std::vector<double> valores = std::move(blocos[0].valores);
+    valores.reserve(total);
+    for (size_t k = 1; k < numeroBlocos; ++k) {
+        valores.insert(valores.end(), blocos[k].valores.begin(), blocos[k].valores.end());
+        std::vector<double>().swap(blocos[k].valores);
+    }
+    return valores;
+}
+
+std::shared_ptr<Vetor> carregarVetor(const std::string& caminho, unsigned coluna, const std::shared_ptr<Vetor>& destino) {
+    std::vector<uint64_t> dimensoes = destino ? destino->dimensoes() : std::vector<uint64_t>{};
+    if (terminaCom(caminho, ".f64")) {
+        if (coluna != 0) {
+            throw std::runtime_error("COLUMN só vale para arquivos CSV: " + caminho);
+        }
+        auto dados = Vetor::mapearDados(caminho, dimensoes);
+        if (destino && destino->mapeado()) {
+            // DIM ... FILE: os valores vão para o arquivo do vetor
+            std::memcpy(destino->dados(), dados->dados(), static_cast<size_t>(destino->tamanho()) * sizeof(double));
+            return destino;
+        }
+        if (destino && destino->tipo() != TipoDeElemento::DOUBLE) {
+            // DIM ... AS BIT: os valores são convertidos para o tipo do vetor
+            destino->escreverBloco(0, destino->tamanho(), dados->dados());
+            return destino;
+        }
+        return dados;
+    }
+    std::vector<double> valores = lerCsv(caminho, coluna);
+    if (valores.empty()) {
+        throw std::runtime_error("Arquivo sem valores: " + caminho);
+    }
+    if (!destino) {
+        return std::make_shared<Vetor>(std::move(valores));
+    }
+    if (valores.size() != destino->tamanho()) {
+        throw std::runtime_error("Arquivo " + caminho + " tem " + std::to_string(valores.size())
+                                 + " valores e o vetor tem " + std::to_string(destino->tamanho()) + " posições");
+    }
+    if (destino->mapeado()) {
+        std::memcpy(destino->dados(), valores.data(), valores.size() * sizeof(double));
+        return destino;
+    }
+    if (destino->tipo() != TipoDeElemento::DOUBLE) {
+        destino->escreverBloco(0, valores.size(), valores.data());
+        return destino;
+    }
+    return std::make_shared<Vetor>(std::move(valores), std::move(dimensoes));
+}
@@ -1,7 +1,14 @@
 #include "Interpreter.h"
 #include "Parser.h"
+#include "Checkpoint.h"
+#include "Importacao.h"
+#include "Sondas.h"
 #include "util.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
 #include <cmath>
+#include <exception>
 #include <stdexcept>
 #include <memory>
 #include <iostream>
@@ -13,6 +20,12 @@
 #include <sstream>
 #include <ctime>
 #include <filesystem>
+#include <mutex>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <csignal>
+#endif
 
 /*
 Copyright 2024 Cleuton Sampaio de Melo Junir
@@ -32,31 +45,201 @@ limitations under the License.
 
 const std::string defaultViewPortFileName = "_DRAW";
 
-Interpreter::Interpreter(std::string basicScriptName) : basicScriptName(basicScriptName) {
-    // Inicialize variáveis com um map vazio
-    variables = std::unordered_map<std::string, std::vector<double>>();
-}
+namespace {
+    // Acrescenta o texto formatado por snprintf, com o mesmo "%f" de std::to_string
+    template <typename... Valores>
+    void acrescentarFormatado(std::string& texto, std::vector<char>& buffer, const char* formato, Valores... valores) {
+        int tamanho = std::snprintf(buffer.data(), buffer.size(), formato, valores...);
+        if (tamanho >= static_cast<int>(buffer.size())) {
+            // Números muito grandes: "%f" escreve todos os dígitos da parte inteira
+            buffer.resize(static_cast<size_t>(tamanho) + 1);
+            std::snprintf(buffer.data(), buffer.size(), formato, valores...);
+        }
+        texto.append(buffer.data(), static_cast<size_t>(tamanho));
+    }
+
+    // Formas dos nós especializados na primeira execução ("quickening"). Nas expressões, a
+    // forma guarda o tipo do nó nos bits altos e a operação ou função nos 3 bits baixos.
+    enum FormaDeExpressao : uint8_t {
+        FORMA_GERAL = 1,          // Caminho original, com dynamic_pointer_cast
+        FORMA_INTEIRA,            // Real: expressão inteira promovida
+        FORMA_NUMERO,
+        FORMA_TEMPORARIO,
+        FORMA_VARIAVEL,           // Variável simples (como real: com guarda)
+        FORMA_VETOR,
+        FORMA_BINARIA,
+        FORMA_VARIAVEL_CONSTANTE, // X op 2 (com guarda)
+        FORMA_VARIAVEL_VARIAVEL,  // X op Y (com guarda)
+        FORMA_FUNCAO
+    };
+
+    enum Operacao : uint8_t { SOMA, SUBTRACAO, MULTIPLICACAO, DIVISAO, POTENCIA, OUTRA };
+
+    // Funções sem estado; RND fica fora porque depende do gerador
+    enum Funcao : uint8_t { SIN, COS, TAN, LOG, EXP, SQR, ABS, NENHUMA };
+
+    enum FormaDeComando : uint8_t {
+        COMANDO_LET = 1, COMANDO_PRINT, COMANDO_GOTO, COMANDO_DIM, COMANDO_END, COMANDO_IF, COMANDO_INPUT,
+        COMANDO_CHECKPOINT, COMANDO_LOAD, COMANDO_SAVE, COMANDO_PARALLEL, COMANDO_NEXT, COMANDO_DRAW, COMANDO_PLOT,
+        COMANDO_LINE, COMANDO_RECTANGLE, COMANDO_DESCONHECIDO
+    };
+
+    constexpr uint8_t forma(FormaDeExpressao tipo, uint8_t detalhe = 0) {
+        return static_cast<uint8_t>(tipo << 3 | detalhe);
+    }
+
+    Operacao codigoDaOperacao(const std::string& op) {
+        if (op == "+") {
+            return SOMA;
+        } else if (op == "-") {
+            return SUBTRACAO;
+        } else if (op == "*") {
+            return MULTIPLICACAO;
+        } else if (op == "/") {
+            return DIVISAO;
+        } else if (op == "^") {
+            return POTENCIA;
+        }
+        return OUTRA;
+    }
+
+    inline double aplicar(uint8_t operacao, double left, double right) {
+        switch (operacao) {
+            case SOMA: return left + right;
+            case SUBTRACAO: return left - right;
+            case MULTIPLICACAO: return left * right;
+            case DIVISAO: return left / right;
+            default: return std::pow(left, right);
+        }
+    }
+
+    Funcao codigoDaFuncao(const std::string& nome) {
+        static const char* const nomes[] = {"SIN", "COS", "TAN", "LOG", "EXP", "SQR", "ABS"};
+        for (uint8_t k = 0; k < NENHUMA; ++k) {
+            if (nome == nomes[k]) {
+                return static_cast<Funcao>(k);
+            }
+        }
+        return NENHUMA;
+    }
+
+    double calcularFuncao(uint8_t funcao, double argumento) {
+        switch (funcao) {
+            case SIN: return std::sin(argumento * M_PI / 180.0);
+            case COS: return std::cos(argumento * M_PI / 180.0);
+            case TAN: return std::tan(argumento * M_PI / 180.0);
+            case LOG: return std::log(argumento);
+            case EXP: return std::exp(argumento);
+            case SQR: return std::sqrt(argumento);
+            default: return std::abs(argumento);
+        }
+    }
+
+    // Variável simples real: pode usar a forma com guarda
+    bool variavelReal(const NoDaASTPtr& expressao) {
+        auto identificador = dynamic_cast<const NoDeIdentificador*>(expressao.get());
+        return identificador != nullptr && identificador->indices.empty() && !identificador->inteira;
+    }
 
+    bool constanteReal(const NoDaASTPtr& expressao) {
+        auto numero = dynamic_cast<const NoDeNumero*>(expressao.get());
+        return numero != nullptr && !numero->inteira;
+    }
 
-double Interpreter::grausParaRadianos(double degrees) {
-    return degrees * M_PI / 180.0;
+    // As formas só dependem da estrutura da AST, que não muda na execução: qualquer thread que
+    // especialize o mesmo nó chega à mesma forma
+    uint8_t especializarReal(const NoDeExpressao& no) {
+        if (no.inteira) {
+            return forma(FORMA_INTEIRA);
+        } else if (dynamic_cast<const NoDeNumero*>(&no)) {
+            return forma(FORMA_NUMERO);
+        } else if (dynamic_cast<const NoDeTemporario*>(&no)) {
+            return forma(FORMA_TEMPORARIO);
+        } else if (auto identificador = dynamic_cast<const NoDeIdentificador*>(&no)) {
+            return forma(identificador->indices.empty() ? FORMA_VARIAVEL : FORMA_VETOR);
+        } else if (auto binaria = dynamic_cast<const NoDeExpressaoBinaria*>(&no)) {
+            Operacao operacao = codigoDaOperacao(binaria->op);
+            if (operacao == OUTRA) {
+                return forma(FORMA_GERAL);
+            } else if (variavelReal(binaria->left) && constanteReal(binaria->right)) {
+                return forma(FORMA_VARIAVEL_CONSTANTE, operacao);
+            } else if (variavelReal(binaria->left) && variavelReal(binaria->right)) {
+                return forma(FORMA_VARIAVEL_VARIAVEL, operacao);
+            }
+            return forma(FORMA_BINARIA, operacao);
+        } else if (auto funcao = dynamic_cast<const NoDeFuncao*>(&no)) {
+            Funcao codigo = codigoDaFuncao(funcao->nomeDaFuncao);
+            if (codigo != NENHUMA && funcao->argumentos.size() == 1) {
+                return forma(FORMA_FUNCAO, codigo);
+            }
+        }
+        return forma(FORMA_GERAL);
+    }
+
+    uint8_t especializarInteira(const NoDeExpressao& no) {
+        if (dynamic_cast<const NoDeNumero*>(&no)) {
+            return forma(FORMA_NUMERO);
+        } else if (dynamic_cast<const NoDeIdentificador*>(&no)) {
+            return forma(FORMA_VARIAVEL);
+        } else if (dynamic_cast<const NoDeTemporario*>(&no)) {
+            return forma(FORMA_TEMPORARIO);
+        } else if (auto binaria = dynamic_cast<const NoDeExpressaoBinaria*>(&no)) {
+            // Como no caminho geral: o que não é + nem - é multiplicação
+            Operacao operacao = codigoDaOperacao(binaria->op);
+            return forma(FORMA_BINARIA, operacao == SOMA || operacao == SUBTRACAO ? operacao : MULTIPLICACAO);
+        }
+        return forma(FORMA_GERAL);
+    }
+
+    uint8_t especializarComando(const NoDeComando& comando) {
+        if (dynamic_cast<const NoDoComandoLET*>(&comando)) {
+            return COMANDO_LET;
+        } else if (dynamic_cast<const NoDoComandoPRINT*>(&comando)) {
+            return COMANDO_PRINT;
+        } else if (dynamic_cast<const NoDoComandoGOTO*>(&comando)) {
+            return COMANDO_GOTO;
+        } else if (dynamic_cast<const NoDoComandoDIM*>(&comando)) {
+            return COMANDO_DIM;
+        } else if (dynamic_cast<const NoDoComandoEND*>(&comando)) {
+            return COMANDO_END;
+        } else if (dynamic_cast<const NoDoComandoIF*>(&comando)) {
+            return COMANDO_IF;
+        } else if (dynamic_cast<const NoDoComandoINPUT*>(&comando)) {
+            return COMANDO_INPUT;
+        } else if (dynamic_cast<const NoDoComandoCHECKPOINT*>(&comando)) {
+            return COMANDO_CHECKPOINT;
+        } else if (dynamic_cast<const NoDoComandoLOAD*>(&comando)) {
+            return COMANDO_LOAD;
+        } else if (dynamic_cast<const NoDoComandoSAVE*>(&comando)) {
+            return COMANDO_SAVE;
+        } else if (dynamic_cast<const NoDoComandoPARALLEL*>(&comando)) {
+            return COMANDO_PARALLEL;
+        } else if (dynamic_cast<const NoDoComandoNEXT*>(&comando)) {
+            return COMANDO_NEXT;
+        } else if (dynamic_cast<const NoDoComandoDRAW*>(&comando)) {
+            return COMANDO_DRAW;
+        } else if (dynamic_cast<const NoDoComandoPLOT*>(&comando)) {
+            return COMANDO_PLOT;
+        } else if (dynamic_cast<const NoDoComandoLINE*>(&comando)) {
+            return COMANDO_LINE;
+        } else if (dynamic_cast<const NoDoComandoRECTANGLE*>(&comando)) {
+            return COMANDO_RECTANGLE;
+        }
+        return COMANDO_DESCONHECIDO;
+    }
 }
 
+Interpreter::Interpreter(std::string basicScriptName)
+    : Interpreter(basicScriptName, std::cout, std::make_shared<EntradaConsole>()) {}
+
+Interpreter::Interpreter(std::string basicScriptName, std::ostream& saida, std::shared_ptr<FonteDeEntrada> entrada)
+    : basicScriptName(basicScriptName), saida(&saida), entrada(entrada) {}
+
+
 double Interpreter::processarFuncao(const std::string& nomeDaFuncao, double argumento, bool temArgumentos) {
-    if (nomeDaFuncao == "SIN") {
-        return std::sin(grausParaRadianos(argumento));
-    } else if (nomeDaFuncao == "COS") {
-        return std::cos(grausParaRadianos(argumento));
-    } else if (nomeDaFuncao == "TAN") {
-        return std::tan(grausParaRadianos(argumento));
-    } else if (nomeDaFuncao == "LOG") {
-        return std::log(argumento);
-    } else if (nomeDaFuncao == "EXP") {
-        return std::exp(argumento);
-    } else if (nomeDaFuncao == "SQR") {
-        return std::sqrt(argumento);
-    } else if (nomeDaFuncao == "ABS") {
-        return std::abs(argumento);
+    Funcao funcao = codigoDaFuncao(nomeDaFuncao);
+    if (funcao != NENHUMA) {
+        return calcularFuncao(funcao, argumento);
     } else if (nomeDaFuncao == "RND") {
         std::random_device rd;
         std::mt19937 gen(rd());
@@ -66,31 +249,339 @@ double Interpreter::processarFuncao(const std::string& nomeDaFuncao, double argu
     throw std::runtime_error("Função não suportada: " + nomeDaFuncao);
 }
 
-void Interpreter::executar(const std::shared_ptr<NoDePrograma>& programa) {
-    int index = 0;
-    while (index < programa->comandos.size()) { // Enquanto o índice for menor que o tamanho do vetor
-        const auto& statement = programa->comandos[index];
-        int newIndex = executarComando(statement, programa);
-        if (newIndex>=0) {
-            // Foi um GOTO ou um IF
-            index = newIndex;
+void Interpreter::definirVariavel(const std::string& nome, double valor) {
+    Variavel& variavel = variaveis[nome];
+    variavel.definida = true;
+    variavel.valor = valor;
+}
+
+void Interpreter::definirVetor(const std::string& nome, std::vector<double> valores) {
+    variaveis[nome].vetor = std::make_shared<Vetor>(std::move(valores));
+}
+
+Interpreter::Variavel& Interpreter::buscarVariavel(int slot, const std::string& nome) {
+    if (slot >= 0 && slot < static_cast<int>(enderecos.size())) {
+        Variavel*& endereco = enderecos[slot];
+        if (endereco == nullptr) {
+            endereco = &variaveis[nome];
+        }
+        return *endereco;
+    }
+    // Nó não resolvido (programa montado sem passar pelo Resolvedor)
+    return variaveis[nome];
+}
+
+void Interpreter::executar(const std::shared_ptr<NoDePrograma>& programa, int indiceInicial) {
+    iniciar(programa, indiceInicial);
+    while (passo(UINT64_MAX) == Situacao::AGUARDANDO_ENTRADA) {
+        entrada->esperar();
+    }
+}
+
+void Interpreter::iniciar(const std::shared_ptr<NoDePrograma>& programa, int indiceInicial) {
+    enderecos.assign(programa->simbolos->tamanho(), nullptr);
+    estadoLacos.assign(programa->lacos.size(), 0);
+    temporarios.assign(programa->numeroTemporarios, {});
+    programaAtual = programa;
+    proximoComando = indiceInicial;
+    comandoAnterior = -1;
+    encerrado = false;
+    executados = 0;
+}
+
+Interpreter::Situacao Interpreter::passo(uint64_t orcamento, std::chrono::steady_clock::time_point prazo) {
+    if (encerrado) {
+        return Situacao::TERMINOU;
+    }
+    const auto& programa = programaAtual;
+    bool comPrazo = prazo != std::chrono::steady_clock::time_point::max();
+    int index = proximoComando;
+    int anterior = comandoAnterior;
+    uint64_t feitos = 0;
+    Situacao situacao = Situacao::TERMINOU;
+    try {
+        while (index < programa->comandos.size()) { // Enquanto o índice for menor que o tamanho do vetor
+            if (feitos == orcamento) {
+                situacao = Situacao::CEDEU;
+                break;
+            }
+            // Consultar o relógio a cada comando custaria mais que muitos comandos
+            if (comPrazo && feitos > 0 && feitos % 256 == 0 && std::chrono::steady_clock::now() >= prazo) {
+                situacao = Situacao::CEDEU;
+                break;
+            }
+            if (pedidosPorSinal.load(std::memory_order_relaxed) != 0) {
+                atenderPedidos(index);
+            }
+            if (registro) {
+                registro->comando(index);
+            }
+            const auto& statement = programa->comandos[index];
+            const auto* comando = static_cast<const NoDeComando*>(statement.get());
+            int laco = comando->inicioDeLaco;
+            if (laco >= 0 && estadoLacos[laco] == 0) {
+                // Entrada no laço (vindo de fora dele): a guarda roda uma vez, não a cada volta
+                estadoLacos[laco] = verificarLaco(*programa, programa->lacos[laco]) ? 1 : 2;
+            }
+            if (comando->lacoNatural >= 0) {
+                // Invariantes do laço: descartadas quando se entra nele vindo de fora
+                const LacoNatural& natural = programa->lacosNaturais[comando->lacoNatural];
+                if (!natural.contem(anterior)) {
+                    for (int temporario : natural.temporarios) {
+                        temporarios[temporario].valido = false;
+                    }
+                }
+            }
+            for (int temporario : comando->temporariosDoBloco) {
+                temporarios[temporario].valido = false;
+            }
+            SONDA_COMANDO(comando->numeroLinha.c_str(), index);
+            int newIndex = executarComando(statement, programa);
+            if (newIndex == -3) {
+                // INPUT sem valor disponível: o mesmo comando é executado no próximo passo
+                situacao = Situacao::AGUARDANDO_ENTRADA;
+                break;
+            }
+            anterior = index;
+            ++feitos;
+            if (newIndex>=0) {
+                // Foi um GOTO ou um IF
+                if (registro) {
+                    registro->desvio(index, newIndex);
+                }
+                SONDA_DESVIO(comando->numeroLinha.c_str(),
+                             newIndex < static_cast<int>(programa->comandos.size())
+                                 ? static_cast<const NoDeComando*>(programa->comandos[newIndex].get())->numeroLinha.c_str()
+                                 : "");
+                index = newIndex;
+                continue;
+            } else if (newIndex == -2) {
+                // Encontrou um comando END
+                break;
+            }
+            ++index; // Incrementa o índice para avançar para o próximo elemento
+        }
+    } catch (...) {
+        encerrado = true;
+        executados += feitos;
+        throw;
+    }
+    proximoComando = index;
+    comandoAnterior = anterior;
+    executados += feitos;
+    encerrado = situacao == Situacao::TERMINOU;
+    if (encerrado && gravacoes) {
+        // O programa só termina com os SAVE ... ASYNC gravados
+        gravacoes->concluir();
+    }
+    return situacao;
+}
+
+bool Interpreter::terminou() const {
+    return encerrado;
+}
+
+uint64_t Interpreter::comandosExecutados() const {
+    return executados;
+}
+
+std::atomic<unsigned> Interpreter::pedidosPorSinal{0};
+
+void Interpreter::instalarPedidosPorSinal() {
+#if !defined(_WIN32)
+    struct sigaction acao{};
+    acao.sa_handler = [](int sinal) {
+        pedidosPorSinal.fetch_or(sinal == SIGUSR2 ? PEDIDO_CHECKPOINT : PEDIDO_REGISTRO, std::memory_order_relaxed);
+    };
+    sigemptyset(&acao.sa_mask);
+    acao.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &acao, nullptr);
+    sigaction(SIGUSR1, &acao, nullptr);
+#endif
+}
+
+void Interpreter::atenderPedidos(int index) {
+    unsigned pedidos = pedidosPorSinal.exchange(0, std::memory_order_relaxed);
+    // Uma falha aqui não deve interromper uma execução longa
+    if (pedidos & PEDIDO_CHECKPOINT) {
+        std::string caminho = basicScriptName + ".ckpt";
+        try {
+            gravarCheckpoint(caminho, index);
+            std::cerr << "Checkpoint gravado: " << caminho << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    if (pedidos & PEDIDO_REGISTRO) {
+        std::string caminho = basicScriptName + ".trace";
+        try {
+            if (gravarRegistroDeVoo(caminho, "SIGUSR1")) {
+                std::cerr << "Registro de execução gravado: " << caminho << std::endl;
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
+
+void Interpreter::ativarRegistroDeVoo(size_t capacidade) {
+    registro = std::make_unique<RegistroDeVoo>(capacidade);
+}
+
+bool Interpreter::gravarRegistroDeVoo(const std::string& caminho, const std::string& motivo) const {
+    if (!registro || !programaAtual) {
+        return false;
+    }
+    registro->gravar(caminho, motivo, *programaAtual);
+    return true;
+}
+
+void Interpreter::medir(Estatisticas* estatisticas) {
+    this->estatisticas = estatisticas;
+}
+
+void Interpreter::definirThreadsParalelas(unsigned numeroThreads) {
+    threadsParalelas = numeroThreads;
+}
+
+void Interpreter::guardarDesenhos(std::vector<std::string>* destino) {
+    desenhosGuardados = destino;
+}
+
+void Interpreter::gravarCheckpoint(const std::string& caminho, int proximoComando) {
+    GravadorDeCheckpoint gravador(caminho);
+    gravador.gravar(programaAtual ? programaAtual->hashDoFonte : 0);
+    gravador.gravar(static_cast<uint64_t>(proximoComando));
+    uint64_t quantidade = 0;
+    for (const auto& [nome, variavel] : variaveis) {
+        quantidade += variavel.definida || variavel.vetor ? 1 : 0;
+    }
+    gravador.gravar(quantidade);
+    for (const auto& [nome, variavel] : variaveis) {
+        if (!variavel.definida && !variavel.vetor) {
+            // Só consultada, nunca atribuída
             continue;
-        } else if (newIndex == -2) {
-            // Encontrou um comando END
-            break;
         }
-        ++index; // Incrementa o índice para avançar para o próximo elemento
+        gravador.gravar(nome);
+        if (!variavel.vetor) {
+            gravador.gravar(static_cast<uint64_t>(variavel.inteira ? 1 : 0));
+            gravador.gravar(variavel.valor);
+            gravador.gravar(static_cast<uint64_t>(variavel.inteiro));
+            continue;
+        }
+        Vetor& vetor = *variavel.vetor;
+        bool compacto = vetor.tipo() != TipoDeElemento::DOUBLE;
+        gravador.gravar(static_cast<uint64_t>(vetor.mapeado() ? 3 : vetor.esparso() ? 4 : compacto ? 5 : 2));
+        gravador.gravar(static_cast<uint64_t>(vetor.dimensoes().size()));
+        for (uint64_t dimensao : vetor.dimensoes()) {
+            gravador.gravar(dimensao);
+        }
+        if (vetor.mapeado()) {
+            vetor.sincronizar();
+            gravador.gravar(vetor.arquivo());
+            gravador.gravar(static_cast<uint64_t>(vetor.acessoAleatorio() ? 1 : 0));
+        } else if (compacto) {
+            gravador.gravar(static_cast<uint64_t>(vetor.tipo()));
+            gravador.gravarBloco(vetor.palavras(), vetor.numeroPalavras());
+        } else if (vetor.esparso()) {
+            // Só os elementos gravados: posição e valor
+            std::vector<std::pair<uint64_t, double>> gravados;
+            vetor.paraCadaGravado([&gravados](uint64_t posicao, double valor) {
+                gravados.emplace_back(posicao, valor);
+            });
+            gravador.gravar(static_cast<uint64_t>(gravados.size()));
+            for (const auto& [posicao, valor] : gravados) {
+                gravador.gravar(posicao);
+                gravador.gravar(valor);
+            }
+        } else {
+            gravador.gravarBloco(vetor.dados(), vetor.tamanho());
+        }
+    }
+    gravador.gravar(static_cast<uint64_t>(elementosSvg.size()));
+    for (const auto& elemento : elementosSvg) {
+        gravador.gravar(elemento);
+    }
+    gravador.concluir();
+}
+
+void Interpreter::restaurarCheckpoint(const std::shared_ptr<NoDePrograma>& programa, const std::string& caminho) {
+    LeitorDeCheckpoint leitor(caminho);
+    if (leitor.lerInteiro() != programa->hashDoFonte) {
+        throw std::runtime_error("Checkpoint " + caminho + " foi gravado por outra versão do programa");
+    }
+    uint64_t proximo = leitor.lerInteiro();
+    if (proximo > programa->comandos.size()) {
+        throw std::runtime_error("Checkpoint incompleto ou corrompido: " + caminho);
+    }
+    std::unordered_map<std::string, Variavel> lidas;
+    for (uint64_t quantidade = leitor.lerInteiro(); quantidade > 0; --quantidade) {
+        std::string nome = leitor.lerTexto();
+        Variavel& variavel = lidas[nome];
+        uint64_t tipo = leitor.lerInteiro();
+        if (tipo <= 1) {
+            variavel.definida = true;
+            variavel.inteira = tipo == 1;
+            variavel.valor = leitor.lerReal();
+            variavel.inteiro = static_cast<int64_t>(leitor.lerInteiro());
+            continue;
+        }
+        std::vector<uint64_t> dimensoes;
+        for (uint64_t quantas = leitor.lerInteiro(); quantas > 0; --quantas) {
+            dimensoes.push_back(leitor.lerInteiro());
+        }
+        if (tipo == 3) {
+            std::string arquivo = leitor.lerTexto();
+            bool acessoAleatorio = leitor.lerInteiro() != 0;
+            variavel.vetor = Vetor::mapearArquivo(arquivo, dimensoes, acessoAleatorio);
+        } else if (tipo == 4) {
+            variavel.vetor = std::make_shared<Vetor>(dimensoes);
+            for (uint64_t gravados = leitor.lerInteiro(); gravados > 0; --gravados) {
+                uint64_t posicao = leitor.lerInteiro();
+                double valor = leitor.lerReal();
+                if (posicao >= variavel.vetor->tamanho()) {
+                    throw std::runtime_error("Checkpoint incompleto ou corrompido: " + caminho);
+                }
+                variavel.vetor->escrever(posicao, valor);
+            }
+        } else if (tipo == 5) {
+            uint64_t tipoDosElementos = leitor.lerInteiro();
+            if (tipoDosElementos == 0 || tipoDosElementos > static_cast<uint64_t>(TipoDeElemento::BIT)) {
+                throw std::runtime_error("Checkpoint incompleto ou corrompido: " + caminho);
+            }
+            variavel.vetor = std::make_shared<Vetor>(dimensoes, static_cast<TipoDeElemento>(tipoDosElementos));
+            leitor.lerBloco(variavel.vetor->palavras(), variavel.vetor->numeroPalavras());
+        } else {
+            variavel.vetor = std::make_shared<Vetor>(dimensoes);
+            if (!variavel.vetor->densificar()) {
+                throw std::runtime_error("Memória insuficiente para o vetor " + nome + " do checkpoint " + caminho);
+            }
+            leitor.lerBloco(variavel.vetor->dados(), variavel.vetor->tamanho());
+        }
+    }
+    std::vector<std::string> elementos;
+    for (uint64_t quantidade = leitor.lerInteiro(); quantidade > 0; --quantidade) {
+        elementos.push_back(leitor.lerTexto());
     }
+    variaveis = std::move(lidas);
+    elementosSvg = std::move(elementos);
+    // Laços e temporários recomeçam vazios: as guardas e invariantes são recalculadas no uso
+    iniciar(programa, static_cast<int>(proximo));
 }
 
 std::string getViewportFileName(std::string basicScriptName) {
     // Obter o tempo atual
     std::time_t now = std::time(nullptr);
-    std::tm* localTime = std::localtime(&now);
 
-    // Usar stringstream para formatar a data e hora
+    // Usar stringstream para formatar a data e hora.
+    // std::localtime usa um buffer estático, e no --sweep vários interpretadores rodam em paralelo
+    static std::mutex mutexLocaltime;
     std::stringstream ss;
-    ss << std::put_time(localTime, "%Y-%m-%d_%H-%M-%S");
+    {
+        std::lock_guard<std::mutex> lock(mutexLocaltime);
+        std::tm* localTime = std::localtime(&now);
+        ss << std::put_time(localTime, "%Y-%m-%d_%H-%M-%S");
+    }
 
     try {
         // Obtendo o diretório atual
@@ -107,24 +598,32 @@ std::string getViewportFileName(std::string basicScriptName) {
     return "";
 }
 
+std::string Interpreter::gravarDesenho(const std::string& basicScriptName, const std::string& conteudo) {
+    std::string viewPortFileName = getViewportFileName(basicScriptName);
+    // Cria o arquivo SVG
+    std::ofstream viewPortFile(viewPortFileName);
+    if (!viewPortFile.is_open()) {
+        throw std::runtime_error("Erro ao abrir o arquivo para escrita.\n");
+    }
+    viewPortFile << conteudo;
+    viewPortFile.close();
+    SONDA_SVG(viewPortFileName.c_str(), conteudo.size());
+    return viewPortFileName;
+}
+
 void Interpreter::executarComandoDraw(const std::shared_ptr<NoDaAST>& comando) {
     auto drawStmt = std::dynamic_pointer_cast<NoDoComandoDRAW>(comando);
     if (drawStmt->tipo == "FINISH") {
-        std::string viewPortFileName = getViewportFileName(Interpreter::basicScriptName);
-        // Cria o arquivo SVG
-        std::ofstream viewPortFile(viewPortFileName);
-        if (viewPortFile.is_open()) {
-
-            // Escreve os elementos SVG
-            for (const auto& elemento : Interpreter::elementosSvg) {
-                viewPortFile << elemento << std::endl;
-            }
-
-            // Escreve o rodapé do SVG
-            viewPortFile << "</svg>" << std::endl;
-            viewPortFile.close();
-        } else {
-            throw std::runtime_error("Erro ao abrir o arquivo para escrita.\n");
+        MedicaoDeFase medicao(estatisticas, Estatisticas::SVG);
+        std::string conteudo;
+        for (const auto& elemento : Interpreter::elementosSvg) {
+            conteudo += elemento + "\n";
+        }
+        // Rodapé do SVG
+        conteudo += "</svg>\n";
+        gravarDesenho(basicScriptName, conteudo);
+        if (desenhosGuardados != nullptr) {
+            desenhosGuardados->push_back(std::move(conteudo));
         }
     } else  {
         // Begin
@@ -138,8 +637,55 @@ void Interpreter::executarComandoDraw(const std::shared_ptr<NoDaAST>& comando) {
     }
 }
 
+uint64_t Interpreter::prepararDesenhos(const std::string& comando,
+                                       const std::vector<const std::shared_ptr<NoDaAST>*>& expressoes,
+                                       std::vector<AtributoDeDesenho>& atributos) {
+    atributos.assign(expressoes.size(), {});
+    const Vetor* primeiro = nullptr;
+    for (size_t k = 0; k < expressoes.size(); ++k) {
+        const std::shared_ptr<NoDaAST>& expressao = *expressoes[k];
+        auto identificador = std::dynamic_pointer_cast<NoDeIdentificador>(expressao);
+        if (identificador && identificador->indices.empty()) {
+            Variavel& variavel = buscarVariavel(identificador->slot, identificador->name);
+            if (variavel.vetor) {
+                atributos[k].vetor = variavel.vetor.get();
+                if (primeiro == nullptr) {
+                    primeiro = atributos[k].vetor;
+                } else if (atributos[k].vetor->tamanho() != primeiro->tamanho()) {
+                    throw std::runtime_error(comando + " ALL com vetores de tamanhos diferentes: "
+                                             + identificador->name);
+                }
+                continue;
+            }
+        }
+        atributos[k].valor = avaliarExpressao(expressao);
+    }
+    if (primeiro == nullptr) {
+        throw std::runtime_error(comando + " ALL sem nenhum vetor");
+    }
+    return primeiro->tamanho();
+}
+
 void Interpreter::executarComandoPlot(const std::shared_ptr<NoDaAST> &comando) {
     auto plotStmt = std::dynamic_pointer_cast<NoDoComandoPLOT>(comando);
+    if (plotStmt->todos) {
+        std::vector<AtributoDeDesenho> atributos;
+        uint64_t quantos = prepararDesenhos("PLOT", {&plotStmt->posicaoX, &plotStmt->posicaoY, &plotStmt->espessura},
+                                            atributos);
+        std::string cor = plotStmt->cor;
+        std::string fill = plotStmt->preencher ? " fill=\"" + cor + "\"" : " fill=\"none\" ";
+        // Um só elemento com todos os desenhos, separados como os de PLOTs sucessivos
+        std::string desenhos;
+        std::vector<char> buffer(256);
+        for (uint64_t k = 0; k < quantos; ++k) {
+            acrescentarFormatado(desenhos, buffer,
+                                 "<circle cx=\"%f\" cy=\"%f\" r=\"%f\" stroke=\"%s\" stroke-width=\"1\"%s />\n%s",
+                                 atributos[0].em(k), atributos[1].em(k), atributos[2].em(k), cor.c_str(), fill.c_str(),
+                                 k + 1 < quantos ? "\n" : "");
+        }
+        Interpreter::elementosSvg.push_back(std::move(desenhos));
+        return;
+    }
     double x = avaliarExpressao(plotStmt->posicaoX);
     double y = avaliarExpressao(plotStmt->posicaoY);
     double raio = avaliarExpressao(plotStmt->espessura);
@@ -157,6 +703,27 @@ void Interpreter::executarComandoPlot(const std::shared_ptr<NoDaAST> &comando) {
 
 void Interpreter::executarComandoRectangle(const std::shared_ptr<NoDaAST> &comando) {
     auto rectStmt = std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando);
+    if (rectStmt->todos) {
+        std::vector<AtributoDeDesenho> atributos;
+        uint64_t quantos = prepararDesenhos("RECTANGLE",
+                                            {&rectStmt->xCantoSuperiorEsquerdo, &rectStmt->yCantoSuperiorEsquerdo,
+                                             &rectStmt->xCantoInferiorDireito, &rectStmt->yCantoInferiorDireito},
+                                            atributos);
+        std::string cor = rectStmt->cor;
+        std::string fill = rectStmt->preencher ? " fill=\"" + cor + "\"" : " fill=\"none\" ";
+        std::string desenhos;
+        std::vector<char> buffer(256);
+        for (uint64_t k = 0; k < quantos; ++k) {
+            double x1 = atributos[0].em(k);
+            double y1 = atributos[1].em(k);
+            acrescentarFormatado(desenhos, buffer,
+                                 "<rect x=\"%f\" y=\"%f\" width=\"%f\" height=\"%f\"%s stroke=\"%s\" stroke-width=\"1\" />\n%s",
+                                 x1, y1, atributos[2].em(k) - x1, atributos[3].em(k) - y1, fill.c_str(), cor.c_str(),
+                                 k + 1 < quantos ? "\n" : "");
+        }
+        Interpreter::elementosSvg.push_back(std::move(desenhos));
+        return;
+    }
     double x1 = avaliarExpressao(rectStmt->xCantoSuperiorEsquerdo);
     double y1 = avaliarExpressao(rectStmt->yCantoSuperiorEsquerdo);
     double x2 = avaliarExpressao(rectStmt->xCantoInferiorDireito);
@@ -175,6 +742,22 @@ void Interpreter::executarComandoRectangle(const std::shared_ptr<NoDaAST> &coman
 
 void Interpreter::executarComandoLine(const std::shared_ptr<NoDaAST> &comando) {
     auto lineStmt = std::dynamic_pointer_cast<NoDoComandoLINE>(comando);
+    if (lineStmt->todos) {
+        std::vector<AtributoDeDesenho> atributos;
+        uint64_t quantos = prepararDesenhos("LINE", {&lineStmt->xInicial, &lineStmt->yInicial,
+                                                     &lineStmt->xFinal, &lineStmt->yFinal},
+                                            atributos);
+        std::string desenhos;
+        std::vector<char> buffer(256);
+        for (uint64_t k = 0; k < quantos; ++k) {
+            acrescentarFormatado(desenhos, buffer,
+                                 "<line x1=\"%f\" y1=\"%f\" x2=\"%f\" y2=\"%f\" stroke=\"%s\" stroke-width=\"1\" />\n%s",
+                                 atributos[0].em(k), atributos[1].em(k), atributos[2].em(k), atributos[3].em(k),
+                                 lineStmt->cor.c_str(), k + 1 < quantos ? "\n" : "");
+        }
+        Interpreter::elementosSvg.push_back(std::move(desenhos));
+        return;
+    }
     double x1 = avaliarExpressao(lineStmt->xInicial);
     double y1 = avaliarExpressao(lineStmt->yInicial);
     double x2 = avaliarExpressao(lineStmt->xFinal);
@@ -187,96 +770,226 @@ void Interpreter::executarComandoLine(const std::shared_ptr<NoDaAST> &comando) {
 }
 
 int Interpreter::executarComando(const std::shared_ptr<NoDaAST>& comando, const std::shared_ptr<NoDePrograma>& programa) {
-    if (auto letStmt = std::dynamic_pointer_cast<NoDoComandoLET>(comando)) {
+    auto* no = static_cast<NoDeComando*>(comando.get());
+    uint8_t tipo = no->forma.load(std::memory_order_relaxed);
+    if (tipo == 0) {
+        tipo = especializarComando(*no);
+        no->forma.store(tipo, std::memory_order_relaxed);
+    }
+    if (tipo == COMANDO_LET) {
+        auto* letStmt = static_cast<NoDoComandoLET*>(no);
+        if (letStmt->inteira) {
+            // LET I% = ...: o Resolvedor garante que não é um vetor
+            const auto* expressao = static_cast<const NoDeExpressao*>(letStmt->expressao.get());
+            int64_t valor = expressao->inteira ? avaliarInteiro(letStmt->expressao)
+                                               : paraInteiro(avaliarExpressao(letStmt->expressao));
+            Variavel& variavel = buscarVariavel(letStmt->slot, letStmt->identificador);
+            variavel.definida = true;
+            variavel.inteira = true;
+            variavel.inteiro = valor;
+            if (registro) {
+                registro->escritaInteira(letStmt->slot, valor);
+            }
+            return -1;
+        }
         double value = avaliarExpressao(letStmt->expressao);
-        if (letStmt->posicao.empty()) {
+        Variavel& variavel = buscarVariavel(letStmt->slot, letStmt->identificador);
+        if (letStmt->indices.empty()) {
             // Não deveria ser um vetor...
-            if (vetores.find(letStmt->identificador) != vetores.end()) {
+            if (variavel.vetor) {
                 std::ostringstream oss;
                 oss << "Vetor deve ser sempre indexado: " << letStmt->identificador;
                 throw std::runtime_error(oss.str());
             }
-            variables[letStmt->identificador] = std::vector<double>(1, value);
+            variavel.definida = true;
+            variavel.valor = value;
+            if (registro) {
+                registro->escrita(letStmt->slot, value);
+            }
         } else {
             // Deveria ser um vetor...
-            if (vetores.find(letStmt->identificador) == vetores.end()) {
+            if (!variavel.vetor) {
                 std::ostringstream oss;
                 oss << "Variavel nao e um vetor: " << letStmt->identificador;
                 throw std::runtime_error(oss.str());
             }
-            int posicao = getPosicao(letStmt->identificador, letStmt->posicao);
-            variables[letStmt->identificador].at(posicao) = value;
+            uint64_t posicao = getPosicao(letStmt->identificador, *variavel.vetor, letStmt->indices);
+            variavel.vetor->escrever(posicao, value);
+            if (registro) {
+                // Nos tipos compactos, o valor já convertido
+                registro->escritaVetor(letStmt->slot, posicao, variavel.vetor->ler(posicao));
+            }
         }
-    } else if (auto printStmt = std::dynamic_pointer_cast<NoDoComandoPRINT>(comando)) {
+    } else if (tipo == COMANDO_PRINT) {
+        auto* printStmt = static_cast<NoDoComandoPRINT*>(no);
         if (printStmt->printLiteral) {
-            std::cout << printStmt->literal << std::endl;
+            *saida << printStmt->literal << std::endl;
+        } else if (static_cast<const NoDeExpressao*>(printStmt->expressao.get())->inteira) {
+            // Inteiros são impressos com todos os dígitos
+            *saida << avaliarInteiro(printStmt->expressao) << std::endl;
         } else {
             double value = avaliarExpressao(printStmt->expressao);
-            std::cout << value << std::endl;
+            *saida << value << std::endl;
         }
-    } else if (auto gotoStmt = std::dynamic_pointer_cast<NoDoComandoGOTO>(comando)) {
-        int index = 0;
-        while (index < programa->comandos.size()) {
-            const auto& statement = std::dynamic_pointer_cast<NoDeComando>(programa->comandos[index]);
-            if (statement->numeroLinha == gotoStmt->numeroLinhaDesvio) {
-                return index;
-            }
-            ++index;
+    } else if (tipo == COMANDO_GOTO) {
+        auto* gotoStmt = static_cast<NoDoComandoGOTO*>(no);
+        int index = programa->indiceDaLinha(gotoStmt->numeroLinhaDesvio);
+        if (index >= 0) {
+            return index;
         }
         throw std::runtime_error("Numero de linha inexistente");
-    } else if (auto dimStmt = std::dynamic_pointer_cast<NoDoComandoDIM>(comando)) {
-        if (variables.find(dimStmt->nomeVariavel) != variables.end()) {
+    } else if (tipo == COMANDO_DIM) {
+        auto* dimStmt = static_cast<NoDoComandoDIM*>(no);
+        Variavel& variavel = buscarVariavel(dimStmt->slot, dimStmt->nomeVariavel);
+        if (variavel.definida || variavel.vetor) {
             std::ostringstream oss;
             oss << "Já existe variável com esse nome: " << dimStmt->nomeVariavel;
             throw std::runtime_error(oss.str());
         }
-        vetores[dimStmt->nomeVariavel] = dimStmt->numeroOcorrencias;
-        variables[dimStmt->nomeVariavel] = std::vector<double>(dimStmt->numeroOcorrencias, 0.0);
-    } else if (auto endStmt = std::dynamic_pointer_cast<NoDoComandoEND>(comando)) {
-        std::cout << "Comando END" << std::endl;
+        if (dimStmt->arquivo.empty()) {
+            variavel.vetor = std::make_shared<Vetor>(dimStmt->dimensoes, dimStmt->tipo);
+        } else {
+            // Vetor persistente, mapeado do arquivo: pode ser maior que a memória
+            variavel.vetor = Vetor::mapearArquivo(dimStmt->arquivo, dimStmt->dimensoes, dimStmt->acessoAleatorio);
+        }
+        SONDA_DIM(dimStmt->nomeVariavel.c_str(), variavel.vetor->tamanho(), dimStmt->arquivo.c_str());
+    } else if (tipo == COMANDO_LOAD) {
+        auto* loadStmt = static_cast<NoDoComandoLOAD*>(no);
+        Variavel& variavel = buscarVariavel(loadStmt->slot, loadStmt->nomeVariavel);
+        if (variavel.definida) {
+            throw std::runtime_error("Já existe variável com esse nome: " + loadStmt->nomeVariavel);
+        }
+        if (!variavel.vetor && loadStmt->declarado) {
+            // As dimensões do DIM já foram usadas na validação dos índices literais
+            throw std::runtime_error("LOAD antes do DIM do vetor: " + loadStmt->nomeVariavel);
+        }
+        variavel.vetor = carregarVetor(loadStmt->arquivo, loadStmt->coluna, variavel.vetor);
+    } else if (tipo == COMANDO_SAVE) {
+        auto* saveStmt = static_cast<NoDoComandoSAVE*>(no);
+        std::vector<std::shared_ptr<const Vetor>> vetores;
+        for (size_t k = 0; k < saveStmt->nomes.size(); ++k) {
+            Variavel& variavel = buscarVariavel(saveStmt->slots[k], saveStmt->nomes[k]);
+            if (!variavel.vetor) {
+                throw std::runtime_error("SAVE só grava vetores: " + saveStmt->nomes[k]);
+            }
+            vetores.push_back(variavel.vetor);
+        }
+        if (saveStmt->assincrono) {
+            // Os erros de formato aparecem aqui; os de disco, no próximo SAVE ou no fim do programa
+            verificarGravacao(saveStmt->arquivo, vetores);
+            for (auto& vetor : vetores) {
+                vetor = copiarVetor(*vetor);
+            }
+            if (!gravacoes) {
+                gravacoes = std::make_unique<GravadorEmSegundoPlano>();
+            }
+            gravacoes->enfileirar([arquivo = saveStmt->arquivo, vetores = std::move(vetores)] {
+                gravarVetores(arquivo, vetores);
+            });
+        } else {
+            // Um SAVE depois de outros ASYNC grava depois deles, como no fonte
+            if (gravacoes) {
+                gravacoes->concluir();
+            }
+            gravarVetores(saveStmt->arquivo, vetores);
+        }
+    } else if (tipo == COMANDO_PARALLEL) {
+        auto* parallelStmt = static_cast<NoDoComandoPARALLEL*>(no);
+        executarParalelo(*parallelStmt, programa);
+        // As voltas já foram executadas: segue depois do NEXT
+        return parallelStmt->next + 1;
+    } else if (tipo == COMANDO_NEXT) {
+        // O Resolvedor não deixa desviar para dentro do corpo
+        throw std::runtime_error("NEXT sem PARALLEL FOR");
+    } else if (tipo == COMANDO_END) {
+        *saida << "Comando END" << std::endl;
         return -2; // Terminar o programa
-    } else if (auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(comando)) {
-        double operando1 = avaliarExpressao(ifStmt->operando1);
-        double operando2 = avaliarExpressao(ifStmt->operando2);
-        double resultado = operando1 - operando2;
+    } else if (tipo == COMANDO_IF) {
+        auto* ifStmt = static_cast<NoDoComandoIF*>(no);
         bool trueFalse = false;
-        if (ifStmt->operadorLogico == "=") {
-            if (resultado == 0) {
-                trueFalse = true;
-            }
-        } else if (ifStmt->operadorLogico == ">") {
-            if (resultado > 0) {
-                trueFalse = true;
+        if (static_cast<const NoDeExpressao*>(ifStmt->operando1.get())->inteira
+            && static_cast<const NoDeExpressao*>(ifStmt->operando2.get())->inteira) {
+            // Dois inteiros: comparação exata, mesmo acima de 2^53
+            int64_t operando1 = avaliarInteiro(ifStmt->operando1);
+            int64_t operando2 = avaliarInteiro(ifStmt->operando2);
+            if (ifStmt->operadorLogico == "=") {
+                trueFalse = operando1 == operando2;
+            } else if (ifStmt->operadorLogico == ">") {
+                trueFalse = operando1 > operando2;
+            } else {
+                trueFalse = operando1 < operando2;
             }
         } else {
-            if (resultado < 0) {
-                trueFalse = true;
+            double operando1 = avaliarExpressao(ifStmt->operando1);
+            double operando2 = avaliarExpressao(ifStmt->operando2);
+            double resultado = operando1 - operando2;
+            if (ifStmt->operadorLogico == "=") {
+                if (resultado == 0) {
+                    trueFalse = true;
+                }
+            } else if (ifStmt->operadorLogico == ">") {
+                if (resultado > 0) {
+                    trueFalse = true;
+                }
+            } else {
+                if (resultado < 0) {
+                    trueFalse = true;
+                }
             }
         }
         if (trueFalse) {
             // vai desviar para a linha THEN
-            int index = 0;
-            while (index < programa->comandos.size()) {
-                const auto& statement = std::dynamic_pointer_cast<NoDeComando>(programa->comandos[index]);
-                if (statement->numeroLinha == ifStmt->numeroLinha) {
-                    return index;
-                }
-                ++index;
-            }
+            return programa->indiceDaLinha(ifStmt->numeroLinha);
+        }
+        if (ifStmt->fimDeLaco >= 0 && ifStmt->fimDeLaco < static_cast<int>(estadoLacos.size())) {
+            // Saída do laço: a próxima entrada roda a guarda de novo
+            estadoLacos[ifStmt->fimDeLaco] = 0;
         }
         return -1;
-    } else if (auto inputStmt = std::dynamic_pointer_cast<NoDoComandoINPUT>(comando)) {
+    } else if (tipo == COMANDO_INPUT) {
+        auto* inputStmt = static_cast<NoDoComandoINPUT*>(no);
+        if (!entrada->pronta()) {
+            return -3;
+        }
+        Variavel& variavel = buscarVariavel(inputStmt->slot, inputStmt->identificador);
+        if (variavel.vetor) {
+            std::ostringstream oss;
+            oss << "Vetor deve ser sempre indexado: " << inputStmt->identificador;
+            throw std::runtime_error(oss.str());
+        }
         double valor;
-        std::cout << "# ";
-        std::cin >> valor;
-        variables[inputStmt->identificador] = std::vector<double>(1, valor);
-    } else if (auto drawStmt = std::dynamic_pointer_cast<NoDoComandoDRAW>(comando)) {
+        try {
+            valor = entrada->lerValor();
+        } catch (const std::runtime_error& e) {
+            // A fonte de entrada não conhece o programa: a linha do INPUT é acrescentada aqui
+            throw std::runtime_error("Linha " + inputStmt->numeroLinha + ": " + e.what());
+        }
+        if (inputStmt->inteira) {
+            variavel.inteiro = paraInteiro(valor);
+            variavel.inteira = true;
+            if (registro) {
+                registro->escritaInteira(inputStmt->slot, variavel.inteiro);
+            }
+        } else {
+            variavel.valor = valor;
+            if (registro) {
+                registro->escrita(inputStmt->slot, valor);
+            }
+        }
+        variavel.definida = true;
+    } else if (tipo == COMANDO_CHECKPOINT) {
+        auto* checkpointStmt = static_cast<NoDoComandoCHECKPOINT*>(no);
+        // Retomado, o programa continua no comando seguinte ao CHECKPOINT
+        int proximo = programa->indiceDaLinha(checkpointStmt->numeroLinha) + 1;
+        gravarCheckpoint(checkpointStmt->arquivo.empty() ? basicScriptName + ".ckpt" : checkpointStmt->arquivo,
+                         proximo);
+    } else if (tipo == COMANDO_DRAW) {
         executarComandoDraw(comando);
-    } else if (auto plotStmt = std::dynamic_pointer_cast<NoDoComandoPLOT>(comando)) {
+    } else if (tipo == COMANDO_PLOT) {
         executarComandoPlot(comando);
-    } else if (auto lineStmt = std::dynamic_pointer_cast<NoDoComandoLINE>(comando)) {
+    } else if (tipo == COMANDO_LINE) {
         executarComandoLine(comando);
-    } else if (auto rectStmt = std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando)) {
+    } else if (tipo == COMANDO_RECTANGLE) {
         executarComandoRectangle(comando);
     } else {
         throw std::runtime_error("Tipo de comando inexperado");
@@ -284,51 +997,519 @@ int Interpreter::executarComando(const std::shared_ptr<NoDaAST>& comando, const
     return -1;
 }
 
-int Interpreter::getPosicao(const std::string &variavel, const std::string &indexador) {
-    int valor = 0;
-    if (isNumeric(indexador)) {
-        // É uma posição. vamos ver se ela existe
-        valor = std::stoi(indexador);
+void Interpreter::executarParalelo(const NoDoComandoPARALLEL& paralelo, const std::shared_ptr<NoDePrograma>& programa) {
+    Variavel& contador = buscarVariavel(paralelo.slotContador, paralelo.contador);
+    if (contador.vetor) {
+        throw std::runtime_error("Vetor deve ser sempre indexado: " + paralelo.contador);
+    }
+    bool contadorInteiro = TabelaDeSimbolos::inteira(paralelo.contador);
+    double inicio = avaliarExpressao(paralelo.inicio);
+    double fim = avaliarExpressao(paralelo.fim);
+    if (contadorInteiro) {
+        inicio = static_cast<double>(paraInteiro(inicio));
+    }
+    std::vector<Variavel*> reducoes;
+    for (size_t r = 0; r < paralelo.reducoes.size(); ++r) {
+        Variavel& reducao = buscarVariavel(paralelo.slotsReducoes[r], paralelo.reducoes[r]);
+        if (!reducao.definida) {
+            throw std::runtime_error("Variável não declarada: " + paralelo.reducoes[r]);
+        }
+        reducoes.push_back(&reducao);
+    }
+    // Limites vêm do programa: NaN, infinito ou mais de 2^64 voltas não cabem no uint64_t
+    if (!std::isfinite(inicio) || !std::isfinite(fim)) {
+        std::ostringstream oss;
+        oss << "Limites inválidos no PARALLEL FOR: " << inicio << " a " << fim;
+        throw std::runtime_error(oss.str());
+    }
+    double diferenca = std::floor(fim - inicio);
+    if (fim >= inicio && !(diferenca < 18446744073709551616.0)) {
+        std::ostringstream oss;
+        oss << "Voltas demais no PARALLEL FOR: " << inicio << " a " << fim;
+        throw std::runtime_error(oss.str());
+    }
+    uint64_t voltas = fim >= inicio ? static_cast<uint64_t>(diferenca) + 1 : 0;
+    int64_t fimInteiro = 0;
+    if (contadorInteiro && (voltas > static_cast<uint64_t>(INT64_MAX)
+                            || __builtin_add_overflow(static_cast<int64_t>(inicio), static_cast<int64_t>(voltas), &fimInteiro))) {
+        std::ostringstream oss;
+        oss << "Estouro de inteiro no PARALLEL FOR: " << inicio << " a " << fim;
+        throw std::runtime_error(oss.str());
+    }
+
+    // As voltas são divididas em trechos fixos, que só dependem do número de voltas: as somas
+    // parciais de cada trecho e a soma delas, na ordem dos trechos, dão sempre o mesmo resultado
+    constexpr uint64_t maximoTrechos = 1024;
+    uint64_t numeroTrechos = std::min(voltas, maximoTrechos);
+    auto inicioDoTrecho = [&](uint64_t trecho) {
+        return voltas / numeroTrechos * trecho + std::min(trecho, voltas % numeroTrechos);
+    };
+    unsigned numeroThreads = threadsParalelas != 0 ? threadsParalelas : std::max(1u, std::thread::hardware_concurrency());
+    numeroThreads = static_cast<unsigned>(std::min<uint64_t>(numeroThreads, numeroTrechos));
+    // Um vetor esparso muda de estrutura ao receber um elemento: só vetores densos são
+    // alterados por várias threads ao mesmo tempo
+    for (size_t k = 0; k < paralelo.vetoresEscritos.size(); ++k) {
+        Variavel& vetor = buscarVariavel(paralelo.slotsVetoresEscritos[k], paralelo.vetoresEscritos[k]);
+        if (vetor.vetor && vetor.vetor->esparso() && !vetor.vetor->densificar()) {
+            numeroThreads = std::min(numeroThreads, 1u);
+        }
+    }
+    std::vector<Vetor*> compartilhados;
+    for (size_t k = 0; k < paralelo.vetoresEscritos.size() && numeroThreads > 1; ++k) {
+        Variavel& vetor = buscarVariavel(paralelo.slotsVetoresEscritos[k], paralelo.vetoresEscritos[k]);
+        if (vetor.vetor && vetor.vetor->tipo() == TipoDeElemento::BIT) {
+            vetor.vetor->compartilhar(true);
+            compartilhados.push_back(vetor.vetor.get());
+        }
+    }
+
+    // Cada thread tem uma faixa de trechos e começa pelo início dela. Sem trechos na própria
+    // faixa, rouba a metade final da faixa de outra thread.
+    struct Faixa {
+        std::mutex mutex;
+        uint64_t proximo = 0;
+        uint64_t fim = 0;
+    };
+    std::vector<Faixa> faixas(numeroThreads);
+    for (unsigned t = 0; t < numeroThreads; ++t) {
+        faixas[t].proximo = numeroTrechos * t / numeroThreads;
+        faixas[t].fim = numeroTrechos * (t + 1) / numeroThreads;
+    }
+    auto pegarTrecho = [&](unsigned t, uint64_t& trecho) {
+        {
+            std::lock_guard<std::mutex> trava(faixas[t].mutex);
+            if (faixas[t].proximo < faixas[t].fim) {
+                trecho = faixas[t].proximo++;
+                return true;
+            }
+        }
+        for (unsigned deslocamento = 1; deslocamento < numeroThreads; ++deslocamento) {
+            Faixa& vitima = faixas[(t + deslocamento) % numeroThreads];
+            uint64_t inicioRoubado;
+            uint64_t fimRoubado;
+            {
+                std::lock_guard<std::mutex> trava(vitima.mutex);
+                uint64_t restantes = vitima.fim - vitima.proximo;
+                if (restantes == 0) {
+                    continue;
+                }
+                fimRoubado = vitima.fim;
+                vitima.fim -= (restantes + 1) / 2;
+                inicioRoubado = vitima.fim;
+            }
+            std::lock_guard<std::mutex> trava(faixas[t].mutex);
+            trecho = inicioRoubado;
+            faixas[t].proximo = inicioRoubado + 1;
+            faixas[t].fim = fimRoubado;
+            return true;
+        }
+        return false;
+    };
+
+    // Cada thread executa o corpo em um Interpreter próprio: uma cópia das variáveis simples,
+    // com os vetores compartilhados
+    std::vector<std::unique_ptr<Interpreter>> trabalhadores;
+    for (unsigned t = 0; t < numeroThreads; ++t) {
+        auto trabalhador = std::make_unique<Interpreter>(basicScriptName, *saida, entrada);
+        trabalhador->variaveis = variaveis;
+        trabalhador->iniciar(programa);
+        trabalhadores.push_back(std::move(trabalhador));
+    }
+    std::vector<double> parciais(numeroTrechos * reducoes.size(), 0.0);
+    // Com erro, os trechos seguintes ao do erro não são executados; o erro informado é o do
+    // menor trecho, o mesmo que a execução em ordem encontraria primeiro. Qualquer exceção
+    // (inclusive bad_alloc) fica guardada e é lançada de novo nesta thread, depois do join
+    std::atomic<uint64_t> trechoComErro{UINT64_MAX};
+    std::mutex mutexDoErro;
+    std::exception_ptr erro;
+    auto guardarErro = [&](uint64_t trecho) {
+        std::lock_guard<std::mutex> trava(mutexDoErro);
+        if (!erro || trecho < trechoComErro.load(std::memory_order_relaxed)) {
+            trechoComErro.store(trecho, std::memory_order_relaxed);
+            erro = std::current_exception();
+        }
+    };
+    auto trabalhar = [&](unsigned t) {
+        Interpreter& trabalhador = *trabalhadores[t];
+        Variavel& contadorLocal = trabalhador.buscarVariavel(paralelo.slotContador, paralelo.contador);
+        std::vector<Variavel*> reducoesLocais;
+        for (size_t r = 0; r < reducoes.size(); ++r) {
+            reducoesLocais.push_back(&trabalhador.buscarVariavel(paralelo.slotsReducoes[r], paralelo.reducoes[r]));
+        }
+        uint64_t trecho;
+        while (pegarTrecho(t, trecho)) {
+            if (trecho > trechoComErro.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            for (Variavel* reducao : reducoesLocais) {
+                reducao->valor = 0.0;
+            }
+            try {
+                for (uint64_t volta = inicioDoTrecho(trecho); volta < inicioDoTrecho(trecho + 1); ++volta) {
+                    contadorLocal.definida = true;
+                    if (contadorInteiro) {
+                        contadorLocal.inteira = true;
+                        contadorLocal.inteiro = static_cast<int64_t>(inicio) + static_cast<int64_t>(volta);
+                    } else {
+                        contadorLocal.valor = inicio + static_cast<double>(volta);
+                    }
+                    for (int index = paralelo.corpo; index < paralelo.next; ++index) {
+                        const auto& statement = programa->comandos[index];
+                        const auto* comando = static_cast<const NoDeComando*>(statement.get());
+                        for (int temporario : comando->temporariosDoBloco) {
+                            trabalhador.temporarios[temporario].valido = false;
+                        }
+                        SONDA_COMANDO(comando->numeroLinha.c_str(), index);
+                        trabalhador.executarComando(statement, programa);
+                    }
+                }
+            } catch (...) {
+                guardarErro(trecho);
+                continue;
+            }
+            for (size_t r = 0; r < reducoesLocais.size(); ++r) {
+                parciais[trecho * reducoes.size() + r] = reducoesLocais[r]->valor;
+            }
+        }
+    };
+    // Uma falha fora dos trechos (ex: memória ao preparar a thread) vale como a do trecho 0
+    auto executarThread = [&](unsigned t) {
+        try {
+            trabalhar(t);
+        } catch (...) {
+            guardarErro(0);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < numeroThreads; ++t) {
+        threads.emplace_back(executarThread, t);
+    }
+    if (numeroThreads > 0) {
+        executarThread(0);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (Vetor* vetor : compartilhados) {
+        vetor->compartilhar(false);
+    }
+    if (erro) {
+        std::rethrow_exception(erro);
+    }
+
+    contador.definida = true;
+    if (contadorInteiro) {
+        contador.inteira = true;
+        contador.inteiro = fimInteiro;
+    } else {
+        contador.valor = inicio + static_cast<double>(voltas);
+    }
+    for (size_t r = 0; r < reducoes.size(); ++r) {
+        for (uint64_t trecho = 0; trecho < numeroTrechos; ++trecho) {
+            reducoes[r]->valor += parciais[trecho * reducoes.size() + r];
+        }
+    }
+}
+
+bool Interpreter::verificarLaco(const NoDePrograma& programa, const LacoContado& laco) {
+    // A guarda não pode lançar erro: se algo não estiver definido, o laço roda com as verificações
+    // normais e o erro aparece no comando que realmente o causa
+    Variavel& contador = buscarVariavel(laco.slotContador, programa.simbolos->nome(laco.slotContador));
+    double limite;
+    if (auto numero = std::dynamic_pointer_cast<NoDeNumero>(laco.limite)) {
+        limite = numero->valor;
     } else {
-        // É uma variável. Vamos ver se ela existe e pegar seu valor
-        if (variables.find(variavel) == variables.end()) {
-            std::ostringstream oss;
-            oss << "Variavel indexadora nao existe: " << variavel << " >> " << indexador;
-            throw std::runtime_error(oss.str());
+        auto identificador = std::static_pointer_cast<NoDeIdentificador>(laco.limite);
+        Variavel& variavelLimite = buscarVariavel(identificador->slot, identificador->name);
+        if (!variavelLimite.definida || variavelLimite.vetor) {
+            return false;
+        }
+        limite = variavelLimite.inteira ? static_cast<double>(variavelLimite.inteiro) : variavelLimite.valor;
+    }
+    if (!contador.definida || contador.vetor) {
+        return false;
+    }
+    double inicial = contador.inteira ? static_cast<double>(contador.inteiro) : contador.valor;
+    // Faixa do contador antes e depois do incremento. O laço continua enquanto
+    // V < limite (passo positivo) ou V > limite (passo negativo), então os valores ficam entre
+    // o inicial e o limite, mais um passo depois do incremento. O arredondamento de V + passo
+    // é monotônico, então as contas abaixo limitam os valores realmente calculados.
+    double passo = laco.passo;
+    double antesMinimo = passo > 0 ? inicial : std::min(inicial, limite);
+    double antesMaximo = passo > 0 ? std::max(inicial, limite) : inicial;
+    double depoisMinimo = passo > 0 ? inicial + passo : std::min(inicial + passo, limite + passo);
+    double depoisMaximo = passo > 0 ? std::max(inicial + passo, limite + passo) : inicial + passo;
+    for (const auto& acesso : laco.acessos) {
+        Variavel& variavel = buscarVariavel(acesso.slotVetor, programa.simbolos->nome(acesso.slotVetor));
+        if (!variavel.vetor || acesso.dimensao >= variavel.vetor->dimensoes().size()) {
+            return false;
+        }
+        double tamanho = static_cast<double>(variavel.vetor->dimensoes()[acesso.dimensao]);
+        double minimo = (acesso.depoisDoIncremento ? depoisMinimo : antesMinimo) + acesso.deslocamento;
+        double maximo = (acesso.depoisDoIncremento ? depoisMaximo : antesMaximo) + acesso.deslocamento;
+        if (!(minimo >= 1 && maximo < tamanho + 1)) {
+            return false;
         }
-        if (vetores.find(indexador) != vetores.end()) {
+    }
+    return true;
+}
+
+uint64_t Interpreter::getPosicao(const std::string& variavel, const Vetor& vetor,
+                                 const std::vector<IndiceDeVetor>& indices) {
+    const std::vector<uint64_t>& dimensoes = vetor.dimensoes();
+    if (indices.size() != dimensoes.size()) {
+        std::ostringstream oss;
+        oss << "Numero de indices invalido para o vetor: " << variavel << " tem " << dimensoes.size()
+            << " dimensoes";
+        throw std::runtime_error(oss.str());
+    }
+    // Ordem por linha: posicao = ((i1 * d2) + i2) * d3 + i3 ..., calculada em uma passada
+    uint64_t posicao = 0;
+    for (size_t k = 0; k < indices.size(); ++k) {
+        const IndiceDeVetor& indice = indices[k];
+        // Literais já foram validados na carga, e índices do contador pela guarda do laço
+        bool verificado = indice.verificado
+                          || (indice.laco >= 0 && indice.laco < static_cast<int>(estadoLacos.size())
+                              && estadoLacos[indice.laco] == 1);
+        if (static_cast<const NoDeExpressao*>(indice.expressao.get())->inteira) {
+            // Índice inteiro (I%): sem passar por double
+            int64_t inteiro = avaliarInteiro(indice.expressao);
+            if (!verificado && !(inteiro >= 1 && static_cast<uint64_t>(inteiro) <= dimensoes[k])) {
+                std::ostringstream oss;
+                oss << "Posicao invalida para o vetor: " << variavel << " >> " << inteiro;
+                throw std::runtime_error(oss.str());
+            }
+            posicao = posicao * dimensoes[k] + (static_cast<uint64_t>(inteiro) - 1);
+            continue;
+        }
+        // A posição é tratada como double até ser validada: vetores podem passar de 2^31 posições
+        double valor = avaliarExpressao(indice.expressao);
+        // Como antes, a parte fracionária é descartada; a comparação em double também rejeita NaN
+        if (!verificado && !(valor >= 1 && valor < static_cast<double>(dimensoes[k]) + 1)) {
             std::ostringstream oss;
-            oss << "Variavel indexadora nao pode ser um vetor: " << variavel << " >> " << indexador;
+            oss << "Posicao invalida para o vetor: " << variavel << " >> " << valor;
             throw std::runtime_error(oss.str());
         }
-        valor = variables[indexador].at(0);
+        posicao = posicao * dimensoes[k] + (static_cast<uint64_t>(valor) - 1); // No C++ os vetores são zero based.
     }
-    if (valor <= 0 || valor > vetores[variavel]) {
+    return posicao;
+}
+
+
+int64_t Interpreter::paraInteiro(double valor) {
+    // -2^63 <= valor < 2^63; a comparação também rejeita NaN
+    if (!(valor >= -9223372036854775808.0 && valor < 9223372036854775808.0)) {
         std::ostringstream oss;
-        oss << "Posicao invalida para o vetor: " << variavel << " >> " << indexador;
+        oss << "Valor fora da faixa de inteiro: " << valor;
         throw std::runtime_error(oss.str());
     }
-    return valor - 1; // No C++ os vetores são zero based.
+    return static_cast<int64_t>(valor);
 }
 
+int64_t Interpreter::avaliarInteiro(const std::shared_ptr<NoDaAST>& expressao) {
+    auto* no = static_cast<NoDeExpressao*>(expressao.get());
+    uint8_t especializacao = no->formaInteira.load(std::memory_order_relaxed);
+    if (especializacao == 0) {
+        especializacao = especializarInteira(*no);
+        no->formaInteira.store(especializacao, std::memory_order_relaxed);
+    }
+    switch (especializacao >> 3) {
+        case FORMA_NUMERO:
+            return static_cast<NoDeNumero*>(no)->inteiro;
+        case FORMA_VARIAVEL: {
+            auto* identificador = static_cast<NoDeIdentificador*>(no);
+            const Variavel& variavel = buscarVariavel(identificador->slot, identificador->name);
+            if (variavel.definida) {
+                return variavel.inteiro;
+            }
+            break;
+        }
+        case FORMA_TEMPORARIO: {
+            auto* temporario = static_cast<NoDeTemporario*>(no);
+            if (temporario->indice < static_cast<int>(temporarios.size())) {
+                ValorTemporario& valor = temporarios[temporario->indice];
+                if (!valor.valido) {
+                    valor.inteiro = avaliarInteiro(temporario->expressao);
+                    valor.valido = true;
+                }
+                return valor.inteiro;
+            }
+            break;
+        }
+        case FORMA_BINARIA: {
+            auto* binaria = static_cast<NoDeExpressaoBinaria*>(no);
+            int64_t left = avaliarInteiro(binaria->left);
+            int64_t right = avaliarInteiro(binaria->right);
+            int64_t resultado = 0;
+            bool estouro;
+            switch (especializacao & 7) {
+                case SOMA: estouro = __builtin_add_overflow(left, right, &resultado); break;
+                case SUBTRACAO: estouro = __builtin_sub_overflow(left, right, &resultado); break;
+                default: estouro = __builtin_mul_overflow(left, right, &resultado); break;
+            }
+            if (estouro) {
+                std::ostringstream oss;
+                oss << "Estouro de inteiro: " << left << " " << binaria->op << " " << right;
+                throw std::runtime_error(oss.str());
+            }
+            return resultado;
+        }
+    }
+    return avaliarInteiroGeral(expressao);
+}
 
-double Interpreter::avaliarExpressao(const std::shared_ptr<NoDaAST>& expressao) {
+int64_t Interpreter::avaliarInteiroGeral(const std::shared_ptr<NoDaAST>& expressao) {
     if (auto numberNode = std::dynamic_pointer_cast<NoDeNumero>(expressao)) {
-        return std::stod(numberNode->value);
+        // O Resolvedor só marca como inteiros os literais que cabem em 64 bits
+        int64_t valor = 0;
+        std::from_chars(numberNode->value.data(), numberNode->value.data() + numberNode->value.size(), valor);
+        return valor;
     } else if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
-        if (variables.find(identifierNode->name) != variables.end()) {
-            if (vetores.find(identifierNode->name) != vetores.end()) {
-                if (identifierNode->posicao.empty()) {
-                    std::ostringstream oss;
-                    oss << "Variavel deveria ser indexada pois e um vetor: " << identifierNode->name;
-                    throw std::runtime_error(oss.str());
-                } else {
-                    int posicao = getPosicao(identifierNode->name, identifierNode->posicao);
-                    return variables[identifierNode->name].at(posicao);
+        Variavel& variavel = buscarVariavel(identifierNode->slot, identifierNode->name);
+        if (!variavel.definida) {
+            throw std::runtime_error("Variável não declarada: " + identifierNode->name);
+        }
+        return variavel.inteiro;
+    } else if (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+        if (temporario->indice >= static_cast<int>(temporarios.size())) {
+            // Avaliação fora de executar: os temporários ainda não foram dimensionados
+            return avaliarInteiro(temporario->expressao);
+        }
+        ValorTemporario& valor = temporarios[temporario->indice];
+        if (!valor.valido) {
+            valor.inteiro = avaliarInteiro(temporario->expressao);
+            valor.valido = true;
+        }
+        return valor.inteiro;
+    } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+        int64_t left = avaliarInteiro(binaryExpr->left);
+        int64_t right = avaliarInteiro(binaryExpr->right);
+        int64_t resultado = 0;
+        bool estouro;
+        if (binaryExpr->op == "+") {
+            estouro = __builtin_add_overflow(left, right, &resultado);
+        } else if (binaryExpr->op == "-") {
+            estouro = __builtin_sub_overflow(left, right, &resultado);
+        } else {
+            estouro = __builtin_mul_overflow(left, right, &resultado);
+        }
+        if (estouro) {
+            std::ostringstream oss;
+            oss << "Estouro de inteiro: " << left << " " << binaryExpr->op << " " << right;
+            throw std::runtime_error(oss.str());
+        }
+        return resultado;
+    }
+    throw std::runtime_error("Tipo de expressão inesperado");
+}
+
+double Interpreter::avaliarExpressao(const std::shared_ptr<NoDaAST>& expressao) {
+    auto* no = static_cast<NoDeExpressao*>(expressao.get());
+    uint8_t especializacao = no->formaReal.load(std::memory_order_relaxed);
+    if (especializacao == 0) {
+        especializacao = especializarReal(*no);
+        no->formaReal.store(especializacao, std::memory_order_relaxed);
+    }
+    uint8_t operacao = especializacao & 7;
+    switch (especializacao >> 3) {
+        case FORMA_INTEIRA:
+            return static_cast<double>(avaliarInteiro(expressao));
+        case FORMA_NUMERO:
+            return static_cast<NoDeNumero*>(no)->valor;
+        case FORMA_VARIAVEL: {
+            auto* identificador = static_cast<NoDeIdentificador*>(no);
+            const Variavel& variavel = buscarVariavel(identificador->slot, identificador->name);
+            if (!variavel.vetor && variavel.definida) {
+                return variavel.valor;
+            }
+            break;
+        }
+        case FORMA_VETOR: {
+            auto* identificador = static_cast<NoDeIdentificador*>(no);
+            Variavel& variavel = buscarVariavel(identificador->slot, identificador->name);
+            if (variavel.vetor) {
+                return variavel.vetor->ler(getPosicao(identificador->name, *variavel.vetor, identificador->indices));
+            }
+            break;
+        }
+        case FORMA_TEMPORARIO: {
+            auto* temporario = static_cast<NoDeTemporario*>(no);
+            if (temporario->indice < static_cast<int>(temporarios.size())) {
+                ValorTemporario& valor = temporarios[temporario->indice];
+                if (!valor.valido) {
+                    valor.real = avaliarExpressao(temporario->expressao);
+                    valor.valido = true;
                 }
-            } else {
-                return variables[identifierNode->name].at(0);
+                return valor.real;
             }
+            break;
+        }
+        case FORMA_BINARIA: {
+            auto* binaria = static_cast<NoDeExpressaoBinaria*>(no);
+            double left = avaliarExpressao(binaria->left);
+            double right = avaliarExpressao(binaria->right);
+            return aplicar(operacao, left, right);
+        }
+        case FORMA_VARIAVEL_CONSTANTE: {
+            auto* binaria = static_cast<NoDeExpressaoBinaria*>(no);
+            auto* identificador = static_cast<NoDeIdentificador*>(binaria->left.get());
+            const Variavel& variavel = buscarVariavel(identificador->slot, identificador->name);
+            if (!variavel.vetor && variavel.definida) {
+                return aplicar(operacao, variavel.valor, static_cast<NoDeNumero*>(binaria->right.get())->valor);
+            }
+            // O nome virou vetor (DIM) ou não foi definido: volta à forma geral da operação
+            no->formaReal.store(forma(FORMA_BINARIA, operacao), std::memory_order_relaxed);
+            return avaliarExpressao(expressao);
+        }
+        case FORMA_VARIAVEL_VARIAVEL: {
+            auto* binaria = static_cast<NoDeExpressaoBinaria*>(no);
+            auto* esquerda = static_cast<NoDeIdentificador*>(binaria->left.get());
+            auto* direita = static_cast<NoDeIdentificador*>(binaria->right.get());
+            const Variavel& left = buscarVariavel(esquerda->slot, esquerda->name);
+            const Variavel& right = buscarVariavel(direita->slot, direita->name);
+            if (!left.vetor && left.definida && !right.vetor && right.definida) {
+                return aplicar(operacao, left.valor, right.valor);
+            }
+            no->formaReal.store(forma(FORMA_BINARIA, operacao), std::memory_order_relaxed);
+            return avaliarExpressao(expressao);
+        }
+        case FORMA_FUNCAO:
+            return calcularFuncao(operacao, avaliarExpressao(static_cast<NoDeFuncao*>(no)->argumentos[0]));
+    }
+    return avaliarExpressaoGeral(expressao);
+}
+
+double Interpreter::avaliarExpressaoGeral(const std::shared_ptr<NoDaAST>& expressao) {
+    if (static_cast<const NoDeExpressao*>(expressao.get())->inteira) {
+        // Expressão inteira dentro de uma expressão real: promovida aqui
+        return static_cast<double>(avaliarInteiro(expressao));
+    }
+    if (auto numberNode = std::dynamic_pointer_cast<NoDeNumero>(expressao)) {
+        return numberNode->valor;
+    } else if (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+        if (temporario->indice >= static_cast<int>(temporarios.size())) {
+            // Avaliação fora de executar: os temporários ainda não foram dimensionados
+            return avaliarExpressao(temporario->expressao);
+        }
+        ValorTemporario& valor = temporarios[temporario->indice];
+        if (!valor.valido) {
+            valor.real = avaliarExpressao(temporario->expressao);
+            valor.valido = true;
+        }
+        return valor.real;
+    } else if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+        Variavel& variavel = buscarVariavel(identifierNode->slot, identifierNode->name);
+        if (variavel.vetor) {
+            if (identifierNode->indices.empty()) {
+                std::ostringstream oss;
+                oss << "Variavel deveria ser indexada pois e um vetor: " << identifierNode->name;
+                throw std::runtime_error(oss.str());
+            }
+            uint64_t posicao = getPosicao(identifierNode->name, *variavel.vetor, identifierNode->indices);
+            return variavel.vetor->ler(posicao);
+        }
+        if (variavel.definida) {
+            return variavel.valor;
         } else {
             throw std::runtime_error("Variável não declarada: " + identifierNode->name);
         }
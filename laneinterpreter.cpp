@@ -0,0 +1,253 @@
+#include "LaneInterpreter.h"
+#include "Interpreter.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    // As lanes não podem continuar juntas a partir deste comando
+    struct Divergencia {};
+}
+
+template<int N>
+LaneInterpreter<N>::LaneInterpreter(std::array<Lane, N>& lanes) : lanes(lanes) {}
+
+template<int N>
+void LaneInterpreter<N>::executar(const std::shared_ptr<NoDePrograma>& programa) {
+    if (programa->usaInteiros) {
+        // Variáveis I% (aritmética inteira com verificação de estouro) ficam com o Interpreter escalar
+        dividir(programa, 0);
+        return;
+    }
+    int index = 0;
+    while (index < static_cast<int>(programa->comandos.size())) {
+        int newIndex;
+        try {
+            newIndex = executarComando(programa->comandos[index], programa);
+        } catch (const Divergencia&) {
+            dividir(programa, index);
+            return;
+        } catch (const std::exception&) {
+            // O erro pode ocorrer em apenas algumas lanes. Os comandos só alteram o estado
+            // depois de avaliar todas as lanes, então o Interpreter escalar refaz o comando
+            // e reporta o erro somente nas lanes onde ele realmente acontece.
+            dividir(programa, index);
+            return;
+        }
+        if (newIndex >= 0) {
+            index = newIndex;
+            continue;
+        } else if (newIndex == -2) {
+            break;
+        }
+        ++index;
+    }
+}
+
+template<int N>
+void LaneInterpreter<N>::dividir(const std::shared_ptr<NoDePrograma>& programa, int index) {
+    for (int lane = 0; lane < N; ++lane) {
+        Interpreter interpreter(lanes[lane].basicScriptName, *lanes[lane].saida, lanes[lane].entrada);
+        interpreter.definirThreadsParalelas(1);
+        for (const auto& [nome, valor] : variables) {
+            interpreter.definirVariavel(nome, valor[lane]);
+        }
+        for (const auto& [nome, elementos] : vetores) {
+            std::vector<double> valores(elementos.size());
+            for (size_t i = 0; i < elementos.size(); ++i) {
+                valores[i] = elementos[i][lane];
+            }
+            interpreter.definirVetor(nome, std::move(valores));
+        }
+        try {
+            interpreter.executar(programa, index);
+        } catch (const std::exception& e) {
+            lanes[lane].erro = e.what();
+        }
+    }
+}
+
+template<int N>
+int LaneInterpreter<N>::executarComando(const std::shared_ptr<NoDaAST>& comando, const std::shared_ptr<NoDePrograma>& programa) {
+    if (auto letStmt = std::dynamic_pointer_cast<NoDoComandoLET>(comando)) {
+        Lanes value = avaliarExpressao(letStmt->expressao);
+        if (letStmt->indices.empty()) {
+            if (vetores.find(letStmt->identificador) != vetores.end()) {
+                throw Divergencia();
+            }
+            variables[letStmt->identificador] = value;
+        } else {
+            auto vetor = vetores.find(letStmt->identificador);
+            if (vetor == vetores.end() || letStmt->indices.size() != 1) {
+                throw Divergencia();
+            }
+            std::array<uint64_t, N> posicao = getPosicao(vetor->second, letStmt->indices[0].expressao);
+            for (int lane = 0; lane < N; ++lane) {
+                vetor->second[posicao[lane]][lane] = value[lane];
+            }
+        }
+    } else if (auto printStmt = std::dynamic_pointer_cast<NoDoComandoPRINT>(comando)) {
+        if (printStmt->printLiteral) {
+            for (int lane = 0; lane < N; ++lane) {
+                *lanes[lane].saida << printStmt->literal << std::endl;
+            }
+        } else {
+            Lanes value = avaliarExpressao(printStmt->expressao);
+            for (int lane = 0; lane < N; ++lane) {
+                *lanes[lane].saida << value[lane] << std::endl;
+            }
+        }
+    } else if (auto gotoStmt = std::dynamic_pointer_cast<NoDoComandoGOTO>(comando)) {
+        int index = programa->indiceDaLinha(gotoStmt->numeroLinhaDesvio);
+        if (index >= 0) {
+            return index;
+        }
+        throw Divergencia();
+    } else if (auto dimStmt = std::dynamic_pointer_cast<NoDoComandoDIM>(comando)) {
+        if (variables.find(dimStmt->nomeVariavel) != variables.end()
+            || vetores.find(dimStmt->nomeVariavel) != vetores.end() || !dimStmt->arquivo.empty()
+            || dimStmt->dimensoes.size() != 1 || dimStmt->numeroOcorrencias >= Vetor::limiteEsparso
+            || dimStmt->tipo != TipoDeElemento::DOUBLE) {
+            // Vetores em arquivo, esparsos, compactos ou com várias dimensões ficam com o Interpreter escalar
+            throw Divergencia();
+        }
+        vetores[dimStmt->nomeVariavel] = std::vector<Lanes>(dimStmt->numeroOcorrencias, Lanes{});
+    } else if (auto endStmt = std::dynamic_pointer_cast<NoDoComandoEND>(comando)) {
+        for (int lane = 0; lane < N; ++lane) {
+            *lanes[lane].saida << "Comando END" << std::endl;
+        }
+        return -2;
+    } else if (auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(comando)) {
+        Lanes operando1 = avaliarExpressao(ifStmt->operando1);
+        Lanes operando2 = avaliarExpressao(ifStmt->operando2);
+        // Máscara da condição: quantas lanes desviam
+        int verdadeiras = 0;
+        for (int lane = 0; lane < N; ++lane) {
+            double resultado = operando1[lane] - operando2[lane];
+            bool trueFalse;
+            if (ifStmt->operadorLogico == "=") {
+                trueFalse = resultado == 0;
+            } else if (ifStmt->operadorLogico == ">") {
+                trueFalse = resultado > 0;
+            } else {
+                trueFalse = resultado < 0;
+            }
+            verdadeiras += trueFalse ? 1 : 0;
+        }
+        if (verdadeiras != 0 && verdadeiras != N) {
+            throw Divergencia();
+        }
+        if (verdadeiras == N) {
+            return programa->indiceDaLinha(ifStmt->numeroLinha);
+        }
+        return -1;
+    } else if (auto inputStmt = std::dynamic_pointer_cast<NoDoComandoINPUT>(comando)) {
+        if (vetores.find(inputStmt->identificador) != vetores.end()) {
+            throw Divergencia();
+        }
+        for (int lane = 0; lane < N; ++lane) {
+            if (lanes[lane].entrada->restantes() == 0) {
+                throw Divergencia();
+            }
+        }
+        Lanes valor;
+        for (int lane = 0; lane < N; ++lane) {
+            valor[lane] = lanes[lane].entrada->lerValor();
+        }
+        variables[inputStmt->identificador] = valor;
+    } else {
+        // Comandos de desenho e futuros comandos seguem no Interpreter escalar
+        throw Divergencia();
+    }
+    return -1;
+}
+
+template<int N>
+std::array<uint64_t, N> LaneInterpreter<N>::getPosicao(const std::vector<Lanes>& vetor, const NoDaASTPtr& indice) {
+    // O índice é uma expressão: cada lane pode acessar uma posição diferente
+    Lanes valor = avaliarExpressao(indice);
+    double tamanho = static_cast<double>(vetor.size());
+    std::array<uint64_t, N> posicao;
+    for (int lane = 0; lane < N; ++lane) {
+        if (!(valor[lane] >= 1 && valor[lane] < tamanho + 1)) {
+            throw Divergencia();
+        }
+        posicao[lane] = static_cast<uint64_t>(valor[lane]) - 1;
+    }
+    return posicao;
+}
+
+template<int N>
+typename LaneInterpreter<N>::Lanes LaneInterpreter<N>::avaliarExpressao(const std::shared_ptr<NoDaAST>& expressao) {
+    Lanes resultado;
+    if (auto numberNode = std::dynamic_pointer_cast<NoDeNumero>(expressao)) {
+        resultado.fill(numberNode->valor);
+        return resultado;
+    } else if (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+        // Temporários não são guardados por lane: a subexpressão é avaliada de novo
+        return avaliarExpressao(temporario->expressao);
+    } else if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+        auto variavel = variables.find(identifierNode->name);
+        if (variavel != variables.end()) {
+            return variavel->second;
+        }
+        auto vetor = vetores.find(identifierNode->name);
+        if (vetor == vetores.end() || identifierNode->indices.size() != 1) {
+            throw Divergencia();
+        }
+        std::array<uint64_t, N> posicao = getPosicao(vetor->second, identifierNode->indices[0].expressao);
+        for (int lane = 0; lane < N; ++lane) {
+            resultado[lane] = vetor->second[posicao[lane]][lane];
+        }
+        return resultado;
+    } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+        Lanes left = avaliarExpressao(binaryExpr->left);
+        Lanes right = avaliarExpressao(binaryExpr->right);
+        if (binaryExpr->op == "+") {
+            for (int lane = 0; lane < N; ++lane) resultado[lane] = left[lane] + right[lane];
+        } else if (binaryExpr->op == "-") {
+            for (int lane = 0; lane < N; ++lane) resultado[lane] = left[lane] - right[lane];
+        } else if (binaryExpr->op == "*") {
+            for (int lane = 0; lane < N; ++lane) resultado[lane] = left[lane] * right[lane];
+        } else if (binaryExpr->op == "/") {
+            for (int lane = 0; lane < N; ++lane) resultado[lane] = left[lane] / right[lane];
+        } else if (binaryExpr->op == "^") {
+            for (int lane = 0; lane < N; ++lane) resultado[lane] = std::pow(left[lane], right[lane]);
+        } else {
+            throw Divergencia();
+        }
+        return resultado;
+    } else if (auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao)) {
+        if (!functionCall->argumentos.empty()) {
+            Lanes argument = avaliarExpressao(functionCall->argumentos[0]);
+            for (int lane = 0; lane < N; ++lane) {
+                resultado[lane] = Interpreter::processarFuncao(functionCall->nomeDaFuncao, argument[lane]);
+            }
+        } else {
+            for (int lane = 0; lane < N; ++lane) {
+                resultado[lane] = Interpreter::processarFuncao(functionCall->nomeDaFuncao, 0.0, false);
+            }
+        }
+        return resultado;
+    }
+    throw Divergencia();
+}
+
+template class LaneInterpreter<4>;
+template class LaneInterpreter<8>;
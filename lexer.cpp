@@ -1,7 +1,17 @@
 #include "Lexer.h"
-#include <sstream>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
 #include "util.h"
 
+// SIBASIC_SEM_SSE2 força a varredura um a um mesmo onde há SSE2 (ver sibasic_teste_lexer_sem_sse2)
+#if defined(__SSE2__) && !defined(SIBASIC_SEM_SSE2)
+#define SIBASIC_LEXER_SSE2
+#include <emmintrin.h>
+#endif
+
 /*
 Copyright 2024 Cleuton Sampaio de Melo Junir
 
@@ -18,6 +28,167 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+namespace {
+    // Palavras reservadas e operadores classificados por tabelas montadas na compilação: o
+    // Lexer não monta nada ao ser construído e classificar uma palavra não aloca memória.
+    enum class Classe : uint8_t { NENHUMA, COMANDO, FUNCAO };
+
+    struct Reservada {
+        std::string_view texto;
+        Classe classe;
+    };
+
+    constexpr Reservada reservadas[] = {
+        {"DIM", Classe::COMANDO}, {"END", Classe::COMANDO}, {"LET", Classe::COMANDO}, {"PRINT", Classe::COMANDO},
+        {"GOTO", Classe::COMANDO}, {"IF", Classe::COMANDO}, {"INPUT", Classe::COMANDO}, {"DRAW", Classe::COMANDO},
+        {"PLOT", Classe::COMANDO}, {"LINE", Classe::COMANDO}, {"RECTANGLE", Classe::COMANDO},
+        {"CHECKPOINT", Classe::COMANDO}, {"LOAD", Classe::COMANDO}, {"SAVE", Classe::COMANDO},
+        {"PARALLEL", Classe::COMANDO}, {"NEXT", Classe::COMANDO},
+        {"EXP", Classe::FUNCAO}, {"ABS", Classe::FUNCAO}, {"LOG", Classe::FUNCAO}, {"SIN", Classe::FUNCAO},
+        {"COS", Classe::FUNCAO}, {"TAN", Classe::FUNCAO}, {"SQR", Classe::FUNCAO}, {"RND", Classe::FUNCAO},
+    };
+    constexpr size_t numeroReservadas = sizeof(reservadas) / sizeof(reservadas[0]);
+
+    // Hash perfeito: primeira letra, última letra e tamanho, com um multiplicador escolhido na
+    // compilação para que nenhuma palavra reservada colida com outra
+    constexpr size_t tamanhoDaTabela = 64;
+
+    constexpr size_t espalhar(std::string_view palavra, uint32_t multiplicador) {
+        uint32_t h = static_cast<uint8_t>(palavra[0]) * multiplicador
+                     + static_cast<uint8_t>(palavra[palavra.size() - 1]) * 31u + static_cast<uint32_t>(palavra.size());
+        return (h ^ (h >> 7)) % tamanhoDaTabela;
+    }
+
+    constexpr bool semColisao(uint32_t multiplicador) {
+        std::array<bool, tamanhoDaTabela> ocupada{};
+        for (size_t k = 0; k < numeroReservadas; ++k) {
+            size_t posicao = espalhar(reservadas[k].texto, multiplicador);
+            if (ocupada[posicao]) {
+                return false;
+            }
+            ocupada[posicao] = true;
+        }
+        return true;
+    }
+
+    constexpr uint32_t escolherMultiplicador() {
+        for (uint32_t multiplicador = 1; multiplicador < 100000; ++multiplicador) {
+            if (semColisao(multiplicador)) {
+                return multiplicador;
+            }
+        }
+        return 0;
+    }
+
+    constexpr uint32_t multiplicador = escolherMultiplicador();
+    static_assert(multiplicador != 0, "Nenhum hash perfeito para as palavras reservadas: aumente tamanhoDaTabela");
+
+    // Posição em "reservadas" (+1) de cada entrada da tabela de hash; 0 é vazio
+    constexpr std::array<uint8_t, tamanhoDaTabela> montarTabelaDePalavras() {
+        std::array<uint8_t, tamanhoDaTabela> tabela{};
+        for (size_t k = 0; k < numeroReservadas; ++k) {
+            tabela[espalhar(reservadas[k].texto, multiplicador)] = static_cast<uint8_t>(k + 1);
+        }
+        return tabela;
+    }
+
+    constexpr std::array<uint8_t, tamanhoDaTabela> tabelaDePalavras = montarTabelaDePalavras();
+
+    constexpr Classe classificar(std::string_view palavra) {
+        if (palavra.empty()) {
+            return Classe::NENHUMA;
+        }
+        uint8_t entrada = tabelaDePalavras[espalhar(palavra, multiplicador)];
+        // Uma palavra qualquer pode cair na posição de uma reservada: o texto confirma
+        if (entrada == 0 || reservadas[entrada - 1].texto != palavra) {
+            return Classe::NENHUMA;
+        }
+        return reservadas[entrada - 1].classe;
+    }
+
+    static_assert(classificar("CHECKPOINT") == Classe::COMANDO && classificar("RND") == Classe::FUNCAO
+                  && classificar("X") == Classe::NENHUMA && classificar("PRINTX") == Classe::NENHUMA);
+
+    constexpr std::array<bool, 256> montarTabelaDeOperadores() {
+        std::array<bool, 256> tabela{};
+        for (char c : std::string_view("+-*/^><=!")) {
+            tabela[static_cast<uint8_t>(c)] = true;
+        }
+        return tabela;
+    }
+
+    constexpr std::array<bool, 256> operadores = montarTabelaDeOperadores();
+
+    // Classes de caracteres só ASCII, sem depender do locale (isspace/isalpha recebem int e
+    // têm comportamento indefinido com char negativo)
+    constexpr bool ehEspaco(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    constexpr bool ehDigito(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    constexpr bool ehLetra(char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    }
+
+    enum class Varredura { ESPACO, ALFANUMERICO, NUMERO };
+
+    template <Varredura classe>
+    constexpr bool pertence(char c) {
+        if constexpr (classe == Varredura::ESPACO) {
+            return ehEspaco(c);
+        } else if constexpr (classe == Varredura::ALFANUMERICO) {
+            return ehLetra(c) || ehDigito(c);
+        } else {
+            return ehDigito(c) || c == '.';
+        }
+    }
+
+#if defined(SIBASIC_LEXER_SSE2)
+    // Bytes de "bloco" entre "menor" e "maior" (inclusive). Todos os limites são ASCII, então a
+    // comparação com sinal do SSE2 não confunde bytes acima de 127 (negativos) com eles
+    inline __m128i naFaixa(__m128i bloco, char menor, char maior) {
+        return _mm_and_si128(_mm_cmpgt_epi8(bloco, _mm_set1_epi8(static_cast<char>(menor - 1))),
+                             _mm_cmplt_epi8(bloco, _mm_set1_epi8(static_cast<char>(maior + 1))));
+    }
+
+    template <Varredura classe>
+    inline __m128i mascara(__m128i bloco) {
+        if constexpr (classe == Varredura::ESPACO) {
+            return _mm_or_si128(_mm_cmpeq_epi8(bloco, _mm_set1_epi8(' ')), naFaixa(bloco, '\t', '\r'));
+        } else if constexpr (classe == Varredura::ALFANUMERICO) {
+            return _mm_or_si128(_mm_or_si128(naFaixa(bloco, 'A', 'Z'), naFaixa(bloco, 'a', 'z')),
+                                naFaixa(bloco, '0', '9'));
+        } else {
+            return _mm_or_si128(naFaixa(bloco, '0', '9'), _mm_cmpeq_epi8(bloco, _mm_set1_epi8('.')));
+        }
+    }
+#endif
+
+    // Primeira posição a partir de "pos" cujo caractere não pertence à classe. Com SSE2 examina
+    // 16 bytes por vez enquanto couberem no texto; o resto (e máquinas sem SSE2) vai um a um
+    template <Varredura classe>
+    size_t avancar(std::string_view texto, size_t pos) {
+        const size_t n = texto.size();
+#if defined(SIBASIC_LEXER_SSE2)
+        while (pos + 16 <= n) {
+            __m128i bloco = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texto.data() + pos));
+            unsigned fora = ~static_cast<unsigned>(_mm_movemask_epi8(mascara<classe>(bloco))) & 0xFFFFu;
+            if (fora != 0) {
+                return pos + static_cast<size_t>(__builtin_ctz(fora));
+            }
+            pos += 16;
+        }
+#endif
+        while (pos < n && pertence<classe>(texto[pos])) {
+            ++pos;
+        }
+        return pos;
+    }
+}
+
 LexerException::LexerException(const std::string& message, const std::string& basicLineNumber, const std::string& instruction)
     : message("Line " + basicLineNumber + ": " + message + " - \"" + instruction + "\"") {}
 
@@ -25,11 +196,7 @@ const char* LexerException::what() const noexcept {
     return message.c_str();
 }
 
-Lexer::Lexer()
-    : comandos({{"DIM", true}, {"END", true}, {"LET", true}, {"PRINT", true}, {"GOTO", true}, {"IF", true}, {"INPUT", true},
-                {"DRAW", true}, {"PLOT", true}, {"LINE", true}, {"RECTANGLE", true}}),
-      funcoes({{"EXP", true}, {"ABS", true}, {"LOG", true}, {"SIN", true}, {"COS", true}, {"TAN", true}, {"SQR", true}, {"RND", true}}),
-      operadores({{'+', true}, {'-', true}, {'*', true}, {'/', true}, {'^', true}, {'>', true}, {'<', true}, {'=', true}, {'!', true}}) {}
+Lexer::Lexer() : pos(0), length(0) {}
 
 
 
@@ -38,23 +205,26 @@ std::vector<Token> Lexer::tokenize(const std::string& input) {
     this->pos = 0;
     this->length = input.length();
     this->input = input;
+    const std::string_view texto(input);
     bool trocarUnaryMinus = false;
     while (pos < length) {
-        if (isspace(input[pos])) {
-            pos++;
+        if (ehEspaco(input[pos])) {
+            pos = avancar<Varredura::ESPACO>(texto, pos);
             continue;
         }
 
         if (pos == 0) {
             trocarUnaryMinus = false;
-            std::istringstream lineStream(input);
-            std::string basicLineNumber;
-            lineStream >> basicLineNumber;
+            size_t fim = 0;
+            while (fim < length && !ehEspaco(input[fim])) {
+                ++fim;
+            }
+            std::string basicLineNumber = input.substr(0, fim);
             if (!isNumeric(basicLineNumber)) {
                 throw LexerException("Linha sem numero: " + std::string(1, input[pos]), basicLineNumber, input);
             }
             tokens.push_back({NUMERO_LINHA, basicLineNumber});
-            pos += basicLineNumber.length();
+            pos = fim;
             continue;
         }
 
@@ -62,24 +232,39 @@ std::vector<Token> Lexer::tokenize(const std::string& input) {
             // inicio de literal
             trocarUnaryMinus = false;
             pos++;
-            std::string literal = lerEnquanto([](int c) { return c != '\"'; });
-            if (pos<input.length()) {
-                pos++;
-            }
+            const void* aspas = std::memchr(input.data() + pos, '\"', length - pos);
+            size_t fim = aspas != nullptr ? static_cast<size_t>(static_cast<const char*>(aspas) - input.data()) : length;
+            std::string literal = input.substr(pos, fim - pos);
+            pos = fim < length ? fim + 1 : length;
             tokens.push_back({LITERAL_TEXTO, literal});
-        } else if (isalpha(input[pos])) {
+        } else if (ehLetra(input[pos])) {
             trocarUnaryMinus = false;
-            std::string word = lerEnquanto([](int c) { return std::isalnum(c); });
-            if (comandos.count(word)) {
+            size_t fim = avancar<Varredura::ALFANUMERICO>(texto, pos);
+            std::string word = input.substr(pos, fim - pos);
+            pos = fim;
+            Classe classe = classificar(word);
+            if (classe == Classe::COMANDO) {
                 tokens.push_back({COMANDO, word});
-            } else if (funcoes.count(word)) {
+            } else if (classe == Classe::FUNCAO) {
                 tokens.push_back({FUNCAO, word});
             } else {
+                if (pos < length && input[pos] == '%') {
+                    // Sufixo de variável inteira: I%
+                    word += input[pos++];
+                }
                 tokens.push_back({IDENTIFICADOR, word});
             }
-        } else if (isdigit(input[pos]) || input[pos] == '.') {
+        } else if (ehDigito(input[pos]) || input[pos] == '.') {
             trocarUnaryMinus = false;
-            tokens.push_back({NUMERO, lerEnquanto([](int c) { return std::isdigit(c) || c == '.'; })});
+            size_t fim = avancar<Varredura::NUMERO>(texto, pos);
+            // Convertido uma vez aqui: o interpretador usa o valor pronto (NoDeNumero::valor)
+            double valor = 0.0;
+            auto [lido, erro] = std::from_chars(input.data() + pos, input.data() + fim, valor);
+            if (erro != std::errc() || lido != input.data() + fim) {
+                throw LexerException("Número inválido: " + input.substr(pos, fim - pos), numeroDeLinhaBasic, input);
+            }
+            tokens.push_back({NUMERO, input.substr(pos, fim - pos), valor});
+            pos = fim;
         } else if (input[pos] == '(') {
             trocarUnaryMinus = true;
             tokens.push_back({PARENTESIS_ESQUERDO, "("});
@@ -89,7 +274,8 @@ std::vector<Token> Lexer::tokenize(const std::string& input) {
             tokens.push_back({PARENTESIS_DIREITO, ")"});
             pos++;
         } else if (input[pos] == '[') {
-            trocarUnaryMinus = false;
+            // Os índices são expressões: A[-I + 3]
+            trocarUnaryMinus = true;
             tokens.push_back({CHAVE_ESQUERDA, "["});
             pos++;
         } else if (input[pos] == ']') {
@@ -97,20 +283,20 @@ std::vector<Token> Lexer::tokenize(const std::string& input) {
             tokens.push_back({CHAVE_DIREITA, "]"});
             pos++;
         } else if (input[pos] == ',') {
-            trocarUnaryMinus = false;
+            trocarUnaryMinus = true;
             tokens.push_back({VIRGULA, ","});
             pos++;
         } else if (input[pos] == '"') {
             trocarUnaryMinus = false;
             tokens.push_back({ASPAS_DUPLAS, "\""});
             pos++;
-        } else if (operadores.count(input[pos])) {
+        } else if (operadores[static_cast<uint8_t>(input[pos])]) {
             if (trocarUnaryMinus && input[pos] == '-') {
                 // Vamos trocar por "-1 *"
                 tokens.push_back({PARENTESIS_ESQUERDO, "("});
-                tokens.push_back({NUMERO, "1"});
+                tokens.push_back({NUMERO, "1", 1.0});
                 tokens.push_back({OPERADOR, "-"});
-                tokens.push_back({NUMERO, "2"});
+                tokens.push_back({NUMERO, "2", 2.0});
                 tokens.push_back({PARENTESIS_DIREITO, ")"});
                 tokens.push_back({OPERADOR, "*"});
                 trocarUnaryMinus = false;
@@ -129,17 +315,9 @@ std::vector<Token> Lexer::tokenize(const std::string& input) {
     return tokens;
 }
 
-std::string Lexer::lerEnquanto(std::function<bool(int)> condicao) {
-    std::string result;
-    while (pos < length && condicao(input[pos])) {
-        result += input[pos];
-        pos++;
-    }
-    return result;
-}
-
 void Lexer::validarComando(const std::vector<Token>& tokens) {
-    if (tokens.empty()) {
+    // Sempre há o FIM_DE_LINHA: só com ele e o número da linha, não há comando
+    if (tokens.size() < 2) {
         throw LexerException("Comando vazio", numeroDeLinhaBasic, input);
     }
 
@@ -147,7 +325,30 @@ void Lexer::validarComando(const std::vector<Token>& tokens) {
     if (command == "LET") {
         /* Aqui podemos validar o LET */
     } else if (command == "DIM") {
-        if (tokens.size() != 5 || tokens[2].type != IDENTIFICADOR || tokens[3].type != NUMERO) {
+        // DIM <nome> <tamanho>[, <tamanho>...] [AS <tipo>] [FILE "<arquivo>" [RANDOM]]
+        if (tokens.size() < 5 || tokens[2].type != IDENTIFICADOR || tokens[3].type != NUMERO) {
+            throw LexerException("Comando DIM inválido", numeroDeLinhaBasic, input);
+        }
+        size_t proximo = 4;
+        while (proximo + 1 < tokens.size() && tokens[proximo].type == VIRGULA && tokens[proximo + 1].type == NUMERO) {
+            proximo += 2;
+        }
+        if (tokens[proximo].type == IDENTIFICADOR && tokens[proximo].value == "AS") {
+            if (tokens[proximo + 1].type != IDENTIFICADOR) {
+                throw LexerException("Comando DIM inválido", numeroDeLinhaBasic, input);
+            }
+            proximo += 2;
+        }
+        if (tokens[proximo].type == IDENTIFICADOR && tokens[proximo].value == "FILE") {
+            if (tokens[proximo + 1].type != LITERAL_TEXTO) {
+                throw LexerException("Comando DIM inválido", numeroDeLinhaBasic, input);
+            }
+            proximo += 2;
+            if (tokens[proximo].type == IDENTIFICADOR && tokens[proximo].value == "RANDOM") {
+                proximo++;
+            }
+        }
+        if (tokens[proximo].type != FIM_DE_LINHA) {
             throw LexerException("Comando DIM inválido", numeroDeLinhaBasic, input);
         }
     } else if (command == "PRINT") {
@@ -164,6 +365,58 @@ void Lexer::validarComando(const std::vector<Token>& tokens) {
         if (tokens.size() != 3) {
             throw LexerException("Comando END invalido", numeroDeLinhaBasic, input);
         }
+    } else if (command == "LOAD") {
+        // LOAD <nome> FROM "<arquivo>" [COLUMN <número>]
+        if (tokens.size() < 6 || tokens[2].type != IDENTIFICADOR || tokens[3].type != IDENTIFICADOR
+            || tokens[3].value != "FROM" || tokens[4].type != LITERAL_TEXTO) {
+            throw LexerException("Comando LOAD inválido", numeroDeLinhaBasic, input);
+        }
+        size_t proximo = 5;
+        if (tokens[proximo].type == IDENTIFICADOR && tokens[proximo].value == "COLUMN") {
+            if (tokens[proximo + 1].type != NUMERO) {
+                throw LexerException("Comando LOAD inválido", numeroDeLinhaBasic, input);
+            }
+            proximo += 2;
+        }
+        if (tokens[proximo].type != FIM_DE_LINHA) {
+            throw LexerException("Comando LOAD inválido", numeroDeLinhaBasic, input);
+        }
+    } else if (command == "SAVE") {
+        // SAVE <nome>[, <nome>...] TO "<arquivo>" [ASYNC]
+        size_t proximo = 2;
+        while (tokens[proximo].type == IDENTIFICADOR && tokens[proximo + 1].type == VIRGULA) {
+            proximo += 2;
+        }
+        if (tokens[proximo].type != IDENTIFICADOR || tokens[proximo + 1].type != IDENTIFICADOR
+            || tokens[proximo + 1].value != "TO" || tokens[proximo + 2].type != LITERAL_TEXTO) {
+            throw LexerException("Comando SAVE inválido", numeroDeLinhaBasic, input);
+        }
+        proximo += 3;
+        if (tokens[proximo].type == IDENTIFICADOR && tokens[proximo].value == "ASYNC") {
+            proximo++;
+        }
+        if (tokens[proximo].type != FIM_DE_LINHA) {
+            throw LexerException("Comando SAVE inválido", numeroDeLinhaBasic, input);
+        }
+    } else if (command == "PARALLEL") {
+        // PARALLEL FOR <contador> = <início> TO <fim> [REDUCE <nome>[, <nome>...]]
+        bool temTo = false;
+        for (size_t k = 5; k < tokens.size(); ++k) {
+            temTo = temTo || (tokens[k].type == IDENTIFICADOR && tokens[k].value == "TO");
+        }
+        if (tokens.size() < 9 || tokens[2].type != IDENTIFICADOR || tokens[2].value != "FOR"
+            || tokens[3].type != IDENTIFICADOR || tokens[4].type != OPERADOR || tokens[4].value != "=" || !temTo) {
+            throw LexerException("Comando PARALLEL FOR inválido", numeroDeLinhaBasic, input);
+        }
+    } else if (command == "NEXT") {
+        if (tokens.size() != 4 || tokens[2].type != IDENTIFICADOR) {
+            throw LexerException("Comando NEXT inválido", numeroDeLinhaBasic, input);
+        }
+    } else if (command == "CHECKPOINT") {
+        // CHECKPOINT ["<arquivo>"]
+        if (tokens.size() != 3 && (tokens.size() != 4 || tokens[2].type != LITERAL_TEXTO)) {
+            throw LexerException("Comando CHECKPOINT inválido", numeroDeLinhaBasic, input);
+        }
     } else if (command == "DRAW") {
         if (tokens.size() < 4) {
             throw LexerException("Comando DRAW inválido 1", numeroDeLinhaBasic, input);
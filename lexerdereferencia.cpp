@@ -0,0 +1,143 @@
+#include "LexerDeReferencia.h"
+#include "Lexer.h"
+#include <cctype>
+#include <sstream>
+#include "util.h"
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Cópia do algoritmo antigo do Lexer::tokenize, com as palavras reservadas de hoje. A única
+// mudança é passar os caracteres como unsigned char para isalpha/isdigit/isspace: com char
+// negativo (bytes acima de 127) o comportamento era indefinido.
+
+namespace {
+    int comoCaractere(char c) {
+        return static_cast<unsigned char>(c);
+    }
+}
+
+LexerDeReferencia::LexerDeReferencia()
+    : pos(0), length(0),
+      comandos({{"DIM", true}, {"END", true}, {"LET", true}, {"PRINT", true}, {"GOTO", true}, {"IF", true}, {"INPUT", true},
+                {"DRAW", true}, {"PLOT", true}, {"LINE", true}, {"RECTANGLE", true}, {"CHECKPOINT", true},
+                {"LOAD", true}, {"SAVE", true}, {"PARALLEL", true}, {"NEXT", true}}),
+      funcoes({{"EXP", true}, {"ABS", true}, {"LOG", true}, {"SIN", true}, {"COS", true}, {"TAN", true}, {"SQR", true}, {"RND", true}}),
+      operadores({{'+', true}, {'-', true}, {'*', true}, {'/', true}, {'^', true}, {'>', true}, {'<', true}, {'=', true}, {'!', true}}) {}
+
+std::vector<Token> LexerDeReferencia::tokenize(const std::string& input) {
+    std::vector<Token> tokens;
+    this->pos = 0;
+    this->length = input.length();
+    this->input = input;
+    bool trocarUnaryMinus = false;
+    while (pos < length) {
+        if (std::isspace(comoCaractere(input[pos]))) {
+            pos++;
+            continue;
+        }
+
+        if (pos == 0) {
+            trocarUnaryMinus = false;
+            std::istringstream lineStream(input);
+            std::string basicLineNumber;
+            lineStream >> basicLineNumber;
+            if (!isNumeric(basicLineNumber)) {
+                throw LexerException("Linha sem numero: " + std::string(1, input[pos]), basicLineNumber, input);
+            }
+            tokens.push_back({NUMERO_LINHA, basicLineNumber});
+            pos += basicLineNumber.length();
+            continue;
+        }
+
+        if (input[pos] == '\"') {
+            // inicio de literal
+            trocarUnaryMinus = false;
+            pos++;
+            std::string literal = lerEnquanto([](int c) { return c != '\"'; });
+            if (pos < input.length()) {
+                pos++;
+            }
+            tokens.push_back({LITERAL_TEXTO, literal});
+        } else if (std::isalpha(comoCaractere(input[pos]))) {
+            trocarUnaryMinus = false;
+            std::string word = lerEnquanto([](int c) { return std::isalnum(c); });
+            if (comandos.count(word)) {
+                tokens.push_back({COMANDO, word});
+            } else if (funcoes.count(word)) {
+                tokens.push_back({FUNCAO, word});
+            } else {
+                if (pos < length && input[pos] == '%') {
+                    // Sufixo de variável inteira: I%
+                    word += input[pos++];
+                }
+                tokens.push_back({IDENTIFICADOR, word});
+            }
+        } else if (std::isdigit(comoCaractere(input[pos])) || input[pos] == '.') {
+            trocarUnaryMinus = false;
+            tokens.push_back({NUMERO, lerEnquanto([](int c) { return std::isdigit(c) || c == '.'; })});
+        } else if (input[pos] == '(') {
+            trocarUnaryMinus = true;
+            tokens.push_back({PARENTESIS_ESQUERDO, "("});
+            pos++;
+        } else if (input[pos] == ')') {
+            trocarUnaryMinus = false;
+            tokens.push_back({PARENTESIS_DIREITO, ")"});
+            pos++;
+        } else if (input[pos] == '[') {
+            trocarUnaryMinus = true;
+            tokens.push_back({CHAVE_ESQUERDA, "["});
+            pos++;
+        } else if (input[pos] == ']') {
+            trocarUnaryMinus = false;
+            tokens.push_back({CHAVE_DIREITA, "]"});
+            pos++;
+        } else if (input[pos] == ',') {
+            trocarUnaryMinus = true;
+            tokens.push_back({VIRGULA, ","});
+            pos++;
+        } else if (operadores.count(input[pos])) {
+            if (trocarUnaryMinus && input[pos] == '-') {
+                // Vamos trocar por "-1 *"
+                tokens.push_back({PARENTESIS_ESQUERDO, "("});
+                tokens.push_back({NUMERO, "1"});
+                tokens.push_back({OPERADOR, "-"});
+                tokens.push_back({NUMERO, "2"});
+                tokens.push_back({PARENTESIS_DIREITO, ")"});
+                tokens.push_back({OPERADOR, "*"});
+                trocarUnaryMinus = false;
+                pos++;
+            } else {
+                trocarUnaryMinus = true;
+                tokens.push_back({OPERADOR, std::string(1, input[pos])});
+                pos++;
+            }
+        } else {
+            throw LexerException("Caractere inesperado: " + std::string(1, input[pos]), numeroDeLinhaBasic, input);
+        }
+    }
+    tokens.push_back({FIM_DE_LINHA, ""});
+    return tokens;
+}
+
+std::string LexerDeReferencia::lerEnquanto(std::function<bool(int)> condicao) {
+    std::string result;
+    while (pos < length && condicao(comoCaractere(input[pos]))) {
+        result += input[pos];
+        pos++;
+    }
+    return result;
+}
@@ -1,10 +1,20 @@
 #include "Lexer.h"
 #include "Parser.h"
 #include "Interpreter.h"
+#include "Cache.h"
+#include "Resolvedor.h"
+#include "Otimizador.h"
+#include "Sweep.h"
+#include "Servidor.h"
+#include "Repl.h"
+#include "Estatisticas.h"
+#include "RegistroDeVoo.h"
+#include "util.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <filesystem>
+#include <memory>
 
 /*
 Copyright 2024 Cleuton Sampaio de Melo Junir
@@ -22,10 +32,22 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
-const std::string VERSAO = "0.0.4";
+const std::string VERSAO = "0.0.5";
 
-void executarPrograma(const std::string basicScriptName, const std::string& input, bool verbose) {
+// Identifica a compilação na chave do --cache: um resultado guardado por outro executável (com
+// outro comportamento do interpretador) não é repetido. O CMake gera o IdDaCompilacao.h com o
+// hash dos fontes do sibasic; sem ele, vale a data e hora da compilação.
+#if __has_include("IdDaCompilacao.h")
+#include "IdDaCompilacao.h"
+#else
+#define SIBASIC_ID_DA_COMPILACAO __DATE__ " " __TIME__
+#endif
+const std::string VERSAO_DO_CACHE = VERSAO + "-" + SIBASIC_ID_DA_COMPILACAO;
+
+std::shared_ptr<NoDePrograma> compilarPrograma(const std::string& input, bool verbose,
+                                               Estatisticas* estatisticas = nullptr) {
     std::istringstream inputStream(input);
+    uint64_t nosAntes = NoDaAST::criados.load(std::memory_order_relaxed);
     std::string linha;
     auto programa = std::make_shared<NoDePrograma>();
 
@@ -36,13 +58,22 @@ void executarPrograma(const std::string basicScriptName, const std::string& inpu
     while (std::getline(inputStream, linha)) {
         Lexer lexer{};
         try {
-            if (linha[0] == '*') {
-                // É uma linha de comentário. Vamos pular
+            size_t inicio = linha.find_first_not_of(" \t\r");
+            if (inicio == std::string::npos || linha[inicio] == '*') {
+                // Linha vazia ou de comentário. Vamos pular
                 continue;
             }
-            transform(linha.begin(), linha.end(), linha.begin(), ::toupper);
-            std::vector<Token> tokens = lexer.tokenize(linha);
+            std::vector<Token> tokens;
+            {
+                MedicaoDeFase medicao(estatisticas, Estatisticas::LEXER);
+                linha = paraMaiusculas(linha);
+                tokens = lexer.tokenize(linha);
+            }
+            if (estatisticas != nullptr) {
+                estatisticas->tokens += tokens.size();
+            }
 
+            MedicaoDeFase medicao(estatisticas, Estatisticas::PARSER);
             Parser parser(tokens, jaTemDrawStart);
 
             if (verbose) {
@@ -74,11 +105,118 @@ void executarPrograma(const std::string basicScriptName, const std::string& inpu
         }
     }
 
+    programa->indexarLinhas();
+    programa->hashDoFonte = hashDoTexto(input);
+    try {
+        MedicaoDeFase medicao(estatisticas, Estatisticas::RESOLVEDOR);
+        Resolvedor(*programa).resolver();
+    } catch (const ParserException& e) {
+        // Erro de carga (ex: índice literal fora do DIM): o programa não é executado
+        std::cerr << "Erro de parser: " << e.what() << std::endl;
+        return nullptr;
+    }
+    if (verbose) {
+        for (const auto& laco : programa->lacos) {
+            std::cout << "Laço de contador: comandos " << laco.inicio << " a " << laco.fim << ", "
+                      << laco.acessos.size() << " acessos verificados na entrada" << std::endl;
+        }
+    }
+    Otimizador otimizador(*programa);
+    {
+        MedicaoDeFase medicao(estatisticas, Estatisticas::OTIMIZADOR);
+        otimizador.otimizar();
+    }
+    if (verbose) {
+        otimizador.mostrar(std::cout);
+    }
+    if (estatisticas != nullptr) {
+        estatisticas->nosDaAST = NoDaAST::criados.load(std::memory_order_relaxed) - nosAntes;
+    }
+    return programa;
+}
+
+void executarPrograma(const std::string basicScriptName, const std::string& input, bool verbose,
+                      const std::shared_ptr<FonteDeEntrada>& entrada, uint64_t limiteDeComandos,
+                      const std::string& arquivoCheckpoint, Estatisticas* estatisticas, unsigned numeroThreads,
+                      const CacheDeExecucao* cache) {
+    auto programa = compilarPrograma(input, verbose, estatisticas);
+    if (!programa) {
+        return;
+    }
+
+    MedicaoDeFase medicao(estatisticas, Estatisticas::EXECUCAO);
+    // A entrada só conta como dada se veio de --input-file
+    if (cache != nullptr && !CacheDeExecucao::deterministico(*programa, dynamic_cast<EntradaArquivo*>(entrada.get()))) {
+        cache = nullptr;
+    }
+    ResultadoGuardado resultado;
+    if (cache != nullptr && cache->buscar(resultado)
+        && (limiteDeComandos == 0 || resultado.comandosExecutados <= limiteDeComandos)) {
+        // Mesmo fonte e mesma entrada: a saída e os SVG são repetidos sem executar o programa
+        std::cout << resultado.saida << std::flush;
+        try {
+            for (const std::string& desenho : resultado.desenhos) {
+                Interpreter::gravarDesenho(basicScriptName, desenho);
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Erro de interpreter: " << e.what() << std::endl;
+        }
+        if (estatisticas != nullptr) {
+            estatisticas->comandosExecutados = resultado.comandosExecutados;
+        }
+        return;
+    }
+
+    SaidaCapturada captura(std::cout.rdbuf());
+    std::ostream saidaCapturada(&captura);
+    Interpreter interpreter(basicScriptName, cache != nullptr ? saidaCapturada : std::cout, entrada);
+    interpreter.medir(estatisticas);
+    interpreter.definirThreadsParalelas(numeroThreads);
+    if (cache != nullptr) {
+        interpreter.guardarDesenhos(&resultado.desenhos);
+    }
+    // Sempre ativo: um erro numa execução longa deixa o histórico recente em "<script>.trace"
+    interpreter.ativarRegistroDeVoo();
     try {
-        Interpreter interpreter(basicScriptName);
-        interpreter.executar(programa);
+        if (arquivoCheckpoint.empty()) {
+            interpreter.iniciar(programa);
+        } else {
+            interpreter.restaurarCheckpoint(programa, arquivoCheckpoint);
+        }
+        Interpreter::instalarPedidosPorSinal();
+        // Programa que não termina (laço sem saída) é interrompido depois do limite
+        uint64_t orcamento = limiteDeComandos == 0 ? UINT64_MAX : limiteDeComandos;
+        Interpreter::Situacao situacao;
+        while ((situacao = interpreter.passo(orcamento - interpreter.comandosExecutados()))
+               == Interpreter::Situacao::AGUARDANDO_ENTRADA) {
+            entrada->esperar();
+        }
+        if (situacao == Interpreter::Situacao::CEDEU) {
+            throw std::runtime_error("Limite de comandos executados atingido: " + std::to_string(limiteDeComandos));
+        }
+        // Só execuções sem erro são guardadas
+        if (cache != nullptr) {
+            resultado.saida = captura.texto();
+            resultado.comandosExecutados = interpreter.comandosExecutados();
+            try {
+                cache->guardar(resultado);
+            } catch (const std::runtime_error& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
     } catch (const std::runtime_error& e) {
         std::cerr << "Erro de interpreter: " << e.what() << std::endl;
+        std::string caminho = basicScriptName + ".trace";
+        try {
+            if (interpreter.gravarRegistroDeVoo(caminho, e.what())) {
+                std::cerr << "Registro de execução gravado: " << caminho << " (veja com --decode-trace)" << std::endl;
+            }
+        } catch (const std::runtime_error& falha) {
+            std::cerr << falha.what() << std::endl;
+        }
+    }
+    if (estatisticas != nullptr) {
+        estatisticas->comandosExecutados = interpreter.comandosExecutados();
     }
 }
 
@@ -88,40 +226,214 @@ std::string getScriptName(const std::string filePath) {
     return pathObj.filename().string();
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 2 && argc != 3) {
-        std::cerr << "Uso: " << argv[0] << " [-v] <arquivo>" << std::endl;
-        return 1;
-    }
+void mostrarUso(const char* programa) {
+    std::cerr << "Uso: " << programa << " [-v] [--input-file <entradas>|-] [--max-steps N] [--resume <checkpoint>]"
+              << " [--stats|--stats=json] [-j N] [--cache <diretório>] <arquivo>"
+              << std::endl;
+    std::cerr << "     " << programa << " -i [<arquivo>]" << std::endl;
+    std::cerr << "     " << programa << " --decode-trace <registro>" << std::endl;
+    std::cerr << "     " << programa << " --sweep <entradas.csv> [-j N] [--lanes 4|8] [-o <saida>] <arquivo>" << std::endl;
+    std::cerr << "     " << programa << " --serve <socket> [-j N] <arquivo>" << std::endl;
+}
 
+int main(int argc, char *argv[]) {
     bool verbose = false;
+    bool interativo = false;
     std::string filename;
+    std::string arquivoSweep;
+    std::string arquivoSaida;
+    std::string arquivoEntrada;
+    std::string caminhoSocket;
+    std::string arquivoCheckpoint;
+    std::string arquivoRegistro;
+    std::string diretorioCache;
+    unsigned numeroThreads = 0;
+    int lanes = 1;
+    uint64_t limiteDeComandos = 0;
+    // 0: sem estatísticas, 1: tabela, 2: JSON
+    int formatoEstatisticas = 0;
 
-    if (argc == 3) {
-        std::string arg1 = argv[1];
-        if (arg1 == "-v") {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool temValor = i + 1 < argc;
+        if (arg == "-v") {
             verbose = true;
+        } else if (arg == "-i") {
+            interativo = true;
+        } else if (arg == "--sweep" && temValor) {
+            arquivoSweep = argv[++i];
+        } else if (arg == "--serve" && temValor) {
+            caminhoSocket = argv[++i];
+        } else if (arg == "-j" && temValor) {
+            std::string valor = argv[++i];
+            if (!isNumeric(valor) || std::stoi(valor) <= 0) {
+                std::cerr << "Número de threads inválido: " << valor << std::endl;
+                return 1;
+            }
+            numeroThreads = std::stoi(valor);
+        } else if (arg == "--lanes" && temValor) {
+            std::string valor = argv[++i];
+            if (valor != "4" && valor != "8") {
+                std::cerr << "Número de lanes inválido (use 4 ou 8): " << valor << std::endl;
+                return 1;
+            }
+            lanes = std::stoi(valor);
+        } else if (arg == "--max-steps" && temValor) {
+            std::string valor = argv[++i];
+            if (!isNumeric(valor) || std::stoull(valor) == 0) {
+                std::cerr << "Limite de comandos inválido: " << valor << std::endl;
+                return 1;
+            }
+            limiteDeComandos = std::stoull(valor);
+        } else if (arg == "--stats") {
+            formatoEstatisticas = 1;
+        } else if (arg == "--stats=json") {
+            formatoEstatisticas = 2;
+        } else if (arg == "--decode-trace" && temValor) {
+            arquivoRegistro = argv[++i];
+        } else if (arg == "--resume" && temValor) {
+            arquivoCheckpoint = argv[++i];
+        } else if (arg == "--input-file" && temValor) {
+            arquivoEntrada = argv[++i];
+        } else if (arg == "--cache" && temValor) {
+            diretorioCache = argv[++i];
+        } else if (arg == "-o" && temValor) {
+            arquivoSaida = argv[++i];
+        } else if (arg[0] == '-' || !filename.empty()) {
+            std::cerr << "Opção inválida: " << arg << std::endl;
+            mostrarUso(argv[0]);
+            return 1;
         } else {
-            std::cerr << "Opção inválida: " << arg1 << std::endl;
+            filename = arg;
+        }
+    }
+
+    if (!arquivoRegistro.empty()) {
+        try {
+            RegistroDeVoo::decodificar(arquivoRegistro, std::cout);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
             return 1;
         }
-        filename = argv[2];
-    } else {
-        filename = argv[1];
+        return 0;
     }
 
-    std::string basicScriptName = getScriptName(filename);
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Falha ao abrir arquivo: " << filename << std::endl;
+    if (interativo && filename.empty()) {
+        Repl repl("REPL");
+        repl.executar(std::cin);
+        return 0;
+    }
+
+    if (filename.empty()) {
+        mostrarUso(argv[0]);
         return 1;
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string input = buffer.str();
+    // Só a execução normal é medida: a varredura, o servidor e o modo interativo não têm --stats
+    std::unique_ptr<Estatisticas> estatisticas;
+    if (formatoEstatisticas != 0 && !interativo && caminhoSocket.empty() && arquivoSweep.empty()) {
+        estatisticas = std::make_unique<Estatisticas>();
+    }
+
+    std::string basicScriptName = getScriptName(filename);
+    std::string input;
+    {
+        MedicaoDeFase medicao(estatisticas.get(), Estatisticas::LEITURA);
+        std::ifstream file(filename);
+        if (!file) {
+            std::cerr << "Falha ao abrir arquivo: " << filename << std::endl;
+            return 1;
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        input = buffer.str();
+    }
 
-    executarPrograma(basicScriptName,input, verbose);
+    if (interativo) {
+        // Carrega o arquivo e continua no modo interativo
+        Repl repl(basicScriptName);
+        repl.carregar(input);
+        repl.executar(std::cin);
+        return 0;
+    }
+
+    if (!caminhoSocket.empty()) {
+        // Uma sessão do programa por conexão, até SIGINT ou SIGTERM
+        auto programa = compilarPrograma(input, verbose);
+        if (!programa) {
+            return 1;
+        }
+        try {
+            executarServidor(caminhoSocket, basicScriptName, programa, numeroThreads);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Erro no servidor: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!arquivoSweep.empty()) {
+        // O programa é analisado uma única vez e executado para cada linha do CSV
+        auto programa = compilarPrograma(input, verbose);
+        if (!programa) {
+            return 1;
+        }
+        std::ofstream arquivoDeSaida;
+        if (!arquivoSaida.empty()) {
+            arquivoDeSaida.open(arquivoSaida);
+            if (!arquivoDeSaida) {
+                std::cerr << "Falha ao abrir arquivo de saída: " << arquivoSaida << std::endl;
+                return 1;
+            }
+        }
+        std::ostream& saida = arquivoSaida.empty() ? std::cout : arquivoDeSaida;
+        try {
+            executarVarredura(basicScriptName, programa, arquivoSweep, numeroThreads, saida, lanes);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Erro no sweep: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::shared_ptr<FonteDeEntrada> entrada;
+    if (arquivoEntrada.empty()) {
+        entrada = std::make_shared<EntradaConsole>();
+    } else {
+        try {
+            // Todos os valores do INPUT vêm do arquivo (ou de "-", a entrada padrão), sem prompts
+            entrada = std::make_shared<EntradaArquivo>(arquivoEntrada);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Retomar de um checkpoint depende do estado gravado, que não faz parte da chave
+    std::unique_ptr<CacheDeExecucao> cache;
+    if (!diretorioCache.empty() && arquivoCheckpoint.empty()) {
+        auto* entradaArquivo = dynamic_cast<EntradaArquivo*>(entrada.get());
+        try {
+            cache = std::make_unique<CacheDeExecucao>(diretorioCache, VERSAO_DO_CACHE, input,
+                                                      entradaArquivo ? &entradaArquivo->conteudo() : nullptr);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    executarPrograma(basicScriptName,input, verbose, entrada, limiteDeComandos, arquivoCheckpoint, estatisticas.get(),
+                     numeroThreads, cache.get());
+
+    if (estatisticas) {
+        // Na saída de erro, para não se misturar com a saída dos PRINT
+        if (formatoEstatisticas == 2) {
+            estatisticas->mostrarJson(std::cerr);
+        } else {
+            estatisticas->mostrar(std::cerr);
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "LexerDeReferencia.h"
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Medição da tokenização: constrói um Lexer e chama tokenize() para cada linha, como o
+// compilarPrograma do main.cpp, com o Lexer atual e com o LexerDeReferencia (o algoritmo
+// antigo). A referência não valida o comando nem converte os NUMEROs, então a comparação
+// favorece o algoritmo antigo.
+//
+// Uso: sibasic_medicao_lexer [linhas [rodadas]]
+
+namespace {
+    using Relogio = std::chrono::steady_clock;
+
+    // Formas de linha comuns nos programas de basic_programs
+    const std::vector<std::string> formas = {
+        "10 LET X = X + 1",
+        "20 LET Y[I, J] = SIN(X * 3.14159) / (2 + ABS(-Y))",
+        "30 IF X > 100 THEN 80",
+        "40 PRINT \"Resultado: \", X, Y[I, J]",
+        "50 GOTO 20",
+        "60 PLOT X, Y, 1, BLUE",
+        "70 LET TOTAL% = TOTAL% + CONTADOR * 0.5 - RND() ^ 2",
+        "80 DIM MATRIZ 100, 100",
+    };
+
+    template <typename L>
+    double medir(const std::vector<std::string>& linhas, size_t& tokens) {
+        tokens = 0;
+        auto inicio = Relogio::now();
+        for (const std::string& linha : linhas) {
+            L lexer;
+            tokens += lexer.tokenize(linha).size();
+        }
+        return std::chrono::duration<double>(Relogio::now() - inicio).count();
+    }
+
+    template <typename L>
+    void rodar(const char* nome, const std::vector<std::string>& linhas, int rodadas) {
+        for (int rodada = 1; rodada <= rodadas; ++rodada) {
+            size_t tokens = 0;
+            double segundos = medir<L>(linhas, tokens);
+            std::cout << nome << " rodada " << rodada << ": " << segundos << " s, " << tokens << " tokens, "
+                      << static_cast<double>(linhas.size()) / segundos / 1e6 << " M linhas/s" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long quantidade = argc > 1 ? std::atol(argv[1]) : 2000000;
+    int rodadas = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    std::vector<std::string> linhas;
+    linhas.reserve(static_cast<size_t>(quantidade));
+    for (long k = 0; k < quantidade; ++k) {
+        linhas.push_back(formas[static_cast<size_t>(k) % formas.size()]);
+    }
+
+    rodar<LexerDeReferencia>("referência", linhas, rodadas);
+    rodar<Lexer>("Lexer     ", linhas, rodadas);
+    return 0;
+}
@@ -0,0 +1,593 @@
+#include "Otimizador.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    // Destino de um desvio (GOTO ou IF), ou -1. Para o grafo de fluxo, o PARALLEL FOR desvia
+    // para depois do NEXT (nenhuma volta) e o NEXT volta para o início do corpo.
+    int destinoDoDesvio(const NoDePrograma& programa, const NoDaASTPtr& comando) {
+        if (auto gotoStmt = std::dynamic_pointer_cast<NoDoComandoGOTO>(comando)) {
+            return programa.indiceDaLinha(gotoStmt->numeroLinhaDesvio);
+        } else if (auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(comando)) {
+            return programa.indiceDaLinha(ifStmt->numeroLinha);
+        } else if (auto parallelStmt = std::dynamic_pointer_cast<NoDoComandoPARALLEL>(comando)) {
+            return parallelStmt->next + 1 < static_cast<int>(programa.comandos.size()) ? parallelStmt->next + 1 : -1;
+        } else if (std::dynamic_pointer_cast<NoDoComandoNEXT>(comando)) {
+            for (int index = 0; index < static_cast<int>(programa.comandos.size()); ++index) {
+                auto parallelStmt = std::dynamic_pointer_cast<NoDoComandoPARALLEL>(programa.comandos[index]);
+                if (parallelStmt && programa.comandos[parallelStmt->next] == comando) {
+                    return index + 1;
+                }
+            }
+        }
+        return -1;
+    }
+
+    bool terminaBloco(const NoDaASTPtr& comando) {
+        return std::dynamic_pointer_cast<NoDoComandoGOTO>(comando) || std::dynamic_pointer_cast<NoDoComandoIF>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoEND>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoPARALLEL>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoNEXT>(comando);
+    }
+
+    // Comandos cujos efeitos o Otimizador conhece. Comandos novos precisam ser incluídos aqui
+    // (e em "escreve") para que os laços e blocos que os contêm sejam otimizados.
+    bool conhecido(const NoDaASTPtr& comando) {
+        return std::dynamic_pointer_cast<NoDoComandoLET>(comando) || std::dynamic_pointer_cast<NoDoComandoPRINT>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoGOTO>(comando) || std::dynamic_pointer_cast<NoDoComandoIF>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoEND>(comando) || std::dynamic_pointer_cast<NoDoComandoDIM>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoINPUT>(comando) || std::dynamic_pointer_cast<NoDoComandoDRAW>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoPLOT>(comando) || std::dynamic_pointer_cast<NoDoComandoLINE>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoCHECKPOINT>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoLOAD>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoSAVE>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoPARALLEL>(comando)
+               || std::dynamic_pointer_cast<NoDoComandoNEXT>(comando);
+    }
+
+    // Números e variáveis simples: não vale a pena guardar em temporário
+    bool folha(const NoDaASTPtr& expressao) {
+        if (std::dynamic_pointer_cast<NoDeNumero>(expressao)) {
+            return true;
+        }
+        auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao);
+        return identifierNode && identifierNode->indices.empty();
+    }
+
+    // Texto da expressão: identifica subexpressões iguais e aparece no -v
+    std::string texto(const NoDaASTPtr& expressao) {
+        if (auto numberNode = std::dynamic_pointer_cast<NoDeNumero>(expressao)) {
+            return numberNode->value;
+        } else if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+            if (identifierNode->indices.empty()) {
+                return identifierNode->name;
+            }
+            std::string resultado = identifierNode->name + "[";
+            for (size_t k = 0; k < identifierNode->indices.size(); ++k) {
+                resultado += (k > 0 ? ", " : "") + texto(identifierNode->indices[k].expressao);
+            }
+            return resultado + "]";
+        } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+            return "(" + texto(binaryExpr->left) + " " + binaryExpr->op + " " + texto(binaryExpr->right) + ")";
+        } else if (auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao)) {
+            std::string resultado = functionCall->nomeDaFuncao + "(";
+            for (size_t k = 0; k < functionCall->argumentos.size(); ++k) {
+                resultado += (k > 0 ? ", " : "") + texto(functionCall->argumentos[k]);
+            }
+            return resultado + ")";
+        } else if (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+            return texto(temporario->expressao);
+        }
+        return "?";
+    }
+
+    // Retorna false se a expressão não for pura (RND); "leituras" recebe as variáveis e vetores lidos
+    bool analisar(const NoDaASTPtr& expressao, std::unordered_set<std::string>& leituras) {
+        if (std::dynamic_pointer_cast<NoDeNumero>(expressao)) {
+            return true;
+        } else if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+            leituras.insert(identifierNode->name);
+            bool pura = true;
+            for (const auto& indice : identifierNode->indices) {
+                pura = analisar(indice.expressao, leituras) && pura;
+            }
+            return pura;
+        } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+            bool esquerda = analisar(binaryExpr->left, leituras);
+            return analisar(binaryExpr->right, leituras) && esquerda;
+        } else if (auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao)) {
+            static const std::unordered_set<std::string> funcoesPuras{"SIN", "COS", "TAN", "LOG", "EXP", "SQR", "ABS"};
+            bool pura = funcoesPuras.count(functionCall->nomeDaFuncao) > 0;
+            for (const auto& argumento : functionCall->argumentos) {
+                pura = analisar(argumento, leituras) && pura;
+            }
+            return pura;
+        } else if (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+            return analisar(temporario->expressao, leituras);
+        }
+        return false;
+    }
+}
+
+Otimizador::Otimizador(NoDePrograma& programa) : programa(programa) {}
+
+void Otimizador::otimizar() {
+    montarBlocos();
+    encontrarLacos();
+    moverInvariantes();
+    eliminarRepetidas();
+}
+
+void Otimizador::paraCadaExpressao(const NoDaASTPtr& comando, const std::function<void(NoDaASTPtr&)>& visitar) {
+    if (auto letStmt = std::dynamic_pointer_cast<NoDoComandoLET>(comando)) {
+        visitar(letStmt->expressao);
+        for (auto& indice : letStmt->indices) {
+            visitar(indice.expressao);
+        }
+    } else if (auto printStmt = std::dynamic_pointer_cast<NoDoComandoPRINT>(comando)) {
+        if (!printStmt->printLiteral) {
+            visitar(printStmt->expressao);
+        }
+    } else if (auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(comando)) {
+        visitar(ifStmt->operando1);
+        visitar(ifStmt->operando2);
+    } else if (auto drawStmt = std::dynamic_pointer_cast<NoDoComandoDRAW>(comando)) {
+        if (drawStmt->altura) {
+            visitar(drawStmt->altura);
+            visitar(drawStmt->largura);
+        }
+    } else if (auto plotStmt = std::dynamic_pointer_cast<NoDoComandoPLOT>(comando)) {
+        visitar(plotStmt->posicaoX);
+        visitar(plotStmt->posicaoY);
+        visitar(plotStmt->espessura);
+    } else if (auto lineStmt = std::dynamic_pointer_cast<NoDoComandoLINE>(comando)) {
+        visitar(lineStmt->xInicial);
+        visitar(lineStmt->yInicial);
+        visitar(lineStmt->xFinal);
+        visitar(lineStmt->yFinal);
+    } else if (auto rectStmt = std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando)) {
+        visitar(rectStmt->xCantoSuperiorEsquerdo);
+        visitar(rectStmt->yCantoSuperiorEsquerdo);
+        visitar(rectStmt->xCantoInferiorDireito);
+        visitar(rectStmt->yCantoInferiorDireito);
+    } else if (auto parallelStmt = std::dynamic_pointer_cast<NoDoComandoPARALLEL>(comando)) {
+        visitar(parallelStmt->inicio);
+        visitar(parallelStmt->fim);
+    }
+}
+
+void Otimizador::paraCadaFilho(const NoDaASTPtr& expressao, const std::function<void(NoDaASTPtr&)>& visitar) {
+    if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+        for (auto& indice : identifierNode->indices) {
+            visitar(indice.expressao);
+        }
+    } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+        visitar(binaryExpr->left);
+        visitar(binaryExpr->right);
+    } else if (auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao)) {
+        for (auto& argumento : functionCall->argumentos) {
+            visitar(argumento);
+        }
+    } else if (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+        visitar(temporario->expressao);
+    }
+}
+
+std::vector<std::string> Otimizador::escreve(const NoDaASTPtr& comando) {
+    if (auto letStmt = std::dynamic_pointer_cast<NoDoComandoLET>(comando)) {
+        return {letStmt->identificador};
+    } else if (auto inputStmt = std::dynamic_pointer_cast<NoDoComandoINPUT>(comando)) {
+        return {inputStmt->identificador};
+    } else if (auto dimStmt = std::dynamic_pointer_cast<NoDoComandoDIM>(comando)) {
+        return {dimStmt->nomeVariavel};
+    } else if (auto loadStmt = std::dynamic_pointer_cast<NoDoComandoLOAD>(comando)) {
+        return {loadStmt->nomeVariavel};
+    } else if (auto parallelStmt = std::dynamic_pointer_cast<NoDoComandoPARALLEL>(comando)) {
+        std::vector<std::string> nomes = parallelStmt->reducoes;
+        nomes.push_back(parallelStmt->contador);
+        return nomes;
+    } else if (auto nextStmt = std::dynamic_pointer_cast<NoDoComandoNEXT>(comando)) {
+        // O contador muda a cada volta
+        return {nextStmt->contador};
+    }
+    return {};
+}
+
+void Otimizador::restaurar(NoDePrograma& programa) {
+    std::function<void(NoDaASTPtr&)> desfazer = [&desfazer](NoDaASTPtr& expressao) {
+        while (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+            expressao = temporario->expressao;
+        }
+        if (auto no = std::dynamic_pointer_cast<NoDeExpressao>(expressao)) {
+            // As formas escolhidas pelo Interpreter são refeitas com a nova AST
+            no->formaReal = 0;
+            no->formaInteira = 0;
+        }
+        paraCadaFilho(expressao, desfazer);
+    };
+    for (const auto& comando : programa.comandos) {
+        auto statement = std::static_pointer_cast<NoDeComando>(comando);
+        statement->lacoNatural = -1;
+        statement->temporariosDoBloco.clear();
+        paraCadaExpressao(comando, desfazer);
+    }
+    programa.lacosNaturais.clear();
+    programa.numeroTemporarios = 0;
+}
+
+void Otimizador::montarBlocos() {
+    const auto& comandos = programa.comandos;
+    int n = static_cast<int>(comandos.size());
+    blocos.clear();
+    blocoDoComando.assign(n, -1);
+    if (n == 0) {
+        return;
+    }
+    // Líderes: o primeiro comando, os destinos de desvios e os comandos depois de um desvio
+    std::vector<bool> lider(n, false);
+    lider[0] = true;
+    for (int index = 0; index < n; ++index) {
+        int destino = destinoDoDesvio(programa, comandos[index]);
+        if (destino >= 0) {
+            lider[destino] = true;
+        }
+        if (terminaBloco(comandos[index]) && index + 1 < n) {
+            lider[index + 1] = true;
+        }
+    }
+    for (int index = 0; index < n; ++index) {
+        if (lider[index]) {
+            blocos.push_back({index, index, {}, {}});
+        } else {
+            blocos.back().fim = index;
+        }
+        blocoDoComando[index] = static_cast<int>(blocos.size()) - 1;
+    }
+    for (int bloco = 0; bloco < static_cast<int>(blocos.size()); ++bloco) {
+        const auto& ultimo = comandos[blocos[bloco].fim];
+        int proximo = blocos[bloco].fim + 1 < n ? blocoDoComando[blocos[bloco].fim + 1] : -1;
+        int destino = destinoDoDesvio(programa, ultimo);
+        std::vector<int>& sucessores = blocos[bloco].sucessores;
+        if (destino >= 0) {
+            sucessores.push_back(blocoDoComando[destino]);
+        }
+        // GOTO só segue para o destino; END não tem sucessor. IF para uma linha inexistente segue adiante.
+        if (proximo >= 0 && !std::dynamic_pointer_cast<NoDoComandoGOTO>(ultimo)
+            && !std::dynamic_pointer_cast<NoDoComandoEND>(ultimo)
+            && std::find(sucessores.begin(), sucessores.end(), proximo) == sucessores.end()) {
+            sucessores.push_back(proximo);
+        }
+        for (int sucessor : sucessores) {
+            blocos[sucessor].predecessores.push_back(bloco);
+        }
+    }
+}
+
+void Otimizador::encontrarLacos() {
+    lacos.clear();
+    int numeroBlocos = static_cast<int>(blocos.size());
+    if (numeroBlocos == 0) {
+        return;
+    }
+    // Ordem pós-fixada a partir do bloco de entrada, sem recursão (programas podem ser longos)
+    std::vector<int> posOrdem;
+    std::vector<int> ordem(numeroBlocos, -1);
+    std::vector<bool> visitado(numeroBlocos, false);
+    std::vector<std::pair<int, size_t>> pilha{{0, 0}};
+    visitado[0] = true;
+    while (!pilha.empty()) {
+        auto& [bloco, proximo] = pilha.back();
+        if (proximo < blocos[bloco].sucessores.size()) {
+            int sucessor = blocos[bloco].sucessores[proximo++];
+            if (!visitado[sucessor]) {
+                visitado[sucessor] = true;
+                pilha.push_back({sucessor, 0});
+            }
+        } else {
+            ordem[bloco] = static_cast<int>(posOrdem.size());
+            posOrdem.push_back(bloco);
+            pilha.pop_back();
+        }
+    }
+
+    // Dominadores imediatos (Cooper, Harvey e Kennedy), em ordem pós-fixada reversa
+    std::vector<int> dominador(numeroBlocos, -1);
+    dominador[0] = 0;
+    auto intersecao = [&](int a, int b) {
+        while (a != b) {
+            while (ordem[a] < ordem[b]) {
+                a = dominador[a];
+            }
+            while (ordem[b] < ordem[a]) {
+                b = dominador[b];
+            }
+        }
+        return a;
+    };
+    bool mudou = true;
+    while (mudou) {
+        mudou = false;
+        for (auto bloco = posOrdem.rbegin(); bloco != posOrdem.rend(); ++bloco) {
+            if (*bloco == 0) {
+                continue;
+            }
+            int novo = -1;
+            for (int predecessor : blocos[*bloco].predecessores) {
+                if (dominador[predecessor] < 0) {
+                    continue;
+                }
+                novo = novo < 0 ? predecessor : intersecao(predecessor, novo);
+            }
+            if (novo != dominador[*bloco]) {
+                dominador[*bloco] = novo;
+                mudou = true;
+            }
+        }
+    }
+    auto domina = [&](int cabecalho, int bloco) {
+        while (true) {
+            if (bloco == cabecalho) {
+                return true;
+            }
+            if (bloco == 0) {
+                return false;
+            }
+            bloco = dominador[bloco];
+        }
+    };
+
+    // Arestas de volta (origem -> cabeçalho que a domina); laços com o mesmo cabeçalho são unidos
+    std::unordered_map<int, int> lacoDoCabecalho;
+    for (int bloco = 0; bloco < numeroBlocos; ++bloco) {
+        if (!visitado[bloco]) {
+            continue;
+        }
+        for (int cabecalho : blocos[bloco].sucessores) {
+            if (!domina(cabecalho, bloco)) {
+                continue;
+            }
+            auto [existente, novo] = lacoDoCabecalho.emplace(cabecalho, static_cast<int>(lacos.size()));
+            if (novo) {
+                Laco laco;
+                laco.cabecalho = cabecalho;
+                laco.blocos.assign(numeroBlocos, false);
+                laco.blocos[cabecalho] = true;
+                lacos.push_back(std::move(laco));
+            }
+            // Corpo: blocos que chegam à origem sem passar pelo cabeçalho
+            Laco& laco = lacos[existente->second];
+            std::vector<int> pendentes;
+            if (!laco.blocos[bloco]) {
+                laco.blocos[bloco] = true;
+                pendentes.push_back(bloco);
+            }
+            while (!pendentes.empty()) {
+                int atual = pendentes.back();
+                pendentes.pop_back();
+                for (int predecessor : blocos[atual].predecessores) {
+                    if (visitado[predecessor] && !laco.blocos[predecessor]) {
+                        laco.blocos[predecessor] = true;
+                        pendentes.push_back(predecessor);
+                    }
+                }
+            }
+        }
+    }
+
+    for (Laco& laco : lacos) {
+        for (int bloco = 0; bloco < numeroBlocos; ++bloco) {
+            if (!laco.blocos[bloco]) {
+                continue;
+            }
+            ++laco.tamanho;
+            for (int index = blocos[bloco].inicio; index <= blocos[bloco].fim; ++index) {
+                const auto& comando = programa.comandos[index];
+                if (!conhecido(comando)) {
+                    laco.desconhecido = true;
+                } else {
+                    for (const std::string& nome : escreve(comando)) {
+                        laco.escritas.insert(nome);
+                    }
+                }
+            }
+        }
+    }
+    // Externos antes dos internos: uma invariante vai para o laço mais externo possível
+    std::stable_sort(lacos.begin(), lacos.end(), [](const Laco& a, const Laco& b) { return a.tamanho > b.tamanho; });
+}
+
+int Otimizador::envolver(NoDaASTPtr& expressao, int indice) {
+    if (indice < 0) {
+        indice = programa.numeroTemporarios++;
+    }
+    auto temporario = std::make_shared<NoDeTemporario>(indice, expressao);
+    // O tipo (inteiro ou real) é o da subexpressão original
+    temporario->inteira = std::static_pointer_cast<NoDeExpressao>(expressao)->inteira;
+    expressao = temporario;
+    return indice;
+}
+
+void Otimizador::moverInvariantes() {
+    for (int index = 0; index < static_cast<int>(programa.comandos.size()); ++index) {
+        std::vector<int> lacosDoComando;
+        for (int laco = 0; laco < static_cast<int>(lacos.size()); ++laco) {
+            if (!lacos[laco].desconhecido && lacos[laco].blocos[blocoDoComando[index]]) {
+                lacosDoComando.push_back(laco);
+            }
+        }
+        if (lacosDoComando.empty()) {
+            continue;
+        }
+        const auto& comando = programa.comandos[index];
+        const std::string& linha = std::static_pointer_cast<NoDeComando>(comando)->numeroLinha;
+        paraCadaExpressao(comando, [&](NoDaASTPtr& expressao) {
+            moverInvariantes(expressao, lacosDoComando, linha);
+        });
+    }
+
+    // Só os laços que receberam temporários são acompanhados em execução
+    for (Laco& laco : lacos) {
+        if (laco.temporarios.empty()) {
+            continue;
+        }
+        LacoNatural natural;
+        natural.cabecalho = blocos[laco.cabecalho].inicio;
+        for (int bloco = 0; bloco < static_cast<int>(blocos.size()); ++bloco) {
+            if (!laco.blocos[bloco]) {
+                continue;
+            }
+            if (!natural.corpo.empty() && natural.corpo.back().second + 1 == blocos[bloco].inicio) {
+                natural.corpo.back().second = blocos[bloco].fim;
+            } else {
+                natural.corpo.emplace_back(blocos[bloco].inicio, blocos[bloco].fim);
+            }
+        }
+        for (const auto& [chave, temporario] : laco.temporarios) {
+            natural.temporarios.push_back(temporario);
+        }
+        std::sort(natural.temporarios.begin(), natural.temporarios.end());
+        std::static_pointer_cast<NoDeComando>(programa.comandos[natural.cabecalho])->lacoNatural
+            = static_cast<int>(programa.lacosNaturais.size());
+        programa.lacosNaturais.push_back(std::move(natural));
+    }
+}
+
+void Otimizador::moverInvariantes(NoDaASTPtr& expressao, const std::vector<int>& lacosDoComando,
+                                  const std::string& linha) {
+    if (!expressao || std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+        return;
+    }
+    if (!folha(expressao)) {
+        std::unordered_set<std::string> leituras;
+        if (analisar(expressao, leituras)) {
+            for (int id : lacosDoComando) {
+                Laco& laco = lacos[id];
+                bool invariante = std::none_of(leituras.begin(), leituras.end(), [&laco](const std::string& nome) {
+                    return laco.escritas.count(nome) > 0;
+                });
+                if (!invariante) {
+                    continue;
+                }
+                std::string chave = texto(expressao);
+                auto existente = laco.temporarios.find(chave);
+                int indice = envolver(expressao, existente == laco.temporarios.end() ? -1 : existente->second);
+                laco.temporarios.emplace(chave, indice);
+                transformacoes.push_back("Linha " + linha + ": " + chave + " invariante no laço da linha "
+                                         + std::static_pointer_cast<NoDeComando>(
+                                               programa.comandos[blocos[laco.cabecalho].inicio])->numeroLinha
+                                         + " -> T" + std::to_string(indice));
+                return;
+            }
+        }
+    }
+    paraCadaFilho(expressao, [&](NoDaASTPtr& filho) { moverInvariantes(filho, lacosDoComando, linha); });
+}
+
+void Otimizador::eliminarRepetidas() {
+    struct Ocorrencia {
+        NoDaASTPtr* posicao;
+        int temporario;
+        std::unordered_set<std::string> leituras;
+    };
+    for (int bloco = 0; bloco < static_cast<int>(blocos.size()); ++bloco) {
+        std::unordered_map<std::string, Ocorrencia> disponiveis;
+        std::vector<int> temporariosDoBloco;
+        for (int index = blocos[bloco].inicio; index <= blocos[bloco].fim; ++index) {
+            const auto& comando = programa.comandos[index];
+            const std::string& linha = std::static_pointer_cast<NoDeComando>(comando)->numeroLinha;
+            std::function<void(NoDaASTPtr&)> visitar = [&](NoDaASTPtr& expressao) {
+                if (!expressao || std::dynamic_pointer_cast<NoDeTemporario>(expressao)) {
+                    return;
+                }
+                if (!folha(expressao)) {
+                    std::unordered_set<std::string> leituras;
+                    if (analisar(expressao, leituras)) {
+                        std::string chave = texto(expressao);
+                        auto anterior = disponiveis.find(chave);
+                        if (anterior != disponiveis.end()) {
+                            // Mesmo valor da ocorrência anterior: as duas passam a usar o temporário
+                            Ocorrencia& ocorrencia = anterior->second;
+                            if (ocorrencia.temporario < 0) {
+                                ocorrencia.temporario = envolver(*ocorrencia.posicao, -1);
+                                temporariosDoBloco.push_back(ocorrencia.temporario);
+                            }
+                            envolver(expressao, ocorrencia.temporario);
+                            transformacoes.push_back("Linha " + linha + ": " + chave + " repetida no bloco B"
+                                                     + std::to_string(bloco) + " -> T"
+                                                     + std::to_string(ocorrencia.temporario));
+                            return;
+                        }
+                        disponiveis.emplace(chave, Ocorrencia{&expressao, -1, std::move(leituras)});
+                    }
+                }
+                paraCadaFilho(expressao, visitar);
+            };
+            paraCadaExpressao(comando, visitar);
+
+            // Depois de uma atribuição, as subexpressões que leem a variável não valem mais
+            if (!conhecido(comando)) {
+                disponiveis.clear();
+            }
+            for (const std::string& nome : escreve(comando)) {
+                for (auto ocorrencia = disponiveis.begin(); ocorrencia != disponiveis.end();) {
+                    if (ocorrencia->second.leituras.count(nome)) {
+                        ocorrencia = disponiveis.erase(ocorrencia);
+                    } else {
+                        ++ocorrencia;
+                    }
+                }
+            }
+        }
+        if (!temporariosDoBloco.empty()) {
+            std::static_pointer_cast<NoDeComando>(programa.comandos[blocos[bloco].inicio])->temporariosDoBloco
+                = std::move(temporariosDoBloco);
+        }
+    }
+}
+
+void Otimizador::mostrar(std::ostream& saida) const {
+    auto linhaDo = [this](int index) {
+        return std::static_pointer_cast<NoDeComando>(programa.comandos[index])->numeroLinha;
+    };
+    saida << "Blocos básicos:" << std::endl;
+    for (size_t bloco = 0; bloco < blocos.size(); ++bloco) {
+        saida << "  B" << bloco << ": linhas " << linhaDo(blocos[bloco].inicio) << "-" << linhaDo(blocos[bloco].fim)
+              << " ->";
+        for (int sucessor : blocos[bloco].sucessores) {
+            saida << " B" << sucessor;
+        }
+        saida << std::endl;
+    }
+    saida << "Laços naturais:" << std::endl;
+    for (const Laco& laco : lacos) {
+        saida << "  Cabeçalho B" << laco.cabecalho << " (linha " << linhaDo(blocos[laco.cabecalho].inicio) << "):";
+        for (size_t bloco = 0; bloco < blocos.size(); ++bloco) {
+            if (laco.blocos[bloco]) {
+                saida << " B" << bloco;
+            }
+        }
+        saida << (laco.desconhecido ? " (não otimizado)" : "") << std::endl;
+    }
+    saida << "Transformações:" << std::endl;
+    for (const auto& transformacao : transformacoes) {
+        saida << "  " << transformacao << std::endl;
+    }
+}
@@ -24,6 +24,37 @@ const char* ParserException::what() const noexcept {
     return message.c_str();
 }
 
+void NoDePrograma::indexarLinhas() {
+    indiceLinhas.clear();
+    indiceLinhas.reserve(comandos.size());
+    for (int index = 0; index < static_cast<int>(comandos.size()); ++index) {
+        const auto& statement = std::static_pointer_cast<NoDeComando>(comandos[index]);
+        // Se houver linhas repetidas, vale a primeira, como na busca sequencial
+        indiceLinhas.emplace(statement->numeroLinha, index);
+    }
+}
+
+int TabelaDeSimbolos::slot(const std::string& nome) {
+    auto [simbolo, novo] = slots.emplace(nome, static_cast<int>(nomes.size()));
+    if (novo) {
+        nomes.push_back(nome);
+    }
+    return simbolo->second;
+}
+
+int TabelaDeSimbolos::procurar(const std::string& nome) const {
+    auto simbolo = slots.find(nome);
+    return simbolo == slots.end() ? -1 : simbolo->second;
+}
+
+int NoDePrograma::indiceDaLinha(const std::string& numeroLinha) const {
+    auto linha = indiceLinhas.find(numeroLinha);
+    if (linha == indiceLinhas.end()) {
+        return -1;
+    }
+    return linha->second;
+}
+
 Parser::Parser(const std::vector<Token>& tokens, bool jaTemDrawStart) : tokens(tokens), pos(0), jaTemDrawStart(jaTemDrawStart) {}
 
 std::shared_ptr<NoDePrograma> Parser::parse() {
@@ -53,6 +84,16 @@ std::shared_ptr<NoDeComando> Parser::parseComando() {
         return parseComandoDIM();
     } else if (encontrar(COMANDO, "END")) {
         return parseComandoEND();
+    } else if (encontrar(COMANDO, "CHECKPOINT")) {
+        return parseComandoCHECKPOINT();
+    } else if (encontrar(COMANDO, "LOAD")) {
+        return parseComandoLOAD();
+    } else if (encontrar(COMANDO, "SAVE")) {
+        return parseComandoSAVE();
+    } else if (encontrar(COMANDO, "PARALLEL")) {
+        return parseComandoPARALLEL();
+    } else if (encontrar(COMANDO, "NEXT")) {
+        return parseComandoNEXT();
     } else if (encontrar(COMANDO, "IF")) {
         return parseComandoIF();
     } else if (encontrar(COMANDO, "INPUT")) {
@@ -74,20 +115,9 @@ std::shared_ptr<NoDoComandoLET> Parser::parseComandoLET() {
     consumir(COMANDO, "LET");
     auto letStmt = std::make_shared<NoDoComandoLET>();
     letStmt->identificador = consumir(IDENTIFICADOR).value().value;
-    auto token = consumir(CHAVE_ESQUERDA, "", false);
-    if (token) {
-        // É uma variável indexada. Pode ter um INDENTIFIER ou um NUMBER e um RCHAVE
-        auto resultado = consumir(NUMERO, "",false);
-        if (!resultado.has_value()) {
-            // é uma variável indexando.
-            auto resultado2 = consumir(IDENTIFICADOR);
-            if (resultado2.has_value()) {
-                letStmt->posicao = resultado2.value().value;
-            }
-        } else {
-            letStmt->posicao = resultado.value().value;
-        }
-        consumir(CHAVE_DIREITA);
+    if (encontrar(CHAVE_ESQUERDA)) {
+        // É uma variável indexada
+        letStmt->indices = parseIndices();
     }
     consumir(OPERADOR, "=");
     letStmt->expressao = parseExpressao();
@@ -98,10 +128,121 @@ std::shared_ptr<NoDoComandoDIM> Parser::parseComandoDIM() {
     consumir(COMANDO, "DIM");
     auto dimStmt = std::make_shared<NoDoComandoDIM>();
     dimStmt->nomeVariavel = consumir(IDENTIFICADOR).value().value;
-    dimStmt->numeroOcorrencias = std::stoi(consumir(NUMERO).value().value);
+    dimStmt->numeroOcorrencias = 1;
+    do {
+        if (!dimStmt->dimensoes.empty()) {
+            consumir(VIRGULA);
+        }
+        std::string tamanho = consumir(NUMERO).value().value;
+        uint64_t dimensao = 0;
+        try {
+            size_t lidos = 0;
+            dimensao = std::stoull(tamanho, &lidos);
+            if (lidos != tamanho.size()) {
+                throw std::invalid_argument(tamanho);
+            }
+        } catch (const std::logic_error&) {
+            throw ParserException("Tamanho inválido para o DIM: " + tamanho);
+        }
+        if (dimensao != 0 && dimStmt->numeroOcorrencias > UINT64_MAX / dimensao) {
+            throw ParserException("Vetor grande demais: " + dimStmt->nomeVariavel);
+        }
+        dimStmt->dimensoes.push_back(dimensao);
+        dimStmt->numeroOcorrencias *= dimensao;
+    } while (encontrar(VIRGULA));
+    if (encontrar(IDENTIFICADOR, "AS")) {
+        consumir(IDENTIFICADOR, "AS");
+        std::string tipo = consumir(IDENTIFICADOR).value().value;
+        if (!Vetor::tipoPeloNome(tipo, dimStmt->tipo)) {
+            throw ParserException("Tipo inválido para o DIM: " + tipo + " (use BIT, INT8, INT32, FLOAT ou DOUBLE)");
+        }
+    }
+    if (encontrar(IDENTIFICADOR, "FILE")) {
+        if (dimStmt->tipo != TipoDeElemento::DOUBLE) {
+            throw ParserException("DIM ... FILE só guarda doubles: " + dimStmt->nomeVariavel);
+        }
+        consumir(IDENTIFICADOR, "FILE");
+        dimStmt->arquivo = consumir(LITERAL_TEXTO).value().value;
+        if (encontrar(IDENTIFICADOR, "RANDOM")) {
+            consumir(IDENTIFICADOR, "RANDOM");
+            dimStmt->acessoAleatorio = true;
+        }
+    }
     return dimStmt;
 }
 
+std::shared_ptr<NoDoComandoLOAD> Parser::parseComandoLOAD() {
+    consumir(COMANDO, "LOAD");
+    auto loadStmt = std::make_shared<NoDoComandoLOAD>();
+    loadStmt->nomeVariavel = consumir(IDENTIFICADOR).value().value;
+    consumir(IDENTIFICADOR, "FROM");
+    loadStmt->arquivo = consumir(LITERAL_TEXTO).value().value;
+    if (encontrar(IDENTIFICADOR, "COLUMN")) {
+        consumir(IDENTIFICADOR, "COLUMN");
+        std::string coluna = consumir(NUMERO).value().value;
+        unsigned long valor = 0;
+        try {
+            size_t lidos = 0;
+            valor = std::stoul(coluna, &lidos);
+            if (lidos != coluna.size() || valor == 0 || valor > UINT32_MAX) {
+                throw std::invalid_argument(coluna);
+            }
+        } catch (const std::logic_error&) {
+            throw ParserException("Coluna inválida para o LOAD: " + coluna);
+        }
+        loadStmt->coluna = static_cast<unsigned>(valor);
+    }
+    return loadStmt;
+}
+
+std::shared_ptr<NoDoComandoSAVE> Parser::parseComandoSAVE() {
+    consumir(COMANDO, "SAVE");
+    auto saveStmt = std::make_shared<NoDoComandoSAVE>();
+    do {
+        if (!saveStmt->nomes.empty()) {
+            consumir(VIRGULA);
+        }
+        saveStmt->nomes.push_back(consumir(IDENTIFICADOR).value().value);
+    } while (encontrar(VIRGULA));
+    saveStmt->slots.assign(saveStmt->nomes.size(), -1);
+    consumir(IDENTIFICADOR, "TO");
+    saveStmt->arquivo = consumir(LITERAL_TEXTO).value().value;
+    if (encontrar(IDENTIFICADOR, "ASYNC")) {
+        consumir(IDENTIFICADOR, "ASYNC");
+        saveStmt->assincrono = true;
+    }
+    return saveStmt;
+}
+
+std::shared_ptr<NoDoComandoPARALLEL> Parser::parseComandoPARALLEL() {
+    consumir(COMANDO, "PARALLEL");
+    consumir(IDENTIFICADOR, "FOR");
+    auto parallelStmt = std::make_shared<NoDoComandoPARALLEL>();
+    parallelStmt->contador = consumir(IDENTIFICADOR).value().value;
+    consumir(OPERADOR, "=");
+    parallelStmt->inicio = parseExpressao();
+    consumir(IDENTIFICADOR, "TO");
+    parallelStmt->fim = parseExpressao();
+    if (encontrar(IDENTIFICADOR, "REDUCE")) {
+        consumir(IDENTIFICADOR, "REDUCE");
+        do {
+            if (!parallelStmt->reducoes.empty()) {
+                consumir(VIRGULA);
+            }
+            parallelStmt->reducoes.push_back(consumir(IDENTIFICADOR).value().value);
+        } while (encontrar(VIRGULA));
+        parallelStmt->slotsReducoes.assign(parallelStmt->reducoes.size(), -1);
+    }
+    return parallelStmt;
+}
+
+std::shared_ptr<NoDoComandoNEXT> Parser::parseComandoNEXT() {
+    consumir(COMANDO, "NEXT");
+    auto nextStmt = std::make_shared<NoDoComandoNEXT>();
+    nextStmt->contador = consumir(IDENTIFICADOR).value().value;
+    return nextStmt;
+}
+
 std::shared_ptr<NoDoComandoPRINT> Parser::parseComandoPRINT() {
     consumir(COMANDO, "PRINT");
     auto printStmt = std::make_shared<NoDoComandoPRINT>();
@@ -129,6 +270,15 @@ std::shared_ptr<NoDoComandoEND> Parser::parseComandoEND() {
     return endStmt;
 }
 
+std::shared_ptr<NoDoComandoCHECKPOINT> Parser::parseComandoCHECKPOINT() {
+    consumir(COMANDO, "CHECKPOINT");
+    auto checkpointStmt = std::make_shared<NoDoComandoCHECKPOINT>();
+    if (encontrar(LITERAL_TEXTO)) {
+        checkpointStmt->arquivo = consumir(LITERAL_TEXTO).value().value;
+    }
+    return checkpointStmt;
+}
+
 std::shared_ptr<NoDoComandoIF> Parser::parseComandoIF() {
     consumir(COMANDO, "IF");
     auto ifStmt = std::make_shared<NoDoComandoIF>();
@@ -191,6 +341,7 @@ std::shared_ptr<NoDoComandoPLOT> Parser::parseComandoPLOT() {
     }
     consumir(COMANDO, "PLOT");
     auto plotStmt = std::make_shared<NoDoComandoPLOT>();
+    plotStmt->todos = consumirTodos();
     plotStmt->posicaoX = parseExpressao();
     consumir(VIRGULA);
     plotStmt->posicaoY = parseExpressao();
@@ -216,6 +367,7 @@ std::shared_ptr<NoDoComandoLINE> Parser::parseComandoLINE() {
     }
     consumir(COMANDO, "LINE");
     auto lineStmt = std::make_shared<NoDoComandoLINE>();
+    lineStmt->todos = consumirTodos();
     lineStmt->xInicial = parseExpressao();
     consumir(VIRGULA);
     lineStmt->yInicial = parseExpressao();
@@ -234,6 +386,7 @@ std::shared_ptr<NoDoComandoRECTANGLE> Parser::parseComandoRECTANGLE() {
     }
     consumir(COMANDO, "RECTANGLE");
     auto rectStmt = std::make_shared<NoDoComandoRECTANGLE>();
+    rectStmt->todos = consumirTodos();
     rectStmt->xCantoSuperiorEsquerdo = parseExpressao();
     consumir(VIRGULA);
     rectStmt->yCantoSuperiorEsquerdo = parseExpressao();
@@ -243,7 +396,8 @@ std::shared_ptr<NoDoComandoRECTANGLE> Parser::parseComandoRECTANGLE() {
     rectStmt->yCantoInferiorDireito = parseExpressao();
     consumir(VIRGULA);
     rectStmt->cor = consumir(IDENTIFICADOR).value().value;
-    if (tokens.size() == 14) {
+    // Com expressões nos atributos o número de tokens varia: o FILL vem depois da vírgula
+    if (encontrar(VIRGULA)) {
         consumir(VIRGULA);
         if (encontrar(IDENTIFICADOR, "FILL")) {
             rectStmt->preencher = true;
@@ -311,21 +465,14 @@ std::shared_ptr<NoDeExpressao> Parser::parseExponenciacao() {
 std::shared_ptr<NoDeExpressao> Parser::parsePrimaria() {
     std::shared_ptr<NoDeIdentificador> identifierNode;
     if (encontrar(NUMERO)) {
-        return std::make_shared<NoDeNumero>(consumir(NUMERO).value().value);
+        Token numero = consumir(NUMERO).value();
+        return std::make_shared<NoDeNumero>(numero.value, numero.numero);
     } else if (encontrar(IDENTIFICADOR)) {
         auto identifierToken = consumir(IDENTIFICADOR).value().value;
         identifierNode = std::make_shared<NoDeIdentificador>(identifierToken);
         if (encontrar(CHAVE_ESQUERDA)) {
             // é um indexador
-            consumir(CHAVE_ESQUERDA,"[");
-            identifierNode = std::make_shared<NoDeIdentificador>(identifierToken);
-            auto resultado = consumir(NUMERO,"",false);
-            if (!resultado) {
-                // é uma variável indexadora
-                resultado = consumir(IDENTIFICADOR);
-            }
-            identifierNode->posicao = resultado.value().value;
-            consumir(CHAVE_DIREITA,"]");
+            identifierNode->indices = parseIndices();
         } else if (encontrar(PARENTESIS_ESQUERDO)) {
             auto functionCall = std::make_shared<NoDeFuncao>(identifierToken);
             consumir(PARENTESIS_ESQUERDO);
@@ -366,6 +513,22 @@ std::shared_ptr<NoDeExpressao> Parser::parsePrimaria() {
     }
 }
 
+std::vector<IndiceDeVetor> Parser::parseIndices() {
+    // [I] ou [I + 1, J * 2, ...]: cada indexador é uma expressão
+    std::vector<IndiceDeVetor> indices;
+    consumir(CHAVE_ESQUERDA, "[");
+    do {
+        if (!indices.empty()) {
+            consumir(VIRGULA);
+        }
+        IndiceDeVetor indice;
+        indice.expressao = parseExpressao();
+        indices.push_back(indice);
+    } while (encontrar(VIRGULA));
+    consumir(CHAVE_DIREITA, "]");
+    return indices;
+}
+
 bool Parser::encontrar(TokenType type, const std::string& value) {
     if (pos < tokens.size() && tokens[pos].type == type && (value.empty() || tokens[pos].value == value)) {
         return true;
@@ -373,6 +536,14 @@ bool Parser::encontrar(TokenType type, const std::string& value) {
     return false;
 }
 
+bool Parser::consumirTodos() {
+    if (encontrar(IDENTIFICADOR, "ALL") && pos + 1 < tokens.size() && tokens[pos + 1].type != VIRGULA) {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
 std::optional<Token> Parser::consumir(TokenType type, const std::string& value, bool deveExistir) {
     if (encontrar(type, value)) {
         return tokens[pos++];
@@ -396,6 +567,7 @@ std::string Parser::tokenTypeName(TokenType type) {
         case VIRGULA: return "VIRGULA";
         case FIM_DE_LINHA: return "FIM_DE_LINHA";
         case ASPAS_DUPLAS: return "ASPAS_DUPLAS";
+        case LITERAL_TEXTO: return "LITERAL_TEXTO";
         default: return "DESCONHECIDO";
     }
 }
@@ -426,11 +598,36 @@ void mostrarAST(const std::shared_ptr<NoDaAST>& node, int indent) {
     } else if (auto dimStmt = std::dynamic_pointer_cast<NoDoComandoDIM>(node)) {
         std::cout << indentStr << "NoDoComandoDIM: "
         << dimStmt->nomeVariavel << " >> "
-        << dimStmt->numeroOcorrencias
+        << dimStmt->numeroOcorrencias << " (" << dimStmt->dimensoes.size() << " dimensões)"
+        << (dimStmt->tipo == TipoDeElemento::DOUBLE ? "" : std::string(" AS ") + Vetor::nomeDoTipo(dimStmt->tipo))
+        << (dimStmt->arquivo.empty() ? "" : " FILE " + dimStmt->arquivo)
         << std::endl;
     } else if (auto endStmt = std::dynamic_pointer_cast<NoDoComandoEND>(node)) {
         std::cout << indentStr << "NoDoComandoEND: "
         << std::endl;
+    } else if (auto loadStmt = std::dynamic_pointer_cast<NoDoComandoLOAD>(node)) {
+        std::cout << indentStr << "NoDoComandoLOAD: "
+        << loadStmt->nomeVariavel << " << " << loadStmt->arquivo
+        << (loadStmt->coluna == 0 ? "" : " COLUMN " + std::to_string(loadStmt->coluna))
+        << std::endl;
+    } else if (auto saveStmt = std::dynamic_pointer_cast<NoDoComandoSAVE>(node)) {
+        std::cout << indentStr << "NoDoComandoSAVE: ";
+        for (size_t k = 0; k < saveStmt->nomes.size(); ++k) {
+            std::cout << (k > 0 ? ", " : "") << saveStmt->nomes[k];
+        }
+        std::cout << " >> " << saveStmt->arquivo << (saveStmt->assincrono ? " ASYNC" : "") << std::endl;
+    } else if (auto parallelStmt = std::dynamic_pointer_cast<NoDoComandoPARALLEL>(node)) {
+        std::cout << indentStr << "NoDoComandoPARALLEL: " << parallelStmt->contador << std::endl;
+        mostrarAST(parallelStmt->inicio, indent + 2);
+        mostrarAST(parallelStmt->fim, indent + 2);
+        for (const auto& reducao : parallelStmt->reducoes) {
+            std::cout << indentStr << "  REDUCE " << reducao << std::endl;
+        }
+    } else if (auto nextStmt = std::dynamic_pointer_cast<NoDoComandoNEXT>(node)) {
+        std::cout << indentStr << "NoDoComandoNEXT: " << nextStmt->contador << std::endl;
+    } else if (auto checkpointStmt = std::dynamic_pointer_cast<NoDoComandoCHECKPOINT>(node)) {
+        std::cout << indentStr << "NoDoComandoCHECKPOINT: "
+        << checkpointStmt->arquivo << std::endl;
     } else if (auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(node)) {
         std::cout << indentStr << "NoDoComandoIF: "
         << ifStmt->operando1 << " " << ifStmt->operadorLogico
@@ -444,19 +641,19 @@ void mostrarAST(const std::shared_ptr<NoDaAST>& node, int indent) {
                   << drawStmt->altura << ", " << drawStmt->largura
                   << std::endl;
     } else if (auto plotStmt = std::dynamic_pointer_cast<NoDoComandoPLOT>(node)) {
-        std::cout << indentStr << "NoDoComandoPLOT: "
+        std::cout << indentStr << "NoDoComandoPLOT: " << (plotStmt->todos ? "ALL " : "")
                   << plotStmt->posicaoX << ", "
                   << plotStmt->posicaoY << ", " << plotStmt->cor
                   << ", " << plotStmt->preencher
                   << std::endl;
     } else if (auto lineStmt = std::dynamic_pointer_cast<NoDoComandoLINE>(node)) {
-        std::cout << indentStr << "NoDoComandoLINE: "
+        std::cout << indentStr << "NoDoComandoLINE: " << (lineStmt->todos ? "ALL " : "")
                   << lineStmt->xInicial << ", "
                   << lineStmt->yInicial << ", " << lineStmt->xFinal
                   << ", " << lineStmt->yFinal << ", " << lineStmt->cor
                   << std::endl;
     } else if (auto rectStmt = std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(node)) {
-        std::cout << indentStr << "NoDoComandoRECTANGLE: "
+        std::cout << indentStr << "NoDoComandoRECTANGLE: " << (rectStmt->todos ? "ALL " : "")
                   << rectStmt->xCantoSuperiorEsquerdo << ", "
                   << rectStmt->yCantoSuperiorEsquerdo << ", " << rectStmt->xCantoInferiorDireito
                   << ", " << rectStmt->yCantoInferiorDireito << ", " << rectStmt->cor
@@ -475,5 +672,8 @@ void mostrarAST(const std::shared_ptr<NoDaAST>& node, int indent) {
         for (const auto& arg : functionCall->argumentos) {
             mostrarAST(arg, indent + 2);
         }
+    } else if (auto temporario = std::dynamic_pointer_cast<NoDeTemporario>(node)) {
+        std::cout << indentStr << "NoDeTemporario: T" << temporario->indice << std::endl;
+        mostrarAST(temporario->expressao, indent + 2);
     }
 }
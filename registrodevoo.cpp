@@ -0,0 +1,177 @@
+#include "RegistroDeVoo.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    const char marca[8] = {'S', 'I', 'B', 'T', 'R', 'A', 'C', 'E'};
+    constexpr uint64_t ordemDosBytes = 0x0102030405060708ULL;
+    // Limite para tamanhos lidos do arquivo: acima disso ele está corrompido
+    constexpr uint64_t tamanhoMaximo = 1u << 30;
+
+    using Arquivo = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+    void escrever(std::FILE* arquivo, const void* dados, size_t bytes, const std::string& caminho) {
+        if (std::fwrite(dados, 1, bytes, arquivo) != bytes) {
+            throw std::runtime_error("Falha ao gravar registro de execução: " + caminho + ": " + std::strerror(errno));
+        }
+    }
+
+    void escrever(std::FILE* arquivo, uint64_t valor, const std::string& caminho) {
+        escrever(arquivo, &valor, sizeof(valor), caminho);
+    }
+
+    void escrever(std::FILE* arquivo, const std::string& texto, const std::string& caminho) {
+        escrever(arquivo, static_cast<uint64_t>(texto.size()), caminho);
+        escrever(arquivo, texto.data(), texto.size(), caminho);
+    }
+
+    void ler(std::FILE* arquivo, void* dados, size_t bytes, const std::string& caminho) {
+        if (std::fread(dados, 1, bytes, arquivo) != bytes) {
+            throw std::runtime_error("Registro de execução incompleto ou corrompido: " + caminho);
+        }
+    }
+
+    uint64_t lerInteiro(std::FILE* arquivo, const std::string& caminho) {
+        uint64_t valor;
+        ler(arquivo, &valor, sizeof(valor), caminho);
+        return valor;
+    }
+
+    // Quantidade ou tamanho de texto: um valor absurdo vem de arquivo corrompido
+    uint64_t lerTamanho(std::FILE* arquivo, const std::string& caminho) {
+        uint64_t valor = lerInteiro(arquivo, caminho);
+        if (valor > tamanhoMaximo) {
+            throw std::runtime_error("Registro de execução incompleto ou corrompido: " + caminho);
+        }
+        return valor;
+    }
+
+    std::string lerTexto(std::FILE* arquivo, const std::string& caminho) {
+        std::string texto(lerTamanho(arquivo, caminho), '\0');
+        ler(arquivo, texto.data(), texto.size(), caminho);
+        return texto;
+    }
+
+    std::string nomeOuIndice(const std::vector<std::string>& nomes, uint32_t indice) {
+        return indice < nomes.size() ? nomes[indice] : "#" + std::to_string(indice);
+    }
+}
+
+RegistroDeVoo::RegistroDeVoo(size_t capacidade) {
+    size_t tamanho = 1;
+    while (tamanho < capacidade) {
+        tamanho <<= 1;
+    }
+    eventos.resize(tamanho);
+    mascara = tamanho - 1;
+}
+
+void RegistroDeVoo::gravar(const std::string& caminho, const std::string& motivo, const NoDePrograma& programa) const {
+    Arquivo arquivo(std::fopen(caminho.c_str(), "wb"), std::fclose);
+    if (!arquivo) {
+        throw std::runtime_error("Falha ao criar registro de execução: " + caminho + ": " + std::strerror(errno));
+    }
+    std::FILE* saida = arquivo.get();
+    escrever(saida, marca, sizeof(marca), caminho);
+    escrever(saida, ordemDosBytes, caminho);
+    escrever(saida, programa.hashDoFonte, caminho);
+    escrever(saida, motivo, caminho);
+    escrever(saida, static_cast<uint64_t>(programa.comandos.size()), caminho);
+    for (const auto& comando : programa.comandos) {
+        escrever(saida, static_cast<const NoDeComando*>(comando.get())->numeroLinha, caminho);
+    }
+    escrever(saida, static_cast<uint64_t>(programa.simbolos->tamanho()), caminho);
+    for (size_t slot = 0; slot < programa.simbolos->tamanho(); ++slot) {
+        escrever(saida, programa.simbolos->nome(static_cast<int>(slot)), caminho);
+    }
+    // Do mais antigo ao mais recente: depois de dar a volta, o mais antigo está na posição do próximo
+    uint64_t quantidade = total < eventos.size() ? total : eventos.size();
+    escrever(saida, total, caminho);
+    escrever(saida, quantidade, caminho);
+    for (uint64_t k = total - quantidade; k < total; ++k) {
+        escrever(saida, &eventos[k & mascara], sizeof(Evento), caminho);
+    }
+    if (std::fflush(saida) != 0) {
+        throw std::runtime_error("Falha ao gravar registro de execução: " + caminho + ": " + std::strerror(errno));
+    }
+}
+
+void RegistroDeVoo::decodificar(const std::string& caminho, std::ostream& saida) {
+    Arquivo arquivo(std::fopen(caminho.c_str(), "rb"), std::fclose);
+    if (!arquivo) {
+        throw std::runtime_error("Falha ao abrir registro de execução: " + caminho + ": " + std::strerror(errno));
+    }
+    std::FILE* entrada = arquivo.get();
+    char lida[sizeof(marca)];
+    ler(entrada, lida, sizeof(lida), caminho);
+    if (std::memcmp(lida, marca, sizeof(marca)) != 0) {
+        throw std::runtime_error("Arquivo não é um registro de execução do SiBasic: " + caminho);
+    }
+    if (lerInteiro(entrada, caminho) != ordemDosBytes) {
+        throw std::runtime_error("Registro gravado em uma máquina com outra ordem de bytes: " + caminho);
+    }
+    uint64_t hash = lerInteiro(entrada, caminho);
+    std::string motivo = lerTexto(entrada, caminho);
+    std::vector<std::string> linhas;
+    for (uint64_t k = lerTamanho(entrada, caminho); k > 0; --k) {
+        linhas.push_back(lerTexto(entrada, caminho));
+    }
+    std::vector<std::string> nomes;
+    for (uint64_t k = lerTamanho(entrada, caminho); k > 0; --k) {
+        nomes.push_back(lerTexto(entrada, caminho));
+    }
+    uint64_t total = lerInteiro(entrada, caminho);
+    uint64_t quantidade = lerTamanho(entrada, caminho);
+
+    saida << "Registro de execução: " << motivo << std::endl;
+    char hashEmTexto[20];
+    std::snprintf(hashEmTexto, sizeof(hashEmTexto), "%016llx", static_cast<unsigned long long>(hash));
+    saida << "Fonte " << hashEmTexto << ", " << linhas.size() << " comandos, " << total << " eventos (últimos "
+          << quantidade << ")" << std::endl;
+    for (uint64_t k = 0; k < quantidade; ++k) {
+        Evento evento;
+        ler(entrada, &evento, sizeof(evento), caminho);
+        switch (evento.tipo) {
+            case COMANDO:
+                saida << "linha " << nomeOuIndice(linhas, evento.indice) << std::endl;
+                break;
+            case DESVIO:
+                saida << "    desvio para a linha " << nomeOuIndice(linhas, static_cast<uint32_t>(evento.extra))
+                      << std::endl;
+                break;
+            case ESCRITA:
+                saida << "    " << nomeOuIndice(nomes, evento.indice) << " = " << evento.valor << std::endl;
+                break;
+            case ESCRITA_INTEIRA:
+                saida << "    " << nomeOuIndice(nomes, evento.indice) << " = " << static_cast<int64_t>(evento.extra)
+                      << std::endl;
+                break;
+            case ESCRITA_VETOR:
+                // Posição linear, base zero, como em Vetor
+                saida << "    " << nomeOuIndice(nomes, evento.indice) << "[#" << evento.extra << "] = "
+                      << evento.valor << std::endl;
+                break;
+            default:
+                throw std::runtime_error("Registro de execução incompleto ou corrompido: " + caminho);
+        }
+    }
+}
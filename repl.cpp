@@ -0,0 +1,264 @@
+#include "Repl.h"
+#include "Lexer.h"
+#include "Interpreter.h"
+#include "Resolvedor.h"
+#include "Otimizador.h"
+#include "util.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    // Lê um intervalo de linhas: "10", "10-50", "-50" ou "10-". Vazio é o programa inteiro.
+    bool lerIntervalo(const std::string& texto, long& primeira, long& ultima) {
+        primeira = 0;
+        ultima = LONG_MAX;
+        if (texto.empty()) {
+            return true;
+        }
+        size_t traco = texto.find('-');
+        char* fim = nullptr;
+        if (traco == std::string::npos) {
+            primeira = ultima = std::strtol(texto.c_str(), &fim, 10);
+            return *fim == '\0';
+        }
+        std::string antes = texto.substr(0, traco);
+        std::string depois = texto.substr(traco + 1);
+        if (!antes.empty()) {
+            primeira = std::strtol(antes.c_str(), &fim, 10);
+            if (*fim != '\0') {
+                return false;
+            }
+        }
+        if (!depois.empty()) {
+            ultima = std::strtol(depois.c_str(), &fim, 10);
+            if (*fim != '\0') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string semEspacos(const std::string& texto) {
+        std::string resultado;
+        for (char c : texto) {
+            if (!std::isspace(static_cast<unsigned char>(c))) {
+                resultado += c;
+            }
+        }
+        return resultado;
+    }
+}
+
+Repl::Repl(std::string basicScriptName)
+    : basicScriptName(basicScriptName), programa(std::make_shared<NoDePrograma>()), remontar(false), analisado(false) {}
+
+void Repl::carregar(const std::string& fonte) {
+    std::istringstream inputStream(fonte);
+    std::string linha;
+    while (std::getline(inputStream, linha)) {
+        processarLinha(linha);
+    }
+}
+
+void Repl::executar(std::istream& entrada) {
+    std::string linha;
+    std::cout << "> " << std::flush;
+    while (std::getline(entrada, linha)) {
+        if (!processarLinha(linha)) {
+            break;
+        }
+        std::cout << "> " << std::flush;
+    }
+}
+
+bool Repl::processarLinha(const std::string& texto) {
+    std::string linha = texto;
+    if (!linha.empty() && linha.back() == '\r') {
+        linha.pop_back();
+    }
+    size_t inicio = linha.find_first_not_of(" \t");
+    if (inicio == std::string::npos || linha[inicio] == '*') {
+        // Linha vazia ou comentário
+        return true;
+    }
+    linha = linha.substr(inicio);
+    linha = paraMaiusculas(linha);
+
+    if (std::isdigit(static_cast<unsigned char>(linha[0]))) {
+        char* fim = nullptr;
+        long numero = std::strtol(linha.c_str(), &fim, 10);
+        std::string resto = fim;
+        if (resto.find_first_not_of(" \t") == std::string::npos) {
+            // Só o número: apaga a linha, como nos BASIC clássicos
+            apagarLinhas(numero, numero);
+        } else {
+            editarLinha(numero, std::to_string(numero) + resto);
+        }
+        return true;
+    }
+
+    std::istringstream comandoStream(linha);
+    std::string comando;
+    comandoStream >> comando;
+    std::string argumentos;
+    std::getline(comandoStream, argumentos);
+    argumentos = semEspacos(argumentos);
+
+    long primeira, ultima;
+    if (comando == "RUN") {
+        run();
+    } else if (comando == "LIST") {
+        if (!lerIntervalo(argumentos, primeira, ultima)) {
+            std::cerr << "Intervalo inválido: " << argumentos << std::endl;
+        } else {
+            listar(primeira, ultima);
+        }
+    } else if (comando == "DELETE") {
+        if (argumentos.empty() || !lerIntervalo(argumentos, primeira, ultima)) {
+            std::cerr << "Intervalo inválido: " << argumentos << std::endl;
+        } else {
+            apagarLinhas(primeira, ultima);
+        }
+    } else if (comando == "NEW") {
+        linhas.clear();
+        programa = std::make_shared<NoDePrograma>();
+        remontar = false;
+        analisado = false;
+    } else if (comando == "EXIT" || comando == "QUIT" || comando == "BYE") {
+        return false;
+    } else {
+        std::cerr << "Comando desconhecido: " << comando << std::endl;
+    }
+    return true;
+}
+
+void Repl::editarLinha(long numero, const std::string& linha) {
+    LinhaDoPrograma novaLinha{linha, {}};
+    try {
+        Lexer lexer{};
+        std::vector<Token> tokens = lexer.tokenize(linha);
+        // A ordem de DRAW START / FINISH só é conhecida no RUN; aqui cada linha é analisada isoladamente
+        bool drawStart = tokens.size() > 2 && tokens[1].type == COMANDO && tokens[1].value == "DRAW"
+                         && tokens[2].value == "START";
+        Parser parser(tokens, !drawStart);
+        novaLinha.comandos = parser.parse()->comandos;
+    } catch (const LexerException& e) {
+        std::cerr << "Erro de lexer: " << e.what() << std::endl;
+        return;
+    } catch (const ParserException& e) {
+        std::cerr << "Erro de parser: " << e.what() << std::endl;
+        return;
+    }
+
+    auto existente = linhas.find(numero);
+    if (existente != linhas.end() && !remontar
+        && existente->second.comandos.size() == novaLinha.comandos.size()) {
+        // Mesma linha, mesmo número de comandos: troca no lugar, o índice de linhas continua válido
+        int index = programa->indiceDaLinha(std::to_string(numero));
+        for (size_t k = 0; k < novaLinha.comandos.size(); ++k) {
+            programa->comandos[index + k] = novaLinha.comandos[k];
+        }
+    } else {
+        remontar = true;
+    }
+    linhas[numero] = std::move(novaLinha);
+    analisado = false;
+}
+
+void Repl::apagarLinhas(long primeira, long ultima) {
+    auto inicio = linhas.lower_bound(primeira);
+    auto fim = linhas.upper_bound(ultima);
+    if (inicio != fim) {
+        linhas.erase(inicio, fim);
+        remontar = true;
+        analisado = false;
+    }
+}
+
+void Repl::listar(long primeira, long ultima) {
+    auto fim = linhas.upper_bound(ultima);
+    for (auto linha = linhas.lower_bound(primeira); linha != fim; ++linha) {
+        std::cout << linha->second.fonte << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void Repl::montarPrograma() {
+    // Só copia os ponteiros dos comandos já analisados, na ordem dos números de linha
+    auto novoPrograma = std::make_shared<NoDePrograma>();
+    novoPrograma->comandos.reserve(linhas.size());
+    for (const auto& [numero, linha] : linhas) {
+        novoPrograma->comandos.insert(novoPrograma->comandos.end(), linha.comandos.begin(), linha.comandos.end());
+    }
+    novoPrograma->indexarLinhas();
+    programa = novoPrograma;
+    remontar = false;
+}
+
+void Repl::validarDesenhos() {
+    // As mesmas regras que o Parser aplica quando lê um arquivo inteiro
+    bool jaTemDrawStart = false;
+    for (const auto& comando : programa->comandos) {
+        if (auto drawStmt = std::dynamic_pointer_cast<NoDoComandoDRAW>(comando)) {
+            if (drawStmt->tipo == "START") {
+                if (jaTemDrawStart) {
+                    throw ParserException("Dois DRAW START!");
+                }
+                jaTemDrawStart = true;
+            } else {
+                if (!jaTemDrawStart) {
+                    throw ParserException("Draw FINISH sem DRAW START!");
+                }
+                jaTemDrawStart = false;
+            }
+        } else if (!jaTemDrawStart && (std::dynamic_pointer_cast<NoDoComandoPLOT>(comando)
+                                       || std::dynamic_pointer_cast<NoDoComandoLINE>(comando)
+                                       || std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando))) {
+            throw ParserException("Comando de desenho sem DRAW START na linha "
+                                  + std::static_pointer_cast<NoDeComando>(comando)->numeroLinha);
+        }
+    }
+}
+
+void Repl::run() {
+    if (remontar) {
+        montarPrograma();
+    }
+    try {
+        if (!analisado) {
+            validarDesenhos();
+            // Linhas trocadas no lugar também precisam de slots e da validação dos índices;
+            // os temporários da execução anterior são desfeitos antes de resolver de novo
+            Otimizador::restaurar(*programa);
+            Resolvedor(*programa).resolver();
+            Otimizador(*programa).otimizar();
+            analisado = true;
+        }
+        Interpreter interpreter(basicScriptName);
+        interpreter.executar(programa);
+    } catch (const ParserException& e) {
+        std::cerr << "Erro de parser: " << e.what() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Erro de interpreter: " << e.what() << std::endl;
+    }
+}
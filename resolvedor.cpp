@@ -0,0 +1,555 @@
+#include "Resolvedor.h"
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <sstream>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+namespace {
+    // Variável simples (sem índices) com o nome dado
+    bool ehVariavel(const NoDaASTPtr& expressao, const std::string& nome) {
+        auto identificador = std::dynamic_pointer_cast<NoDeIdentificador>(expressao);
+        return identificador && identificador->indices.empty() && identificador->name == nome;
+    }
+
+    // Reconhece V, V + c, c + V e V - c, com c literal
+    bool deslocamentoDoContador(const NoDaASTPtr& expressao, const std::string& contador, double& deslocamento) {
+        if (ehVariavel(expressao, contador)) {
+            deslocamento = 0;
+            return true;
+        }
+        auto binaria = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao);
+        if (!binaria || (binaria->op != "+" && binaria->op != "-")) {
+            return false;
+        }
+        auto numero = std::dynamic_pointer_cast<NoDeNumero>(binaria->right);
+        if (ehVariavel(binaria->left, contador) && numero) {
+            deslocamento = binaria->op == "+" ? numero->valor : -numero->valor;
+            return true;
+        }
+        numero = std::dynamic_pointer_cast<NoDeNumero>(binaria->left);
+        if (binaria->op == "+" && numero && ehVariavel(binaria->right, contador)) {
+            deslocamento = numero->valor;
+            return true;
+        }
+        return false;
+    }
+
+    // Literal que cabe em um inteiro de 64 bits (sem ponto decimal)
+    bool literalInteiro(const std::string& texto) {
+        int64_t valor = 0;
+        auto [fim, erro] = std::from_chars(texto.data(), texto.data() + texto.size(), valor);
+        return erro == std::errc() && fim == texto.data() + texto.size();
+    }
+
+    // Destino de um desvio (GOTO ou IF), ou -1
+    int destinoDoDesvio(const NoDePrograma& programa, const NoDaASTPtr& comando) {
+        if (auto gotoStmt = std::dynamic_pointer_cast<NoDoComandoGOTO>(comando)) {
+            return programa.indiceDaLinha(gotoStmt->numeroLinhaDesvio);
+        } else if (auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(comando)) {
+            return programa.indiceDaLinha(ifStmt->numeroLinha);
+        }
+        return -1;
+    }
+}
+
+Resolvedor::Resolvedor(NoDePrograma& programa) : programa(programa) {}
+
+void Resolvedor::resolver() {
+    // Um vetor com mais de um DIM só tem as dimensões conhecidas em execução
+    std::unordered_map<std::string, int> numeroDeDims;
+    dimensoesConhecidas.clear();
+    for (const auto& comando : programa.comandos) {
+        if (auto dimStmt = std::dynamic_pointer_cast<NoDoComandoDIM>(comando)) {
+            if (++numeroDeDims[dimStmt->nomeVariavel] == 1) {
+                dimensoesConhecidas[dimStmt->nomeVariavel] = dimStmt->dimensoes;
+            } else {
+                dimensoesConhecidas.erase(dimStmt->nomeVariavel);
+            }
+        }
+    }
+    // LOAD de um vetor com DIM não muda as dimensões: o Interpreter exige o DIM antes dele
+    for (const auto& comando : programa.comandos) {
+        if (auto loadStmt = std::dynamic_pointer_cast<NoDoComandoLOAD>(comando)) {
+            loadStmt->declarado = numeroDeDims.count(loadStmt->nomeVariavel) > 0;
+        }
+    }
+
+    programa.lacos.clear();
+    usaInteiros = false;
+    leitores.clear();
+    for (comandoAtual = 0; comandoAtual < static_cast<int>(programa.comandos.size()); ++comandoAtual) {
+        resolverComando(programa.comandos[comandoAtual]);
+    }
+    programa.usaInteiros = usaInteiros;
+    ligarParalelos();
+    reconhecerLacos();
+}
+
+int Resolvedor::resolverNome(const std::string& nome, bool indexado, const std::string& numeroLinha) {
+    if (TabelaDeSimbolos::inteira(nome)) {
+        if (indexado) {
+            throw ParserException("Linha " + numeroLinha + ": Variável inteira não pode ser um vetor: " + nome);
+        }
+        usaInteiros = true;
+    }
+    return programa.simbolos->slot(nome);
+}
+
+void Resolvedor::resolverComando(const NoDaASTPtr& comando) {
+    auto statement = std::static_pointer_cast<NoDeComando>(comando);
+    statement->inicioDeLaco = -1;
+    const std::string& linha = statement->numeroLinha;
+    if (auto letStmt = std::dynamic_pointer_cast<NoDoComandoLET>(comando)) {
+        letStmt->slot = resolverNome(letStmt->identificador, !letStmt->indices.empty(), linha);
+        letStmt->inteira = TabelaDeSimbolos::inteira(letStmt->identificador);
+        resolverIndices(letStmt->identificador, letStmt->indices, linha);
+        Tipo tipo = resolverExpressao(letStmt->expressao, linha);
+        if (letStmt->inteira && tipo == Tipo::LITERAL_INTEIRO) {
+            // LET I% = 10: avaliado direto como inteiro
+            std::static_pointer_cast<NoDeExpressao>(letStmt->expressao)->inteira = true;
+        }
+    } else if (auto printStmt = std::dynamic_pointer_cast<NoDoComandoPRINT>(comando)) {
+        if (!printStmt->printLiteral) {
+            resolverExpressao(printStmt->expressao, linha);
+        }
+    } else if (auto dimStmt = std::dynamic_pointer_cast<NoDoComandoDIM>(comando)) {
+        dimStmt->slot = resolverNome(dimStmt->nomeVariavel, true, linha);
+    } else if (auto loadStmt = std::dynamic_pointer_cast<NoDoComandoLOAD>(comando)) {
+        loadStmt->slot = resolverNome(loadStmt->nomeVariavel, true, linha);
+    } else if (auto parallelStmt = std::dynamic_pointer_cast<NoDoComandoPARALLEL>(comando)) {
+        parallelStmt->slotContador = resolverNome(parallelStmt->contador, false, linha);
+        resolverExpressao(parallelStmt->inicio, linha);
+        resolverExpressao(parallelStmt->fim, linha);
+        for (size_t k = 0; k < parallelStmt->reducoes.size(); ++k) {
+            parallelStmt->slotsReducoes[k] = resolverNome(parallelStmt->reducoes[k], false, linha);
+        }
+    } else if (auto saveStmt = std::dynamic_pointer_cast<NoDoComandoSAVE>(comando)) {
+        for (size_t k = 0; k < saveStmt->nomes.size(); ++k) {
+            saveStmt->slots[k] = resolverNome(saveStmt->nomes[k], true, linha);
+        }
+    } else if (auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(comando)) {
+        ifStmt->fimDeLaco = -1;
+        Tipo tipo1 = resolverExpressao(ifStmt->operando1, linha);
+        Tipo tipo2 = resolverExpressao(ifStmt->operando2, linha);
+        // IF I% < 100: comparação exata entre inteiros
+        if (tipo1 == Tipo::INTEIRO && tipo2 == Tipo::LITERAL_INTEIRO) {
+            std::static_pointer_cast<NoDeExpressao>(ifStmt->operando2)->inteira = true;
+        } else if (tipo1 == Tipo::LITERAL_INTEIRO && tipo2 == Tipo::INTEIRO) {
+            std::static_pointer_cast<NoDeExpressao>(ifStmt->operando1)->inteira = true;
+        }
+    } else if (auto inputStmt = std::dynamic_pointer_cast<NoDoComandoINPUT>(comando)) {
+        inputStmt->slot = resolverNome(inputStmt->identificador, false, linha);
+        inputStmt->inteira = TabelaDeSimbolos::inteira(inputStmt->identificador);
+    } else if (auto drawStmt = std::dynamic_pointer_cast<NoDoComandoDRAW>(comando)) {
+        resolverExpressao(drawStmt->altura, linha);
+        resolverExpressao(drawStmt->largura, linha);
+    } else if (auto plotStmt = std::dynamic_pointer_cast<NoDoComandoPLOT>(comando)) {
+        resolverExpressao(plotStmt->posicaoX, linha);
+        resolverExpressao(plotStmt->posicaoY, linha);
+        resolverExpressao(plotStmt->espessura, linha);
+    } else if (auto lineStmt = std::dynamic_pointer_cast<NoDoComandoLINE>(comando)) {
+        resolverExpressao(lineStmt->xInicial, linha);
+        resolverExpressao(lineStmt->yInicial, linha);
+        resolverExpressao(lineStmt->xFinal, linha);
+        resolverExpressao(lineStmt->yFinal, linha);
+    } else if (auto rectStmt = std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando)) {
+        resolverExpressao(rectStmt->xCantoSuperiorEsquerdo, linha);
+        resolverExpressao(rectStmt->yCantoSuperiorEsquerdo, linha);
+        resolverExpressao(rectStmt->xCantoInferiorDireito, linha);
+        resolverExpressao(rectStmt->yCantoInferiorDireito, linha);
+    }
+}
+
+Resolvedor::Tipo Resolvedor::resolverExpressao(const NoDaASTPtr& expressao, const std::string& numeroLinha) {
+    if (!expressao) {
+        return Tipo::REAL;
+    }
+    Tipo tipo = Tipo::REAL;
+    if (auto numberNode = std::dynamic_pointer_cast<NoDeNumero>(expressao)) {
+        tipo = literalInteiro(numberNode->value) ? Tipo::LITERAL_INTEIRO : Tipo::REAL;
+    } else if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+        identifierNode->slot = resolverNome(identifierNode->name, !identifierNode->indices.empty(), numeroLinha);
+        if (identifierNode->indices.empty()) {
+            leitores[identifierNode->name].insert(comandoAtual);
+        }
+        resolverIndices(identifierNode->name, identifierNode->indices, numeroLinha);
+        tipo = TabelaDeSimbolos::inteira(identifierNode->name) ? Tipo::INTEIRO : Tipo::REAL;
+    } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+        Tipo esquerda = resolverExpressao(binaryExpr->left, numeroLinha);
+        Tipo direita = resolverExpressao(binaryExpr->right, numeroLinha);
+        // "/" e "^" sempre produzem real, como nos BASIC clássicos
+        if (binaryExpr->op != "+" && binaryExpr->op != "-" && binaryExpr->op != "*") {
+            tipo = Tipo::REAL;
+        } else if (esquerda == Tipo::REAL || direita == Tipo::REAL) {
+            tipo = Tipo::REAL;
+        } else if (esquerda == Tipo::INTEIRO || direita == Tipo::INTEIRO) {
+            tipo = Tipo::INTEIRO;
+        } else {
+            tipo = Tipo::LITERAL_INTEIRO;
+        }
+    } else if (auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao)) {
+        for (const auto& argumento : functionCall->argumentos) {
+            resolverExpressao(argumento, numeroLinha);
+        }
+    }
+    // Expressões só com literais continuam reais: o comportamento delas não muda
+    std::static_pointer_cast<NoDeExpressao>(expressao)->inteira = tipo == Tipo::INTEIRO;
+    return tipo;
+}
+
+void Resolvedor::resolverIndices(const std::string& vetor, std::vector<IndiceDeVetor>& indices,
+                                 const std::string& numeroLinha) {
+    auto dimensoes = dimensoesConhecidas.find(vetor);
+    for (size_t k = 0; k < indices.size(); ++k) {
+        IndiceDeVetor& indice = indices[k];
+        indice.verificado = false;
+        indice.laco = -1;
+        resolverExpressao(indice.expressao, numeroLinha);
+        auto numero = std::dynamic_pointer_cast<NoDeNumero>(indice.expressao);
+        if (!numero || dimensoes == dimensoesConhecidas.end() || dimensoes->second.size() != indices.size()) {
+            // Número de índices errado continua sendo erro de execução, como antes
+            continue;
+        }
+        double valor = numero->valor;
+        if (!(valor >= 1 && valor < static_cast<double>(dimensoes->second[k]) + 1)) {
+            std::ostringstream oss;
+            oss << "Linha " << numeroLinha << ": Posicao invalida para o vetor: " << vetor << " >> " << numero->value;
+            throw ParserException(oss.str());
+        }
+        indice.verificado = true;
+    }
+}
+
+void Resolvedor::ligarParalelos() {
+    const auto& comandos = programa.comandos;
+    int n = static_cast<int>(comandos.size());
+    // Para cada comando do corpo de um PARALLEL FOR (incluindo o NEXT), a posição do PARALLEL
+    std::vector<int> paraleloDoComando(n, -1);
+    for (int index = 0; index < n; ++index) {
+        auto comando = std::static_pointer_cast<NoDeComando>(comandos[index]);
+        auto parallelStmt = std::dynamic_pointer_cast<NoDoComandoPARALLEL>(comandos[index]);
+        if (!parallelStmt) {
+            if (std::dynamic_pointer_cast<NoDoComandoNEXT>(comandos[index])) {
+                throw ParserException("Linha " + comando->numeroLinha + ": NEXT sem PARALLEL FOR");
+            }
+            continue;
+        }
+        int next = index + 1;
+        for (; next < n && !std::dynamic_pointer_cast<NoDoComandoNEXT>(comandos[next]); ++next) {
+            if (!std::dynamic_pointer_cast<NoDoComandoLET>(comandos[next])) {
+                throw ParserException("Linha " + std::static_pointer_cast<NoDeComando>(comandos[next])->numeroLinha
+                                      + ": o corpo do PARALLEL FOR só pode ter LET");
+            }
+        }
+        if (next == n) {
+            throw ParserException("Linha " + comando->numeroLinha + ": PARALLEL FOR sem NEXT");
+        }
+        auto nextStmt = std::static_pointer_cast<NoDoComandoNEXT>(comandos[next]);
+        if (nextStmt->contador != parallelStmt->contador) {
+            throw ParserException("Linha " + nextStmt->numeroLinha + ": esperado NEXT " + parallelStmt->contador);
+        }
+        parallelStmt->corpo = index + 1;
+        parallelStmt->next = next;
+        for (int corpo = index + 1; corpo <= next; ++corpo) {
+            paraleloDoComando[corpo] = index;
+        }
+        verificarParalelo(*parallelStmt, index);
+        index = next;
+    }
+    // O corpo só começa pelo PARALLEL FOR: as voltas são contadas por ele
+    for (int index = 0; index < n; ++index) {
+        int destino = destinoDoDesvio(programa, comandos[index]);
+        if (destino >= 0 && paraleloDoComando[destino] >= 0 && paraleloDoComando[index] != paraleloDoComando[destino]) {
+            throw ParserException("Linha " + std::static_pointer_cast<NoDeComando>(comandos[index])->numeroLinha
+                                  + ": desvio para dentro do PARALLEL FOR da linha "
+                                  + std::static_pointer_cast<NoDeComando>(comandos[paraleloDoComando[destino]])->numeroLinha);
+        }
+    }
+}
+
+void Resolvedor::verificarParalelo(NoDoComandoPARALLEL& paralelo, int inicio) {
+    // As voltas rodam em qualquer ordem, cada thread com as suas variáveis simples. Por isso:
+    // - uma variável simples alterada no corpo deve ser escrita antes de ser lida em cada volta
+    //   (senão leria o valor da volta anterior) e não pode ser lida fora do corpo;
+    // - todo acesso a um vetor alterado no corpo deve ter o contador sozinho em um mesmo índice
+    //   (A[I], M[I, J]): voltas diferentes alteram elementos diferentes;
+    // - as variáveis do REDUCE só aparecem em LET S = S + <expressão sem S>.
+    const auto& comandos = programa.comandos;
+    const std::string& contador = paralelo.contador;
+    auto erro = [](const std::string& linha, const std::string& mensagem) {
+        return ParserException("Linha " + linha + ": " + mensagem);
+    };
+    std::unordered_set<std::string> reducoes(paralelo.reducoes.begin(), paralelo.reducoes.end());
+    for (const std::string& reducao : paralelo.reducoes) {
+        if (reducao == contador || TabelaDeSimbolos::inteira(reducao)) {
+            throw erro(paralelo.numeroLinha, "REDUCE só aceita variáveis reais diferentes do contador: " + reducao);
+        }
+    }
+
+    std::unordered_set<std::string> escritasNoCorpo;
+    for (int index = inicio + 1; index < paralelo.next; ++index) {
+        auto letStmt = std::static_pointer_cast<NoDoComandoLET>(comandos[index]);
+        if (letStmt->indices.empty() && !reducoes.count(letStmt->identificador)) {
+            escritasNoCorpo.insert(letStmt->identificador);
+        }
+    }
+
+    std::unordered_set<std::string> escritasNestaVolta;
+    // Vetor -> posições dos índices em que todos os acessos até aqui têm o contador sozinho
+    std::unordered_map<std::string, std::vector<bool>> posicoesDoContador;
+    std::unordered_set<std::string> vetoresEscritos;
+    std::string linha;
+    auto acessarVetor = [&](const std::string& vetor, const std::vector<IndiceDeVetor>& indices) {
+        std::vector<bool> posicoes(indices.size());
+        for (size_t k = 0; k < indices.size(); ++k) {
+            posicoes[k] = ehVariavel(indices[k].expressao, contador);
+        }
+        auto [existente, novo] = posicoesDoContador.emplace(vetor, posicoes);
+        if (!novo) {
+            for (size_t k = 0; k < existente->second.size(); ++k) {
+                existente->second[k] = existente->second[k] && k < posicoes.size() && posicoes[k];
+            }
+        }
+    };
+    std::function<void(const NoDaASTPtr&)> ler = [&](const NoDaASTPtr& expressao) {
+        if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+            if (identifierNode->indices.empty()) {
+                if (reducoes.count(identifierNode->name)) {
+                    throw erro(linha, identifierNode->name + ", do REDUCE, só pode aparecer em LET "
+                                          + identifierNode->name + " = " + identifierNode->name + " + ...");
+                }
+                if (escritasNoCorpo.count(identifierNode->name) && !escritasNestaVolta.count(identifierNode->name)) {
+                    throw erro(linha, identifierNode->name
+                                          + " é lida antes de ser escrita no corpo do PARALLEL FOR (dependeria da volta anterior)");
+                }
+                return;
+            }
+            acessarVetor(identifierNode->name, identifierNode->indices);
+            for (const auto& indice : identifierNode->indices) {
+                ler(indice.expressao);
+            }
+        } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+            ler(binaryExpr->left);
+            ler(binaryExpr->right);
+        } else if (auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao)) {
+            for (const auto& argumento : functionCall->argumentos) {
+                ler(argumento);
+            }
+        }
+    };
+
+    for (int index = inicio + 1; index < paralelo.next; ++index) {
+        auto letStmt = std::static_pointer_cast<NoDoComandoLET>(comandos[index]);
+        linha = letStmt->numeroLinha;
+        const std::string& nome = letStmt->identificador;
+        if (reducoes.count(nome)) {
+            auto soma = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(letStmt->expressao);
+            if (!letStmt->indices.empty() || !soma || soma->op != "+"
+                || (!ehVariavel(soma->left, nome) && !ehVariavel(soma->right, nome))) {
+                throw erro(linha, nome + ", do REDUCE, só pode aparecer em LET " + nome + " = " + nome + " + ...");
+            }
+            ler(ehVariavel(soma->left, nome) ? soma->right : soma->left);
+            continue;
+        }
+        for (const auto& indice : letStmt->indices) {
+            ler(indice.expressao);
+        }
+        ler(letStmt->expressao);
+        if (nome == contador) {
+            throw erro(linha, "o contador " + contador + " não pode ser alterado no corpo do PARALLEL FOR");
+        }
+        if (letStmt->indices.empty()) {
+            escritasNestaVolta.insert(nome);
+        } else {
+            acessarVetor(nome, letStmt->indices);
+            vetoresEscritos.insert(nome);
+        }
+    }
+
+    for (const std::string& vetor : vetoresEscritos) {
+        const std::vector<bool>& posicoes = posicoesDoContador[vetor];
+        if (std::find(posicoes.begin(), posicoes.end(), true) == posicoes.end()) {
+            throw erro(paralelo.numeroLinha, vetor + " pode ser alterado por mais de uma volta do PARALLEL FOR: "
+                                                 "use o contador " + contador + " sozinho como índice em todos os acessos");
+        }
+    }
+    for (const std::string& nome : escritasNoCorpo) {
+        auto leitura = leitores.find(nome);
+        if (leitura == leitores.end()) {
+            continue;
+        }
+        for (int index : leitura->second) {
+            if (index <= inicio || index >= paralelo.next) {
+                throw erro(std::static_pointer_cast<NoDeComando>(comandos[index])->numeroLinha,
+                           nome + " é alterada no corpo do PARALLEL FOR da linha " + paralelo.numeroLinha
+                               + " e não pode ser usada fora dele");
+            }
+        }
+    }
+
+    paralelo.vetoresEscritos.assign(vetoresEscritos.begin(), vetoresEscritos.end());
+    std::sort(paralelo.vetoresEscritos.begin(), paralelo.vetoresEscritos.end());
+    paralelo.slotsVetoresEscritos.clear();
+    for (const std::string& vetor : paralelo.vetoresEscritos) {
+        paralelo.slotsVetoresEscritos.push_back(programa.simbolos->slot(vetor));
+    }
+}
+
+void Resolvedor::reconhecerLacos() {
+    // Comandos que recebem desvios: um laço só pode ser iniciado pelo seu primeiro comando
+    std::vector<bool> destinos(programa.comandos.size(), false);
+    for (const auto& comando : programa.comandos) {
+        int destino = destinoDoDesvio(programa, comando);
+        if (destino >= 0) {
+            destinos[destino] = true;
+        }
+    }
+    for (int fim = 0; fim < static_cast<int>(programa.comandos.size()); ++fim) {
+        LacoContado laco;
+        if (reconhecerLaco(fim, destinos, laco)) {
+            programa.lacos.push_back(std::move(laco));
+        }
+    }
+}
+
+bool Resolvedor::reconhecerLaco(int fim, const std::vector<bool>& destinos, LacoContado& laco) {
+    auto ifStmt = std::dynamic_pointer_cast<NoDoComandoIF>(programa.comandos[fim]);
+    if (!ifStmt || (ifStmt->operadorLogico != "<" && ifStmt->operadorLogico != ">")) {
+        return false;
+    }
+    auto contador = std::dynamic_pointer_cast<NoDeIdentificador>(ifStmt->operando1);
+    if (!contador || !contador->indices.empty()) {
+        return false;
+    }
+    auto limite = std::dynamic_pointer_cast<NoDeIdentificador>(ifStmt->operando2);
+    if (!std::dynamic_pointer_cast<NoDeNumero>(ifStmt->operando2)
+        && (!limite || !limite->indices.empty() || limite->name == contador->name)) {
+        return false;
+    }
+    int inicio = programa.indiceDaLinha(ifStmt->numeroLinha);
+    if (inicio < 0 || inicio >= fim) {
+        return false;
+    }
+
+    // Corpo em linha reta, sem entradas no meio, com uma única atribuição ao contador
+    int incremento = -1;
+    double passo = 0;
+    for (int index = inicio; index < fim; ++index) {
+        const auto& comando = programa.comandos[index];
+        if (index > inicio && destinos[index]) {
+            return false;
+        }
+        if (auto letStmt = std::dynamic_pointer_cast<NoDoComandoLET>(comando)) {
+            if (limite && letStmt->identificador == limite->name) {
+                return false;
+            }
+            if (letStmt->identificador != contador->name) {
+                continue;
+            }
+            double deslocamento = 0;
+            if (incremento >= 0 || !letStmt->indices.empty()
+                || !deslocamentoDoContador(letStmt->expressao, contador->name, deslocamento) || deslocamento == 0) {
+                return false;
+            }
+            incremento = index;
+            passo = deslocamento;
+        } else if (!std::dynamic_pointer_cast<NoDoComandoPRINT>(comando)
+                   && !std::dynamic_pointer_cast<NoDoComandoPLOT>(comando)
+                   && !std::dynamic_pointer_cast<NoDoComandoLINE>(comando)
+                   && !std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando)) {
+            // Desvios, INPUT, DIM, LOAD e comandos futuros: o laço fica sem guarda
+            return false;
+        }
+    }
+    if (destinos[fim] || incremento < 0 || (ifStmt->operadorLogico == "<") != (passo > 0)) {
+        return false;
+    }
+
+    int idLaco = static_cast<int>(programa.lacos.size());
+    laco.inicio = inicio;
+    laco.fim = fim;
+    laco.slotContador = contador->slot;
+    laco.passo = passo;
+    laco.limite = ifStmt->operando2;
+    for (int index = inicio; index < fim; ++index) {
+        bool depoisDoIncremento = index > incremento;
+        const auto& comando = programa.comandos[index];
+        if (auto letStmt = std::dynamic_pointer_cast<NoDoComandoLET>(comando)) {
+            coletarAcessos(letStmt->identificador, letStmt->indices, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(letStmt->expressao, contador->name, idLaco, depoisDoIncremento, laco);
+        } else if (auto printStmt = std::dynamic_pointer_cast<NoDoComandoPRINT>(comando)) {
+            coletarAcessos(printStmt->expressao, contador->name, idLaco, depoisDoIncremento, laco);
+        } else if (auto plotStmt = std::dynamic_pointer_cast<NoDoComandoPLOT>(comando)) {
+            coletarAcessos(plotStmt->posicaoX, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(plotStmt->posicaoY, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(plotStmt->espessura, contador->name, idLaco, depoisDoIncremento, laco);
+        } else if (auto lineStmt = std::dynamic_pointer_cast<NoDoComandoLINE>(comando)) {
+            coletarAcessos(lineStmt->xInicial, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(lineStmt->yInicial, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(lineStmt->xFinal, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(lineStmt->yFinal, contador->name, idLaco, depoisDoIncremento, laco);
+        } else if (auto rectStmt = std::dynamic_pointer_cast<NoDoComandoRECTANGLE>(comando)) {
+            coletarAcessos(rectStmt->xCantoSuperiorEsquerdo, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(rectStmt->yCantoSuperiorEsquerdo, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(rectStmt->xCantoInferiorDireito, contador->name, idLaco, depoisDoIncremento, laco);
+            coletarAcessos(rectStmt->yCantoInferiorDireito, contador->name, idLaco, depoisDoIncremento, laco);
+        }
+    }
+    if (laco.acessos.empty()) {
+        // Nada a verificar: não vale a pena a guarda
+        return false;
+    }
+    std::static_pointer_cast<NoDeComando>(programa.comandos[inicio])->inicioDeLaco = idLaco;
+    ifStmt->fimDeLaco = idLaco;
+    return true;
+}
+
+void Resolvedor::coletarAcessos(const NoDaASTPtr& expressao, const std::string& contador, int idLaco,
+                                bool depoisDoIncremento, LacoContado& laco) {
+    if (!expressao) {
+        return;
+    }
+    if (auto identifierNode = std::dynamic_pointer_cast<NoDeIdentificador>(expressao)) {
+        coletarAcessos(identifierNode->name, identifierNode->indices, contador, idLaco, depoisDoIncremento, laco);
+    } else if (auto binaryExpr = std::dynamic_pointer_cast<NoDeExpressaoBinaria>(expressao)) {
+        coletarAcessos(binaryExpr->left, contador, idLaco, depoisDoIncremento, laco);
+        coletarAcessos(binaryExpr->right, contador, idLaco, depoisDoIncremento, laco);
+    } else if (auto functionCall = std::dynamic_pointer_cast<NoDeFuncao>(expressao)) {
+        for (const auto& argumento : functionCall->argumentos) {
+            coletarAcessos(argumento, contador, idLaco, depoisDoIncremento, laco);
+        }
+    }
+}
+
+void Resolvedor::coletarAcessos(const std::string& vetor, std::vector<IndiceDeVetor>& indices,
+                                const std::string& contador, int idLaco, bool depoisDoIncremento,
+                                LacoContado& laco) {
+    for (size_t k = 0; k < indices.size(); ++k) {
+        IndiceDeVetor& indice = indices[k];
+        // Índices dentro de índices: A[B[I]]
+        coletarAcessos(indice.expressao, contador, idLaco, depoisDoIncremento, laco);
+        double deslocamento = 0;
+        if (indice.verificado || vetor == contador
+            || !deslocamentoDoContador(indice.expressao, contador, deslocamento)) {
+            continue;
+        }
+        indice.laco = idLaco;
+        laco.acessos.push_back({programa.simbolos->slot(vetor), k, deslocamento, depoisDoIncremento});
+    }
+}
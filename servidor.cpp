@@ -0,0 +1,408 @@
+#include "Servidor.h"
+#include "Entrada.h"
+#include "Interpreter.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#if defined(__linux__)
+
+namespace {
+    // Uma fatia por sessão a cada volta do laço: poucos comandos mantêm as outras sessões e a
+    // leitura do socket responsivas
+    constexpr uint64_t orcamentoDaFatia = 10000;
+    constexpr auto duracaoDaFatia = std::chrono::milliseconds(1);
+    // Sessão com mais saída do que isso esperando o cliente ler não roda até o envio esvaziar
+    constexpr size_t limiteDeSaidaPendente = 1 << 20;
+    // Identificadores reservados em epoll_event::data.u64; as sessões começam depois deles
+    constexpr uint64_t idEscuta = 0;
+    constexpr uint64_t idAviso = 1;
+
+    std::atomic<uint64_t> proximaSessao{2};
+
+    struct Sessao {
+        uint64_t id;
+        int fd;
+        std::ostringstream saida;
+        std::shared_ptr<EntradaFila> entrada;
+        std::unique_ptr<Interpreter> interpreter;
+        // Linha recebida pela metade
+        std::string recebido;
+        // Saída ainda não aceita pelo socket
+        std::string pendente;
+        size_t enviado = 0;
+        bool aguardandoEntrada = false;
+        bool aguardandoEnvio = false;
+    };
+
+    bool converterNumero(const char* inicio, const char* fim, double& valor) {
+        if (inicio < fim && *inicio == '+') {
+            // from_chars não aceita o sinal positivo
+            inicio++;
+        }
+        auto [ptr, ec] = std::from_chars(inicio, fim, valor);
+        return ec == std::errc() && ptr == fim;
+    }
+
+    class LacoDeEventos {
+    public:
+        LacoDeEventos(int escuta, int aviso, const std::string& basicScriptName,
+                      const std::shared_ptr<NoDePrograma>& programa)
+            : escuta(escuta), basicScriptName(basicScriptName), programa(programa) {
+            epoll = epoll_create1(EPOLL_CLOEXEC);
+            if (epoll < 0) {
+                throw std::runtime_error(std::string("epoll_create1: ") + std::strerror(errno));
+            }
+            // EPOLLEXCLUSIVE: uma conexão nova acorda um só laço, não todos
+            epoll_event evento{};
+            evento.events = EPOLLIN | EPOLLEXCLUSIVE;
+            evento.data.u64 = idEscuta;
+            epoll_ctl(epoll, EPOLL_CTL_ADD, escuta, &evento);
+            evento.events = EPOLLIN;
+            evento.data.u64 = idAviso;
+            epoll_ctl(epoll, EPOLL_CTL_ADD, aviso, &evento);
+        }
+
+        ~LacoDeEventos() {
+            for (auto& [id, sessao] : sessoes) {
+                close(sessao->fd);
+            }
+            close(epoll);
+        }
+
+        void executar() {
+            std::vector<epoll_event> eventos(256);
+            bool parar = false;
+            while (!parar) {
+                // Com sessões prontas o laço só consulta o socket, sem esperar
+                int espera = prontas.empty() ? -1 : 0;
+                int n = epoll_wait(epoll, eventos.data(), static_cast<int>(eventos.size()), espera);
+                if (n < 0 && errno != EINTR) {
+                    throw std::runtime_error(std::string("epoll_wait: ") + std::strerror(errno));
+                }
+                for (int k = 0; k < n; ++k) {
+                    uint64_t id = eventos[k].data.u64;
+                    if (id == idEscuta) {
+                        aceitar();
+                    } else if (id == idAviso) {
+                        parar = true;
+                    } else {
+                        tratarEvento(id, eventos[k].events);
+                    }
+                }
+                // Uma volta pelas sessões prontas agora; as que cederam entram no fim da fila
+                for (size_t rodada = prontas.size(); rodada > 0; --rodada) {
+                    uint64_t id = prontas.front();
+                    prontas.pop_front();
+                    auto sessao = sessoes.find(id);
+                    if (sessao != sessoes.end()) {
+                        rodar(*sessao->second);
+                    }
+                }
+            }
+        }
+
+    private:
+        int epoll;
+        int escuta;
+        const std::string& basicScriptName;
+        const std::shared_ptr<NoDePrograma>& programa;
+        std::unordered_map<uint64_t, std::unique_ptr<Sessao>> sessoes;
+        std::deque<uint64_t> prontas;
+
+        void aceitar() {
+            // Poucas por vez: com EPOLLEXCLUSIVE, os outros laços também recebem conexões
+            for (int k = 0; k < 64; ++k) {
+                int fd = accept4(escuta, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) {
+                    if (errno == EMFILE || errno == ENFILE) {
+                        std::cerr << "Servidor: limite de arquivos abertos atingido" << std::endl;
+                    }
+                    return;
+                }
+                auto sessao = std::make_unique<Sessao>();
+                sessao->id = proximaSessao++;
+                sessao->fd = fd;
+                sessao->entrada = std::make_shared<EntradaFila>();
+                sessao->interpreter = std::make_unique<Interpreter>(
+                    basicScriptName + "_" + std::to_string(sessao->id), sessao->saida, sessao->entrada);
+                // As sessões já dividem as threads: um PARALLEL FOR roda na thread da sessão
+                sessao->interpreter->definirThreadsParalelas(1);
+                sessao->interpreter->iniciar(programa);
+                // Disparo por borda: leitura e escrita vão até EAGAIN, e o fim da conexão chega uma vez só
+                epoll_event evento{};
+                evento.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                evento.data.u64 = sessao->id;
+                if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &evento) != 0) {
+                    close(fd);
+                    continue;
+                }
+                prontas.push_back(sessao->id);
+                sessoes.emplace(sessao->id, std::move(sessao));
+            }
+        }
+
+        void tratarEvento(uint64_t id, uint32_t eventos) {
+            auto encontrada = sessoes.find(id);
+            if (encontrada == sessoes.end()) {
+                return;
+            }
+            Sessao& sessao = *encontrada->second;
+            if (eventos & (EPOLLERR | EPOLLHUP)) {
+                fechar(sessao);
+                return;
+            }
+            if ((eventos & (EPOLLIN | EPOLLRDHUP)) && !ler(sessao)) {
+                fechar(sessao);
+                return;
+            }
+            // Também entrega os avisos de valor inválido de uma sessão parada em INPUT
+            if ((eventos & EPOLLOUT) || !sessao.pendente.empty()) {
+                enviarOuFechar(sessao);
+            }
+        }
+
+        // Retorna false se a conexão falhou
+        bool ler(Sessao& sessao) {
+            char bloco[4096];
+            while (true) {
+                ssize_t lidos = read(sessao.fd, bloco, sizeof(bloco));
+                if (lidos > 0) {
+                    sessao.recebido.append(bloco, static_cast<size_t>(lidos));
+                    continue;
+                }
+                if (lidos == 0) {
+                    // O cliente não vai mandar mais nada: INPUT sem valor passa a ser erro
+                    separarValores(sessao, true);
+                    sessao.entrada->encerrar();
+                    break;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    return false;
+                }
+                separarValores(sessao, false);
+                break;
+            }
+            if (sessao.aguardandoEntrada && sessao.entrada->pronta()) {
+                sessao.aguardandoEntrada = false;
+                prontas.push_back(sessao.id);
+            }
+            return true;
+        }
+
+        // Valores separados como no --input-file; só linhas completas, a não ser no fim da conexão
+        void separarValores(Sessao& sessao, bool fimDaConexao) {
+            std::string& dados = sessao.recebido;
+            size_t limite = fimDaConexao ? dados.size() : dados.rfind('\n');
+            if (limite == std::string::npos) {
+                return;
+            }
+            size_t pos = 0;
+            while (pos < limite) {
+                while (pos < limite && std::strchr(" \t\r\n,;", dados[pos]) != nullptr) {
+                    pos++;
+                }
+                size_t inicio = pos;
+                while (pos < limite && std::strchr(" \t\r\n,;", dados[pos]) == nullptr) {
+                    pos++;
+                }
+                if (inicio == pos) {
+                    break;
+                }
+                double valor;
+                if (converterNumero(dados.data() + inicio, dados.data() + pos, valor)) {
+                    sessao.entrada->fornecer(valor);
+                } else {
+                    sessao.pendente += "INPUT: valor inválido: \"" + dados.substr(inicio, pos - inicio) + "\"\n";
+                }
+            }
+            dados.erase(0, limite);
+        }
+
+        void rodar(Sessao& sessao) {
+            Interpreter::Situacao situacao;
+            try {
+                situacao = sessao.interpreter->passo(orcamentoDaFatia,
+                                                     std::chrono::steady_clock::now() + duracaoDaFatia);
+            } catch (const std::exception& e) {
+                situacao = Interpreter::Situacao::TERMINOU;
+                sessao.saida << "Erro de interpreter: " << e.what() << std::endl;
+            }
+            sessao.pendente += sessao.saida.str();
+            sessao.saida.str("");
+            if (situacao == Interpreter::Situacao::TERMINOU) {
+                sessao.interpreter.reset();
+            } else if (situacao == Interpreter::Situacao::AGUARDANDO_ENTRADA) {
+                sessao.aguardandoEntrada = true;
+            } else if (sessao.pendente.size() - sessao.enviado > limiteDeSaidaPendente) {
+                // O cliente não está lendo: a sessão volta a rodar quando o envio esvaziar
+                sessao.aguardandoEnvio = true;
+            } else {
+                prontas.push_back(sessao.id);
+            }
+            enviarOuFechar(sessao);
+        }
+
+        void enviarOuFechar(Sessao& sessao) {
+            while (sessao.enviado < sessao.pendente.size()) {
+                ssize_t escritos = send(sessao.fd, sessao.pendente.data() + sessao.enviado,
+                                        sessao.pendente.size() - sessao.enviado, MSG_NOSIGNAL);
+                if (escritos > 0) {
+                    sessao.enviado += static_cast<size_t>(escritos);
+                } else if (escritos < 0 && errno == EINTR) {
+                    continue;
+                } else if (escritos < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    // EPOLLOUT avisa quando o socket aceitar mais
+                    return;
+                } else {
+                    fechar(sessao);
+                    return;
+                }
+            }
+            sessao.pendente.clear();
+            sessao.enviado = 0;
+            if (!sessao.interpreter) {
+                // Programa terminou e toda a saída foi entregue
+                fechar(sessao);
+            } else if (sessao.aguardandoEnvio) {
+                sessao.aguardandoEnvio = false;
+                prontas.push_back(sessao.id);
+            }
+        }
+
+        void fechar(Sessao& sessao) {
+            // close também remove o descritor do epoll
+            close(sessao.fd);
+            sessoes.erase(sessao.id);
+        }
+    };
+
+    // Cada conexão usa um descritor: o limite padrão (1024) não comporta milhares de sessões
+    void aumentarLimiteDeArquivos() {
+        rlimit limite{};
+        if (getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < limite.rlim_max) {
+            limite.rlim_cur = limite.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limite);
+        }
+    }
+}
+
+void executarServidor(const std::string& caminhoSocket, const std::string& basicScriptName,
+                      const std::shared_ptr<NoDePrograma>& programa, unsigned numeroThreads) {
+    if (numeroThreads == 0) {
+        numeroThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    sockaddr_un endereco{};
+    if (caminhoSocket.size() >= sizeof(endereco.sun_path)) {
+        throw std::runtime_error("Caminho do socket longo demais: " + caminhoSocket);
+    }
+    aumentarLimiteDeArquivos();
+
+    int escuta = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (escuta < 0) {
+        throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    }
+    // Um socket deixado por uma execução anterior é substituído; outros arquivos não
+    struct stat info{};
+    if (stat(caminhoSocket.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(caminhoSocket.c_str());
+    }
+    endereco.sun_family = AF_UNIX;
+    std::memcpy(endereco.sun_path, caminhoSocket.c_str(), caminhoSocket.size() + 1);
+    if (bind(escuta, reinterpret_cast<sockaddr*>(&endereco), sizeof(endereco)) != 0
+        || listen(escuta, SOMAXCONN) != 0) {
+        int erro = errno;
+        close(escuta);
+        throw std::runtime_error("Falha ao escutar em " + caminhoSocket + ": " + std::strerror(erro));
+    }
+    int aviso = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    // SIGINT e SIGTERM ficam bloqueados em todas as threads e são recebidos só por sigwait
+    sigset_t sinais;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sinais, nullptr);
+
+    std::vector<std::unique_ptr<LacoDeEventos>> lacos;
+    for (unsigned t = 0; t < numeroThreads; ++t) {
+        lacos.push_back(std::make_unique<LacoDeEventos>(escuta, aviso, basicScriptName, programa));
+    }
+    std::vector<std::thread> threads;
+    for (auto& laco : lacos) {
+        threads.emplace_back([&laco] {
+            try {
+                laco->executar();
+            } catch (const std::exception& e) {
+                std::cerr << "Servidor: " << e.what() << std::endl;
+            }
+        });
+    }
+    std::cerr << "Servidor escutando em " << caminhoSocket << " (" << numeroThreads << " laços de eventos)"
+              << std::endl;
+
+    int sinal = 0;
+    sigwait(&sinais, &sinal);
+    // O eventfd fica legível para sempre: acorda todos os laços
+    uint64_t um = 1;
+    ssize_t escritos = write(aviso, &um, sizeof(um));
+    (void) escritos;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    lacos.clear();
+    close(aviso);
+    close(escuta);
+    unlink(caminhoSocket.c_str());
+    pthread_sigmask(SIG_UNBLOCK, &sinais, nullptr);
+}
+
+#else
+
+void executarServidor(const std::string& caminhoSocket, const std::string&, const std::shared_ptr<NoDePrograma>&,
+                      unsigned) {
+    throw std::runtime_error("--serve só é suportado no Linux: " + caminhoSocket);
+}
+
+#endif
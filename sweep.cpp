@@ -0,0 +1,174 @@
+#include "Sweep.h"
+#include "Interpreter.h"
+#include "LaneInterpreter.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+std::vector<LinhaDeVarredura> lerArquivoDeVarredura(const std::string& arquivoCsv) {
+    std::ifstream arquivo(arquivoCsv);
+    if (!arquivo) {
+        throw std::runtime_error("Falha ao abrir arquivo de entradas: " + arquivoCsv);
+    }
+    std::vector<LinhaDeVarredura> linhas;
+    std::string texto;
+    int numeroLinha = 0;
+    while (std::getline(arquivo, texto)) {
+        numeroLinha++;
+        if (!texto.empty() && texto.back() == '\r') {
+            texto.pop_back();
+        }
+        if (texto.find_first_not_of(" \t") == std::string::npos) {
+            // Linha em branco
+            continue;
+        }
+        LinhaDeVarredura linha{numeroLinha, texto, {}};
+        std::istringstream campos(texto);
+        std::string campo;
+        while (std::getline(campos, campo, ',')) {
+            const char* inicio = campo.c_str();
+            char* fim = nullptr;
+            double valor = std::strtod(inicio, &fim);
+            while (*fim == ' ' || *fim == '\t') {
+                fim++;
+            }
+            if (fim == inicio || *fim != '\0') {
+                std::ostringstream oss;
+                oss << arquivoCsv << ":" << numeroLinha << ": valor inválido: \"" << campo << "\"";
+                throw std::runtime_error(oss.str());
+            }
+            linha.valores.push_back(valor);
+        }
+        linhas.push_back(linha);
+    }
+    return linhas;
+}
+
+namespace {
+    template<int N>
+    void executarGrupo(const std::string& basicScriptName, const std::shared_ptr<NoDePrograma>& programa,
+                       const std::vector<LinhaDeVarredura>& linhas, size_t primeira,
+                       std::vector<std::ostringstream>& saidas, std::vector<std::string>& erros) {
+        std::array<typename LaneInterpreter<N>::Lane, N> lanes;
+        for (int lane = 0; lane < N; ++lane) {
+            const auto& linha = linhas[primeira + lane];
+            lanes[lane] = {basicScriptName + "_" + std::to_string(linha.numeroLinha), &saidas[lane],
+                           std::make_shared<EntradaLista>(linha.valores), ""};
+        }
+        LaneInterpreter<N> interpreter(lanes);
+        interpreter.executar(programa);
+        for (int lane = 0; lane < N; ++lane) {
+            erros[lane] = lanes[lane].erro;
+        }
+    }
+}
+
+void executarVarredura(const std::string& basicScriptName, const std::shared_ptr<NoDePrograma>& programa,
+                       const std::string& arquivoCsv, unsigned numeroThreads, std::ostream& saida, int lanes) {
+    std::vector<LinhaDeVarredura> linhas = lerArquivoDeVarredura(arquivoCsv);
+    if (numeroThreads == 0) {
+        numeroThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (lanes != 4 && lanes != 8) {
+        lanes = 1;
+    }
+
+    // Cada linha tem seu resultado; o escritor (esta thread) grava na ordem do CSV
+    // assim que a próxima linha esperada termina, liberando a memória logo em seguida.
+    std::vector<std::string> resultados(linhas.size());
+    std::vector<char> prontos(linhas.size(), 0);
+    std::mutex mutexResultados;
+    std::condition_variable resultadoPronto;
+    // As threads pegam grupos de "lanes" linhas consecutivas
+    size_t totalGrupos = (linhas.size() + lanes - 1) / lanes;
+    std::atomic<size_t> proximoGrupo{0};
+
+    auto trabalhador = [&]() {
+        for (size_t grupo = proximoGrupo++; grupo < totalGrupos; grupo = proximoGrupo++) {
+            size_t primeira = grupo * lanes;
+            size_t quantidade = std::min<size_t>(lanes, linhas.size() - primeira);
+            std::vector<std::ostringstream> saidas(quantidade);
+            std::vector<std::string> erros(quantidade);
+            if (quantidade == 4 && lanes == 4) {
+                executarGrupo<4>(basicScriptName, programa, linhas, primeira, saidas, erros);
+            } else if (quantidade == 8 && lanes == 8) {
+                executarGrupo<8>(basicScriptName, programa, linhas, primeira, saidas, erros);
+            } else {
+                // Execução escalar (sem lanes, ou o último grupo incompleto)
+                for (size_t k = 0; k < quantidade; ++k) {
+                    const auto& linha = linhas[primeira + k];
+                    // O nome do script recebe o número da linha para que os SVG das linhas não colidam
+                    Interpreter interpreter(basicScriptName + "_" + std::to_string(linha.numeroLinha), saidas[k],
+                                            std::make_shared<EntradaLista>(linha.valores));
+                    // As linhas já estão divididas entre as threads: um PARALLEL FOR roda em uma só
+                    interpreter.definirThreadsParalelas(1);
+                    try {
+                        interpreter.executar(programa);
+                    } catch (const std::exception& e) {
+                        erros[k] = e.what();
+                    }
+                }
+            }
+            for (size_t k = 0; k < quantidade; ++k) {
+                if (!erros[k].empty()) {
+                    std::ostringstream oss;
+                    oss << "Erro de interpreter (" << arquivoCsv << ":" << linhas[primeira + k].numeroLinha << "): "
+                        << erros[k] << std::endl;
+                    std::cerr << oss.str();
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutexResultados);
+                for (size_t k = 0; k < quantidade; ++k) {
+                    resultados[primeira + k] = saidas[k].str();
+                    prontos[primeira + k] = 1;
+                }
+            }
+            resultadoPronto.notify_one();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    unsigned totalThreads = std::min<size_t>(numeroThreads, totalGrupos);
+    for (unsigned t = 0; t < totalThreads; ++t) {
+        threads.emplace_back(trabalhador);
+    }
+
+    for (size_t i = 0; i < linhas.size(); ++i) {
+        std::string resultado;
+        {
+            std::unique_lock<std::mutex> lock(mutexResultados);
+            resultadoPronto.wait(lock, [&]() { return prontos[i] != 0; });
+            resultado.swap(resultados[i]);
+        }
+        saida << "# " << linhas[i].numeroLinha << ": " << linhas[i].texto << "\n" << resultado;
+    }
+    saida.flush();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
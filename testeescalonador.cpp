@@ -0,0 +1,173 @@
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Escalonador.h"
+#include "Lexer.h"
+#include "Otimizador.h"
+#include "Parser.h"
+#include "Resolvedor.h"
+#include "util.h"
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Teste do Escalonador: muitos programas em poucas threads, com orçamento pequeno para que
+// cada um ceda muitas vezes. Um terço roda o mesmo programa já analisado (a AST é
+// compartilhada entre os Interpreters), um terço roda programas próprios e um terço lê os
+// valores do INPUT, fornecidos enquanto os programas rodam. Metade destes termina com a
+// entrada encerrada, o que precisa virar erro do programa, e não travar o Escalonador.
+//
+// Uso: sibasic_teste_escalonador [programas [threads]]
+
+namespace {
+    std::shared_ptr<NoDePrograma> compilar(const std::string& fonte) {
+        auto programa = std::make_shared<NoDePrograma>();
+        std::istringstream linhas(fonte);
+        std::string linha;
+        bool jaTemDrawStart = false;
+        while (std::getline(linhas, linha)) {
+            Lexer lexer{};
+            std::vector<Token> tokens = lexer.tokenize(paraMaiusculas(linha));
+            Parser parser(tokens, jaTemDrawStart);
+            auto linhaDoPrograma = parser.parse();
+            for (const auto& comando : linhaDoPrograma->comandos) {
+                programa->comandos.push_back(comando);
+            }
+            jaTemDrawStart = parser.jaTemDrawStart;
+        }
+        programa->indexarLinhas();
+        programa->hashDoFonte = hashDoTexto(fonte);
+        Resolvedor(*programa).resolver();
+        Otimizador(*programa).otimizar();
+        return programa;
+    }
+
+    // Saída de um programa que imprime a soma de 1 a n e chega ao END
+    std::string somaAte(long n) {
+        std::ostringstream saida;
+        saida << static_cast<double>(n * (n + 1) / 2) << "\nComando END\n";
+        return saida.str();
+    }
+
+    std::string programaDeSoma(long n) {
+        return "10 LET S = 0\n"
+               "20 LET I = 1\n"
+               "30 LET S = S + I\n"
+               "40 LET I = I + 1\n"
+               "50 IF I < " + std::to_string(n + 1) + " THEN 30\n"
+               "60 PRINT S\n"
+               "70 END\n";
+    }
+
+    const std::string programaDeEntrada =
+        "10 LET S = 0\n"
+        "20 INPUT V\n"
+        "30 IF V < 0 THEN 60\n"
+        "40 LET S = S + V\n"
+        "50 GOTO 20\n"
+        "60 PRINT S\n"
+        "70 END\n";
+
+    enum class Tipo { COMPARTILHADO, PROPRIO, ENTRADA, ENTRADA_ENCERRADA };
+
+    struct Caso {
+        Tipo tipo;
+        size_t id;
+        long n;
+        std::string esperado;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    long numeroProgramas = argc > 1 ? std::atol(argv[1]) : 3000;
+    unsigned numeroThreads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 4;
+    const long somaCompartilhada = 300;
+
+    auto compartilhado = compilar(programaDeSoma(somaCompartilhada));
+    auto entrada = compilar(programaDeEntrada);
+
+    std::vector<Caso> casos;
+    {
+        // Orçamento pequeno: cada programa cede dezenas de vezes antes de terminar
+        Escalonador escalonador(numeroThreads, 50);
+        for (long k = 0; k < numeroProgramas; ++k) {
+            Caso caso{};
+            caso.n = 10 + k % 97;
+            switch (k % 3) {
+                case 0:
+                    caso.tipo = Tipo::COMPARTILHADO;
+                    caso.id = escalonador.adicionar("compartilhado", compartilhado);
+                    caso.esperado = somaAte(somaCompartilhada);
+                    break;
+                case 1:
+                    caso.tipo = Tipo::PROPRIO;
+                    caso.id = escalonador.adicionar("proprio", compilar(programaDeSoma(caso.n)));
+                    caso.esperado = somaAte(caso.n);
+                    break;
+                default:
+                    caso.tipo = k % 2 == 0 ? Tipo::ENTRADA : Tipo::ENTRADA_ENCERRADA;
+                    caso.id = escalonador.adicionar("entrada", entrada);
+                    caso.esperado = caso.tipo == Tipo::ENTRADA ? somaAte(caso.n) : "";
+                    break;
+            }
+            casos.push_back(caso);
+        }
+
+        // Os valores chegam com os programas já rodando: parte deles já está parada no INPUT
+        for (long valor = 1; valor <= 106; ++valor) {
+            for (const Caso& caso : casos) {
+                if ((caso.tipo == Tipo::ENTRADA || caso.tipo == Tipo::ENTRADA_ENCERRADA) && valor <= caso.n) {
+                    escalonador.fornecerEntrada(caso.id, static_cast<double>(valor));
+                }
+            }
+        }
+        for (const Caso& caso : casos) {
+            if (caso.tipo == Tipo::ENTRADA) {
+                escalonador.fornecerEntrada(caso.id, -1.0);
+            } else if (caso.tipo == Tipo::ENTRADA_ENCERRADA) {
+                escalonador.encerrarEntrada(caso.id);
+            }
+        }
+        escalonador.aguardar();
+
+        uint64_t comandosDoCompartilhado = 0;
+        for (const Caso& caso : casos) {
+            Escalonador::Resultado resultado = escalonador.resultado(caso.id);
+            bool esperaErro = caso.tipo == Tipo::ENTRADA_ENCERRADA;
+            if (!resultado.terminou || resultado.saida != caso.esperado || resultado.erro.empty() != !esperaErro) {
+                std::cerr << "Programa " << caso.id << ": saída \"" << resultado.saida << "\", esperada \""
+                          << caso.esperado << "\", erro \"" << resultado.erro << "\"" << std::endl;
+                return 1;
+            }
+            if (caso.tipo == Tipo::COMPARTILHADO) {
+                // As fatias não mudam o que é executado: toda cópia executa os mesmos comandos
+                if (comandosDoCompartilhado == 0) {
+                    comandosDoCompartilhado = resultado.comandos;
+                } else if (resultado.comandos != comandosDoCompartilhado) {
+                    std::cerr << "Programa " << caso.id << ": " << resultado.comandos << " comandos, esperados "
+                              << comandosDoCompartilhado << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::cout << "Escalonador: " << numeroProgramas << " programas em " << numeroThreads
+              << " threads, todos com a saída esperada" << std::endl;
+    return 0;
+}
@@ -0,0 +1,286 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "LexerDeReferencia.h"
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Teste de equivalência do Lexer com o LexerDeReferencia (o algoritmo antigo). Compara os
+// tokens de linhas geradas ao acaso e de uma varredura de todos os bytes logo depois de
+// sequências de 1 a 64 caracteres, que pegam as bordas dos blocos de 16 bytes do SSE2.
+// O alvo sibasic_teste_lexer_sem_sse2 compila o mesmo teste com o Lexer sem SSE2.
+//
+// Onde os dois podem diferir: um NUMERO que o stod não converte inteiro ("1.2.3", ".") era
+// aceito pelo Lexer antigo e agora é "Número inválido". Nesse caso o teste exige o erro.
+//
+// Uso: sibasic_teste_lexer [linhas [semente]]
+
+namespace {
+    struct Resultado {
+        bool erro = false;
+        std::string mensagem;
+        std::vector<Token> tokens;
+    };
+
+    template <typename L>
+    Resultado tokenizar(const std::string& linha) {
+        Resultado resultado;
+        try {
+            L lexer;
+            resultado.tokens = lexer.tokenize(linha);
+        } catch (const LexerException& e) {
+            resultado.erro = true;
+            resultado.mensagem = e.what();
+        }
+        return resultado;
+    }
+
+    // O que o interpretador antigo fazia com o texto do NUMERO: falso se o stod não o converte inteiro
+    bool converterComoAntes(const std::string& texto, double& valor) {
+        try {
+            size_t lidos = 0;
+            valor = std::stod(texto, &lidos);
+            return lidos == texto.size();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    std::string legivel(const std::string& texto) {
+        std::ostringstream saida;
+        for (char c : texto) {
+            auto byte = static_cast<unsigned char>(c);
+            if (byte >= 32 && byte < 127) {
+                saida << c;
+            } else {
+                static const char* hex = "0123456789ABCDEF";
+                saida << "\\x" << hex[byte >> 4] << hex[byte & 15];
+            }
+        }
+        return saida.str();
+    }
+
+    std::string descrever(const Resultado& resultado) {
+        if (resultado.erro) {
+            return "erro: " + legivel(resultado.mensagem);
+        }
+        std::ostringstream saida;
+        for (const Token& token : resultado.tokens) {
+            saida << "[" << token.type << " \"" << legivel(token.value) << "\"";
+            if (token.type == NUMERO) {
+                saida << " " << token.numero;
+            }
+            saida << "] ";
+        }
+        return saida.str();
+    }
+
+    // Devolve uma descrição da diferença, ou vazio se o Lexer se comportou como o de referência
+    std::string comparar(const std::string& linha) {
+        Resultado referencia = tokenizar<LexerDeReferencia>(linha);
+        Resultado atual = tokenizar<Lexer>(linha);
+
+        bool numeroInvalido = false;
+        std::vector<double> valores;
+        if (!referencia.erro) {
+            for (const Token& token : referencia.tokens) {
+                double valor = 0.0;
+                if (token.type == NUMERO && !converterComoAntes(token.value, valor)) {
+                    numeroInvalido = true;
+                }
+                valores.push_back(valor);
+            }
+        }
+
+        if (referencia.erro || numeroInvalido) {
+            if (!atual.erro) {
+                return "o Lexer aceitou uma linha rejeitada: " + descrever(atual);
+            }
+            if (!referencia.erro && atual.mensagem.find("Número inválido") == std::string::npos) {
+                return "esperado \"Número inválido\", veio " + descrever(atual);
+            }
+            return "";
+        }
+        if (atual.erro || atual.tokens.size() != referencia.tokens.size()) {
+            return "referência " + descrever(referencia) + "\n  Lexer      " + descrever(atual);
+        }
+        for (size_t k = 0; k < atual.tokens.size(); ++k) {
+            const Token& esperado = referencia.tokens[k];
+            const Token& obtido = atual.tokens[k];
+            bool igual = obtido.type == esperado.type && obtido.value == esperado.value;
+            if (igual && esperado.type == NUMERO) {
+                igual = obtido.numero == valores[k];
+            }
+            if (!igual) {
+                return "token " + std::to_string(k) + ": referência " + descrever(referencia) + "\n  Lexer      "
+                       + descrever(atual);
+            }
+        }
+        return "";
+    }
+
+    class Gerador {
+    public:
+        explicit Gerador(uint64_t semente) : aleatorio(semente) {}
+
+        std::string linha() {
+            std::string texto;
+            int inicio = sortear(0, 9);
+            if (inicio == 0) {
+                texto = espacos(1, 3);
+            }
+            texto += std::to_string(sortear(1, 99999));
+            texto += inicio == 1 ? "\tLET" : " LET ";
+            int fragmentos = sortear(0, 12);
+            for (int k = 0; k < fragmentos; ++k) {
+                texto += fragmento();
+                if (sortear(0, 2) == 0) {
+                    texto += espacos(1, 2);
+                }
+            }
+            return texto;
+        }
+
+    private:
+        std::mt19937_64 aleatorio;
+
+        int sortear(int menor, int maior) {
+            return std::uniform_int_distribution<int>(menor, maior)(aleatorio);
+        }
+
+        char escolher(const std::string& opcoes) {
+            return opcoes[static_cast<size_t>(sortear(0, static_cast<int>(opcoes.size()) - 1))];
+        }
+
+        std::string repetir(const std::string& opcoes, int menor, int maior) {
+            std::string texto;
+            int tamanho = sortear(menor, maior);
+            for (int k = 0; k < tamanho; ++k) {
+                texto += escolher(opcoes);
+            }
+            return texto;
+        }
+
+        std::string espacos(int menor, int maior) {
+            return repetir(" \t\v\f\r\n", menor, maior);
+        }
+
+        std::string fragmento() {
+            static const std::vector<std::string> reservadas = {
+                "DIM", "END", "LET", "PRINT", "GOTO", "IF", "INPUT", "DRAW", "PLOT", "LINE", "RECTANGLE",
+                "CHECKPOINT", "LOAD", "SAVE", "PARALLEL", "NEXT", "EXP", "ABS", "LOG", "SIN", "COS", "TAN",
+                "SQR", "RND", "ALL", "AS", "BIT", "FILE"};
+            static const std::string letras = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+            static const std::string digitos = "0123456789";
+            switch (sortear(0, 11)) {
+                case 0:
+                case 1: {
+                    std::string palavra = reservadas[static_cast<size_t>(sortear(0, static_cast<int>(reservadas.size()) - 1))];
+                    if (sortear(0, 3) == 0) {
+                        palavra += repetir(letras + digitos, 1, 3);
+                    }
+                    return palavra;
+                }
+                case 2:
+                case 3: {
+                    std::string nome = repetir(letras, 1, 1) + repetir(letras + digitos, 0, sortear(0, 1) ? 40 : 3);
+                    return sortear(0, 3) == 0 ? nome + "%" : nome;
+                }
+                case 4:
+                case 5: {
+                    std::string numero = repetir(digitos, 1, sortear(0, 1) ? 30 : 3);
+                    if (sortear(0, 1) == 0) {
+                        numero += "." + repetir(digitos, 0, 20);
+                    }
+                    return numero;
+                }
+                case 6:
+                    // Números mal formados e pontos soltos
+                    return repetir(digitos + "..", 0, 6) + "." + repetir(digitos + ".", 0, 6);
+                case 7: {
+                    std::string literal = "\"" + repetir(letras + digitos + " .,-+()[]#@\t", 0, 40);
+                    return sortear(0, 4) == 0 ? literal : literal + "\"";
+                }
+                case 8:
+                    return espacos(1, 40);
+                case 9:
+                case 10:
+                    return std::string(1, escolher("+-*/^><=!()[],"));
+                default: {
+                    // Caracteres que nenhum dos dois aceita, inclusive bytes acima de 127
+                    if (sortear(0, 1) == 0) {
+                        return std::string(1, escolher("#@$&;:{}~`'\\?_|"));
+                    }
+                    return std::string(1, static_cast<char>(sortear(128, 255)));
+                }
+            }
+        }
+    };
+
+    int falhar(const std::string& linha, const std::string& diferenca) {
+        std::cerr << "Diferença na linha \"" << legivel(linha) << "\"\n  " << diferenca << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long linhas = argc > 1 ? std::atol(argv[1]) : 200000;
+    uint64_t semente = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20240606;
+
+    // Todo byte logo depois de uma sequência de espaços, letras ou dígitos de 1 a 64 caracteres
+    long varridas = 0;
+    const std::string sequencias[] = {" ", "A", "7"};
+    for (const std::string& unidade : sequencias) {
+        for (int tamanho = 1; tamanho <= 64; ++tamanho) {
+            std::string sequencia;
+            for (int k = 0; k < tamanho; ++k) {
+                sequencia += unidade;
+            }
+            for (int byte = 0; byte < 256; ++byte) {
+                std::string linha = "10 LET X = " + sequencia + static_cast<char>(byte) + "Y";
+                std::string diferenca = comparar(linha);
+                if (!diferenca.empty()) {
+                    return falhar(linha, diferenca);
+                }
+                ++varridas;
+            }
+        }
+    }
+
+    Gerador gerador(semente);
+    for (long k = 0; k < linhas; ++k) {
+        std::string linha = gerador.linha();
+        std::string diferenca = comparar(linha);
+        if (!diferenca.empty()) {
+            return falhar(linha, diferenca);
+        }
+    }
+
+#if defined(__SSE2__) && !defined(SIBASIC_SEM_SSE2)
+    const char* caminho = "SSE2";
+#else
+    const char* caminho = "sem SSE2";
+#endif
+    std::cout << "Lexer (" << caminho << ") equivalente ao de referência: " << varridas << " linhas da varredura e "
+              << linhas << " linhas ao acaso (semente " << semente << ")" << std::endl;
+    return 0;
+}
@@ -2,6 +2,7 @@
 // Created by cleuton on 6/6/24.
 //
 #include "util.h"
+#include <cctype>
 
 bool isNumeric(const std::string& str) {
     if (str.empty()) {
@@ -13,4 +14,25 @@ bool isNumeric(const std::string& str) {
         }
     }
     return true;
-}
\ No newline at end of file
+}
+std::string paraMaiusculas(const std::string& linha) {
+    std::string resultado = linha;
+    bool dentroDeAspas = false;
+    for (char& c : resultado) {
+        if (c == '"') {
+            dentroDeAspas = !dentroDeAspas;
+        } else if (!dentroDeAspas) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    return resultado;
+}
+
+uint64_t hashDoTexto(const std::string& texto) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : texto) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
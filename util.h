@@ -3,8 +3,13 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <cstdint>
 #include <string>
 
 bool isNumeric(const std::string& str);
+// Converte a linha para maiúsculas, preservando o texto entre aspas (literais e nomes de arquivo)
+std::string paraMaiusculas(const std::string& linha);
+// Hash FNV-1a de 64 bits (identifica o fonte de um programa nos checkpoints)
+uint64_t hashDoTexto(const std::string& texto);
 
 #endif // UTIL_H
@@ -0,0 +1,486 @@
+#include "Vetor.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+Copyright 2024 Cleuton Sampaio de Melo Junir
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+Vetor::Vetor() : elementos(nullptr), numeroElementos(0), mapa(nullptr), tamanhoMapa(0) {}
+
+uint64_t Vetor::contarElementos(const std::vector<uint64_t>& dimensoes) {
+    uint64_t tamanho = 1;
+    for (uint64_t dimensao : dimensoes) {
+        if (__builtin_mul_overflow(tamanho, dimensao, &tamanho)) {
+            throw std::runtime_error("Vetor grande demais: o produto das dimensões passa de 2^64");
+        }
+    }
+    return tamanho;
+}
+
+Vetor::Vetor(uint64_t tamanho) : Vetor(std::vector<uint64_t>{tamanho}) {}
+
+Vetor::Vetor(const std::vector<uint64_t>& dimensoes, TipoDeElemento tipo) : Vetor() {
+    uint64_t tamanho = contarElementos(dimensoes);
+    if (tipo != TipoDeElemento::DOUBLE) {
+        // Sem a fase esparsa: o bloco contíguo já ocupa de 8 a 64 vezes menos que o de doubles
+        uint64_t bits = tipo == TipoDeElemento::BIT ? 1 : tipo == TipoDeElemento::INT8 ? 8 : 32;
+        if (tamanho > (UINT64_MAX - 63) / bits) {
+            throw std::runtime_error("Vetor grande demais: " + std::to_string(tamanho));
+        }
+        try {
+            memoriaCompacta.assign(static_cast<size_t>((tamanho * bits + 63) / 64), 0);
+        } catch (const std::bad_alloc&) {
+            throw std::runtime_error("Memória insuficiente para o vetor de " + std::to_string(tamanho)
+                                     + " posições do tipo " + nomeDoTipo(tipo));
+        } catch (const std::length_error&) {
+            throw std::runtime_error("Vetor grande demais: " + std::to_string(tamanho));
+        }
+        tamanhoDimensoes = dimensoes;
+        tipoDosElementos = tipo;
+        compacto = memoriaCompacta.data();
+        numeroElementos = tamanho;
+        return;
+    }
+    if (tamanho >= limiteEsparso) {
+        // Nada é alocado até a primeira gravação
+        tamanhoDimensoes = dimensoes;
+        numeroElementos = tamanho;
+        return;
+    }
+    try {
+        memoria.assign(tamanho, 0.0);
+    } catch (const std::bad_alloc&) {
+        throw std::runtime_error("Memória insuficiente para o vetor de " + std::to_string(tamanho)
+                                 + " posições. Use DIM ... FILE para vetores maiores que a memória");
+    } catch (const std::length_error&) {
+        throw std::runtime_error("Vetor grande demais: " + std::to_string(tamanho));
+    }
+    tamanhoDimensoes = dimensoes;
+    elementos = memoria.data();
+    numeroElementos = tamanho;
+}
+
+Vetor::Vetor(std::vector<double> valores, std::vector<uint64_t> dimensoes) : Vetor() {
+    memoria = std::move(valores);
+    tamanhoDimensoes = dimensoes.empty() ? std::vector<uint64_t>{memoria.size()} : std::move(dimensoes);
+    elementos = memoria.data();
+    numeroElementos = memoria.size();
+}
+
+Vetor::~Vetor() {
+#if !defined(_WIN32)
+    if (mapa != nullptr) {
+        munmap(mapa, tamanhoMapa);
+    }
+#endif
+}
+
+std::shared_ptr<Vetor> Vetor::mapearArquivo(const std::string& caminho, const std::vector<uint64_t>& dimensoes,
+                                            bool acessoAleatorio) {
+#if defined(_WIN32)
+    throw std::runtime_error("DIM ... FILE não é suportado nesta plataforma: " + caminho);
+#else
+    uint64_t tamanho = contarElementos(dimensoes);
+    if (tamanho == 0 || tamanho > SIZE_MAX / sizeof(double)) {
+        throw std::runtime_error("Tamanho inválido para vetor em arquivo: " + std::to_string(tamanho));
+    }
+    size_t bytes = static_cast<size_t>(tamanho) * sizeof(double);
+    int fd = open(caminho.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Falha ao abrir arquivo do vetor: " + caminho + ": " + std::strerror(errno));
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        int erro = errno;
+        close(fd);
+        throw std::runtime_error("Falha ao ler arquivo do vetor: " + caminho + ": " + std::strerror(erro));
+    }
+    if (static_cast<uint64_t>(info.st_size) > bytes) {
+        close(fd);
+        throw std::runtime_error("Arquivo " + caminho + " tem mais elementos que o vetor declarado");
+    }
+    // Aumentar com ftruncate cria um arquivo esparso: o espaço em disco só é usado quando escrito
+    if (static_cast<uint64_t>(info.st_size) < bytes && ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        int erro = errno;
+        close(fd);
+        throw std::runtime_error("Falha ao aumentar arquivo do vetor: " + caminho + ": " + std::strerror(erro));
+    }
+    void* mapa = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int erro = errno;
+    // O mapeamento continua válido depois de fechar o descritor
+    close(fd);
+    if (mapa == MAP_FAILED) {
+        throw std::runtime_error("Falha ao mapear arquivo do vetor: " + caminho + ": " + std::strerror(erro));
+    }
+    // Varreduras sequenciais: leitura antecipada agressiva e páginas liberadas logo após o uso.
+    // Para acessos espalhados (DIM ... FILE "x" RANDOM) a leitura antecipada só atrapalha.
+    madvise(mapa, bytes, acessoAleatorio ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+    std::shared_ptr<Vetor> vetor(new Vetor());
+    vetor->tamanhoDimensoes = dimensoes;
+    vetor->mapa = mapa;
+    vetor->tamanhoMapa = bytes;
+    vetor->elementos = static_cast<double*>(mapa);
+    vetor->numeroElementos = tamanho;
+    vetor->caminhoArquivo = caminho;
+    vetor->aleatorio = acessoAleatorio;
+    return vetor;
+#endif
+}
+
+const char* Vetor::nomeDoTipo(TipoDeElemento tipo) {
+    switch (tipo) {
+    case TipoDeElemento::FLOAT:
+        return "FLOAT";
+    case TipoDeElemento::INT32:
+        return "INT32";
+    case TipoDeElemento::INT8:
+        return "INT8";
+    case TipoDeElemento::BIT:
+        return "BIT";
+    default:
+        return "DOUBLE";
+    }
+}
+
+bool Vetor::tipoPeloNome(const std::string& nome, TipoDeElemento& tipo) {
+    for (TipoDeElemento candidato : {TipoDeElemento::DOUBLE, TipoDeElemento::FLOAT, TipoDeElemento::INT32,
+                                     TipoDeElemento::INT8, TipoDeElemento::BIT}) {
+        if (nome == nomeDoTipo(candidato)) {
+            tipo = candidato;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Vetor::foraDaFaixa(double valor) const {
+    std::ostringstream oss;
+    oss << "Valor fora da faixa de " << nomeDoTipo(tipoDosElementos) << ": " << valor;
+    throw std::runtime_error(oss.str());
+}
+
+void Vetor::lerBloco(uint64_t posicao, uint64_t quantos, double* destino) const {
+    if (compacto == nullptr) {
+        for (uint64_t k = 0; k < quantos; ++k) {
+            destino[k] = ler(posicao + k);
+        }
+        return;
+    }
+    const auto* bytes = reinterpret_cast<const unsigned char*>(compacto);
+    switch (tipoDosElementos) {
+    case TipoDeElemento::BIT:
+        // Uma palavra de cada vez: até 64 elementos por leitura da memória
+        for (uint64_t k = 0; k < quantos;) {
+            uint64_t atual = posicao + k;
+            uint64_t bits = compacto[atual >> 6] >> (atual & 63);
+            uint64_t nestaPalavra = std::min<uint64_t>(64 - (atual & 63), quantos - k);
+            for (uint64_t b = 0; b < nestaPalavra; ++b) {
+                destino[k + b] = static_cast<double>((bits >> b) & 1);
+            }
+            k += nestaPalavra;
+        }
+        break;
+    case TipoDeElemento::INT8:
+        for (uint64_t k = 0; k < quantos; ++k) {
+            destino[k] = static_cast<signed char>(bytes[posicao + k]);
+        }
+        break;
+    case TipoDeElemento::INT32:
+        for (uint64_t k = 0; k < quantos; ++k) {
+            int32_t valor;
+            std::memcpy(&valor, bytes + (posicao + k) * sizeof(valor), sizeof(valor));
+            destino[k] = valor;
+        }
+        break;
+    default:
+        for (uint64_t k = 0; k < quantos; ++k) {
+            float valor;
+            std::memcpy(&valor, bytes + (posicao + k) * sizeof(valor), sizeof(valor));
+            destino[k] = valor;
+        }
+        break;
+    }
+}
+
+void Vetor::escreverBloco(uint64_t posicao, uint64_t quantos, const double* origem) {
+    if (elementos != nullptr) {
+        std::memcpy(elementos + posicao, origem, static_cast<size_t>(quantos) * sizeof(double));
+        return;
+    }
+    if (tipoDosElementos != TipoDeElemento::BIT) {
+        for (uint64_t k = 0; k < quantos; ++k) {
+            escrever(posicao + k, origem[k]);
+        }
+        return;
+    }
+    // Cada palavra é montada inteira e gravada de uma vez; só a primeira e a última do bloco
+    // podem ser parciais e manter bits de fora dele
+    for (uint64_t k = 0; k < quantos;) {
+        uint64_t atual = posicao + k;
+        uint64_t deslocamento = atual & 63;
+        uint64_t nestaPalavra = std::min<uint64_t>(64 - deslocamento, quantos - k);
+        uint64_t bits = 0;
+        for (uint64_t b = 0; b < nestaPalavra; ++b) {
+            bits |= static_cast<uint64_t>(origem[k + b] != 0) << b;
+        }
+        uint64_t mascara = (nestaPalavra == 64 ? ~uint64_t{0} : (uint64_t{1} << nestaPalavra) - 1) << deslocamento;
+        uint64_t& palavra = compacto[atual >> 6];
+        palavra = (palavra & ~mascara) | (bits << deslocamento);
+        k += nestaPalavra;
+    }
+}
+
+const char Vetor::marcaF64[8] = {'S', 'I', 'B', 'F', '6', '4', '\0', '1'};
+
+namespace {
+    // Tamanho em bytes do cabeçalho de um .f64 gravado pelo SAVE (0 se o arquivo não tem
+    // cabeçalho) e as dimensões gravadas nele
+    size_t lerCabecalhoF64(const char* dados, size_t bytes, const std::string& caminho,
+                           std::vector<uint64_t>& dimensoes) {
+        if (bytes < 3 * sizeof(uint64_t) || std::memcmp(dados, Vetor::marcaF64, sizeof(Vetor::marcaF64)) != 0) {
+            return 0;
+        }
+        uint64_t ordem;
+        uint64_t numeroDimensoes;
+        std::memcpy(&ordem, dados + 8, sizeof(ordem));
+        std::memcpy(&numeroDimensoes, dados + 16, sizeof(numeroDimensoes));
+        if (ordem != Vetor::ordemDosBytesF64) {
+            throw std::runtime_error("Arquivo " + caminho + " foi gravado em uma máquina com outra ordem de bytes");
+        }
+        if (numeroDimensoes == 0 || numeroDimensoes > (bytes - 24) / sizeof(uint64_t)) {
+            throw std::runtime_error("Cabeçalho inválido no arquivo de dados: " + caminho);
+        }
+        dimensoes.resize(numeroDimensoes);
+        std::memcpy(dimensoes.data(), dados + 24, numeroDimensoes * sizeof(uint64_t));
+        uint64_t produto = 1;
+        for (uint64_t dimensao : dimensoes) {
+            if (dimensao == 0 || __builtin_mul_overflow(produto, dimensao, &produto)) {
+                throw std::runtime_error("Cabeçalho inválido no arquivo de dados: " + caminho);
+            }
+        }
+        return 24 + numeroDimensoes * sizeof(uint64_t);
+    }
+
+    bool maquinaLittleEndian() {
+        const uint16_t um = 1;
+        unsigned char primeiro;
+        std::memcpy(&primeiro, &um, 1);
+        return primeiro == 1;
+    }
+}
+
+std::shared_ptr<Vetor> Vetor::mapearDados(const std::string& caminho, const std::vector<uint64_t>& dimensoes) {
+#if defined(_WIN32)
+    std::FILE* arquivo = std::fopen(caminho.c_str(), "rb");
+    if (arquivo == nullptr) {
+        throw std::runtime_error("Falha ao abrir arquivo de dados: " + caminho + ": " + std::strerror(errno));
+    }
+    std::vector<char> conteudo;
+    char bloco[1 << 16];
+    for (size_t lidos; (lidos = std::fread(bloco, 1, sizeof(bloco), arquivo)) > 0;) {
+        conteudo.insert(conteudo.end(), bloco, bloco + lidos);
+    }
+    std::fclose(arquivo);
+    const char* dados = conteudo.data();
+    size_t bytes = conteudo.size();
+#else
+    int fd = open(caminho.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Falha ao abrir arquivo de dados: " + caminho + ": " + std::strerror(errno));
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        int erro = errno;
+        close(fd);
+        throw std::runtime_error("Falha ao ler arquivo de dados: " + caminho + ": " + std::strerror(erro));
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    if (bytes == 0) {
+        close(fd);
+        throw std::runtime_error("Arquivo sem valores: " + caminho);
+    }
+    // MAP_PRIVATE: o vetor pode ser alterado pelo programa sem tocar no arquivo
+    void* mapa = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    int erro = errno;
+    close(fd);
+    if (mapa == MAP_FAILED) {
+        throw std::runtime_error("Falha ao mapear arquivo de dados: " + caminho + ": " + std::strerror(erro));
+    }
+    madvise(mapa, bytes, MADV_WILLNEED);
+    std::shared_ptr<Vetor> vetor(new Vetor());
+    // A partir daqui o destrutor do vetor desfaz o mapeamento, também em caso de erro
+    vetor->mapa = mapa;
+    vetor->tamanhoMapa = bytes;
+    const char* dados = static_cast<const char*>(mapa);
+#endif
+    std::vector<uint64_t> dimensoesDoArquivo;
+    size_t cabecalho = lerCabecalhoF64(dados, bytes, caminho, dimensoesDoArquivo);
+    if (cabecalho == 0 && !maquinaLittleEndian()) {
+        throw std::runtime_error("Arquivos .f64 sem cabeçalho são little-endian e esta máquina não é: " + caminho);
+    }
+    if ((bytes - cabecalho) % sizeof(double) != 0) {
+        throw std::runtime_error("Arquivo " + caminho + " não é um vetor de doubles: "
+                                 + std::to_string(bytes - cabecalho) + " bytes não é múltiplo de 8");
+    }
+    uint64_t tamanho = (bytes - cabecalho) / sizeof(double);
+    if (tamanho == 0) {
+        throw std::runtime_error("Arquivo sem valores: " + caminho);
+    }
+    auto validar = [&](const std::vector<uint64_t>& dimensoesEsperadas) {
+        uint64_t esperado = contarElementos(dimensoesEsperadas);
+        if (tamanho != esperado) {
+            throw std::runtime_error("Arquivo " + caminho + " tem " + std::to_string(tamanho)
+                                     + " valores e o vetor tem " + std::to_string(esperado) + " posições");
+        }
+    };
+    if (cabecalho != 0) {
+        validar(dimensoesDoArquivo);
+    }
+    // Vetor declarado com DIM: valem as dimensões do DIM, com o mesmo total de elementos
+    if (!dimensoes.empty()) {
+        validar(dimensoes);
+    }
+    std::vector<uint64_t> dimensoesDoVetor = !dimensoes.empty() ? dimensoes
+                                             : cabecalho != 0   ? dimensoesDoArquivo
+                                                                : std::vector<uint64_t>{tamanho};
+#if defined(_WIN32)
+    std::vector<double> valores(tamanho);
+    std::memcpy(valores.data(), dados + cabecalho, tamanho * sizeof(double));
+    return std::make_shared<Vetor>(std::move(valores), std::move(dimensoesDoVetor));
+#else
+    vetor->tamanhoDimensoes = std::move(dimensoesDoVetor);
+    // O cabeçalho tem tamanho múltiplo de 8: os elementos continuam alinhados
+    vetor->elementos = reinterpret_cast<double*>(static_cast<char*>(mapa) + cabecalho);
+    vetor->numeroElementos = tamanho;
+    vetor->caminhoArquivo = caminho;
+    vetor->copiaPrivada = true;
+    return vetor;
+#endif
+}
+
+void Vetor::sincronizar() {
+#if !defined(_WIN32)
+    if (mapa != nullptr && msync(mapa, tamanhoMapa, MS_SYNC) != 0) {
+        throw std::runtime_error("Falha ao gravar vetor no arquivo: " + caminhoArquivo + ": " + std::strerror(errno));
+    }
+#endif
+}
+
+namespace {
+    // Espalha posições próximas (A[I], A[I + 1]) por toda a tabela
+    inline size_t espalhar(uint64_t posicao, size_t mascara) {
+        return static_cast<size_t>((posicao * 0x9E3779B97F4A7C15ULL) >> 32) & mascara;
+    }
+}
+
+size_t Vetor::procurar(uint64_t posicao) const {
+    size_t mascara = tabela.size() - 1;
+    size_t k = espalhar(posicao, mascara);
+    while (tabela[k].posicao != posicao && tabela[k].posicao != posicaoVazia) {
+        k = (k + 1) & mascara;
+    }
+    return k;
+}
+
+double Vetor::lerEsparso(uint64_t posicao) const {
+    if (tabela.empty()) {
+        return 0.0;
+    }
+    const Entrada& entrada = tabela[procurar(posicao)];
+    return entrada.posicao == posicao ? entrada.valor : 0.0;
+}
+
+void Vetor::escreverEsparso(uint64_t posicao, double valor) {
+    if (tabela.empty()) {
+        if (valor == 0.0 && !std::signbit(valor)) {
+            return;
+        }
+        redimensionarTabela(16);
+    }
+    size_t k = procurar(posicao);
+    if (tabela[k].posicao == posicao) {
+        tabela[k].valor = valor;
+        return;
+    }
+    // Gravar 0 num elemento nunca gravado não muda nada que se possa ler
+    if (valor == 0.0 && !std::signbit(valor)) {
+        return;
+    }
+    if (ocupadas + 1 > numeroElementos / 4 && densificar()) {
+        elementos[posicao] = valor;
+        return;
+    }
+    if ((ocupadas + 1) * 2 > tabela.size()) {
+        redimensionarTabela(tabela.size() * 2);
+        k = procurar(posicao);
+    }
+    tabela[k] = {posicao, valor};
+    ++ocupadas;
+}
+
+void Vetor::redimensionarTabela(size_t capacidade) {
+    std::vector<Entrada> antiga(capacidade, Entrada{posicaoVazia, 0.0});
+    antiga.swap(tabela);
+    for (const Entrada& entrada : antiga) {
+        if (entrada.posicao != posicaoVazia) {
+            tabela[procurar(entrada.posicao)] = entrada;
+        }
+    }
+}
+
+void Vetor::paraCadaGravado(const std::function<void(uint64_t, double)>& visitar) const {
+    for (const Entrada& entrada : tabela) {
+        if (entrada.posicao != posicaoVazia) {
+            visitar(entrada.posicao, entrada.valor);
+        }
+    }
+}
+
+bool Vetor::densificar() {
+    if (elementos != nullptr) {
+        return true;
+    }
+    try {
+        memoria.assign(numeroElementos, 0.0);
+    } catch (const std::bad_alloc&) {
+        return false;
+    } catch (const std::length_error&) {
+        return false;
+    }
+    for (const Entrada& entrada : tabela) {
+        if (entrada.posicao != posicaoVazia) {
+            memoria[entrada.posicao] = entrada.valor;
+        }
+    }
+    std::vector<Entrada>().swap(tabela);
+    ocupadas = 0;
+    elementos = memoria.data();
+    return true;
+}